@@ -8,6 +8,7 @@
 #include <clientversion.h>
 #include <common/args.h>
 #include <crypto/sha256.h>
+#include <crypto/siphash.h>
 #include <util/fs.h>
 #include <util/strencodings.h>
 
@@ -63,6 +64,7 @@ int main(int argc, char** argv)
     ArgsManager argsman;
     SetupBenchArgs(argsman);
     SHA256AutoDetect();
+    SipHashAutoDetect();
     std::string error;
     if (!argsman.ParseParameters(argc, argv, error)) {
         tfm::format(std::cerr, "Error parsing command line arguments: %s\n", error);
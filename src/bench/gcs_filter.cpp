@@ -82,8 +82,57 @@ static void GCSFilterMatch(benchmark::Bench& bench)
         filter.Match(GCSFilter::Element());
     });
 }
+
+static void GCSFilterMatchAny(benchmark::Bench& bench)
+{
+    auto elements = GenerateGCSTestElements();
+
+    GCSFilter filter({0, 0, BASIC_FILTER_P, BASIC_FILTER_M}, elements);
+    GCSFilter::ElementSet queries;
+    for (int i = 0; i < 100; ++i) {
+        queries.emplace(32, static_cast<unsigned char>(i + 1));
+    }
+
+    bench.run([&] {
+        filter.MatchAny(queries);
+    });
+}
+
+static void GCSFilterMatchAnyFilters(benchmark::Bench& bench)
+{
+    // A wallet's scripts checked against consecutive block filters, as in a rescan
+    std::vector<GCSFilter> filters;
+    std::vector<const GCSFilter*> filter_ptrs;
+    filters.reserve(100);
+    for (int i = 0; i < 100; ++i) {
+        GCSFilter::ElementSet elements;
+        for (int j = 0; j < 500; ++j) {
+            GCSFilter::Element element(25);
+            element[0] = static_cast<unsigned char>(i);
+            element[1] = static_cast<unsigned char>(j);
+            element[2] = static_cast<unsigned char>(j >> 8);
+            elements.insert(std::move(element));
+        }
+        filters.emplace_back(GCSFilter::Params{static_cast<uint64_t>(i), 0, BASIC_FILTER_P, BASIC_FILTER_M}, elements);
+        filter_ptrs.push_back(&filters.back());
+    }
+    GCSFilter::ElementSet queries;
+    for (int i = 0; i < 1000; ++i) {
+        GCSFilter::Element element(25, 0xff);
+        element[1] = static_cast<unsigned char>(i);
+        element[2] = static_cast<unsigned char>(i >> 8);
+        queries.insert(std::move(element));
+    }
+
+    bench.batch(filters.size()).unit("filter").run([&] {
+        GCSFilter::MatchAny(filter_ptrs, queries);
+    });
+}
+
 BENCHMARK(GCSBlockFilterGetHash, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterConstruct, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterDecode, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterDecodeSkipCheck, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterMatch, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterMatchAny, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterMatchAnyFilters, benchmark::PriorityLevel::HIGH);
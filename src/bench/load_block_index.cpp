@@ -0,0 +1,92 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <arith_uint256.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <dbwrapper.h>
+#include <kernel/cs_main.h>
+#include <node/blockmap.h>
+#include <node/blockstorage.h>
+#include <pow.h>
+#include <primitives/block.h>
+#include <random.h>
+#include <sync.h>
+#include <test/util/setup_common.h>
+#include <tinyformat.h>
+#include <uint256.h>
+#include <util/chaintype.h>
+#include <util/signalinterrupt.h>
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+//! About five weeks of 60-second blocks
+static constexpr int NUM_BLOCK_INDEX_ENTRIES{50000};
+
+/**
+ * Measure LoadBlockIndexGuts(), which reads every block index entry from the
+ * block tree database at startup and inserts it into a BlockMap, and report
+ * the memory the loaded block index takes.
+ */
+static void LoadBlockIndexGuts(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>(ChainType::REGTEST)};
+    const Consensus::Params& consensus{Params().GetConsensus()};
+    kernel::BlockTreeDB block_tree_db{DBParams{.path = "", .cache_bytes = 8 << 20, .memory_only = true}};
+    util::SignalInterrupt interrupt;
+
+    // Write a chain of headers that pass the proof of work check
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<std::pair<uint256, CDiskBlockIndex>> entries;
+    entries.reserve(NUM_BLOCK_INDEX_ENTRIES);
+    CBlockHeader header;
+    header.nBits = UintToArith256(consensus.powLimit).GetCompact();
+    LOCK(::cs_main);
+    for (int height = 0; height < NUM_BLOCK_INDEX_ENTRIES; ++height) {
+        header.nHeight = height;
+        header.nTime = 1700000000 + 60 * height;
+        header.hashMix = rng.rand256();
+        header.hashMerkleRoot = rng.rand256();
+        uint256 hash;
+        while (!CheckProofOfWork(hash = header.GetHash(), header.nBits, consensus)) ++header.nNonce;
+
+        CBlockIndex index{header};
+        index.nStatus = BLOCK_VALID_SCRIPTS | BLOCK_HAVE_DATA | BLOCK_HAVE_UNDO;
+        index.nTx = 1;
+        index.nDataPos = height * 300;
+        index.nUndoPos = height * 100;
+        CDiskBlockIndex diskindex{&index, BlockHeaderColdData{header.hashMix, header.hashMerkleRoot, header.nNonce}};
+        diskindex.hashPrev = header.hashPrevBlock;
+        entries.emplace_back(hash, diskindex);
+        header.hashPrevBlock = hash;
+    }
+    const bool written{block_tree_db.WriteBatchSync({}, 0, entries)};
+    assert(written);
+
+    size_t memory_usage{0};
+    bench.batch(NUM_BLOCK_INDEX_ENTRIES).unit("entry").run([&] {
+        node::BlockMap block_index;
+        LOCK(::cs_main);
+        const bool loaded{block_tree_db.LoadBlockIndexGuts(
+            consensus, [&](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) -> CBlockIndex* {
+                if (hash.IsNull()) return nullptr;
+                const auto [it, inserted]{block_index.try_emplace(hash)};
+                if (inserted) it->second.phashBlock = &it->first;
+                return &it->second;
+            },
+            interrupt)};
+        assert(loaded && block_index.size() == NUM_BLOCK_INDEX_ENTRIES);
+        memory_usage = block_index.DynamicMemoryUsage();
+    });
+
+    if (bench.output()) {
+        *bench.output() << strprintf("Block index memory: %u bytes for %u entries (%.1f bytes per entry)\n",
+                                     memory_usage, NUM_BLOCK_INDEX_ENTRIES, double(memory_usage) / NUM_BLOCK_INDEX_ENTRIES);
+    }
+}
+
+BENCHMARK(LoadBlockIndexGuts, benchmark::PriorityLevel::HIGH);
@@ -21,21 +21,25 @@ static const std::map<BlockFilterType, std::string> g_filter_types = {
     {BlockFilterType::BASIC, "basic"},
 };
 
-uint64_t GCSFilter::HashToRange(const Element& element) const
+uint64_t GCSFilter::HashToRange(Span<const unsigned char> element) const
 {
-    uint64_t hash = CSipHasher(m_params.m_siphash_k0, m_params.m_siphash_k1)
-        .Write(element)
-        .Finalize();
+    uint64_t hash = SipHashBytes(m_params.m_siphash_k0, m_params.m_siphash_k1, element);
     return FastRange64(hash, m_F);
 }
 
-std::vector<uint64_t> GCSFilter::BuildHashedSet(const ElementSet& elements) const
+void GCSFilter::HashToRange(Span<const Span<const unsigned char>> elements, Span<uint64_t> out) const
 {
-    std::vector<uint64_t> hashed_elements;
-    hashed_elements.reserve(elements.size());
-    for (const Element& element : elements) {
-        hashed_elements.push_back(HashToRange(element));
+    SipHashBytesBatch(m_params.m_siphash_k0, m_params.m_siphash_k1, elements, out);
+    for (uint64_t& hash : out) {
+        hash = FastRange64(hash, m_F);
     }
+}
+
+std::vector<uint64_t> GCSFilter::BuildHashedSet(const ElementSet& elements) const
+{
+    const std::vector<Span<const unsigned char>> data(elements.begin(), elements.end());
+    std::vector<uint64_t> hashed_elements(data.size());
+    HashToRange(data, hashed_elements);
     std::sort(hashed_elements.begin(), hashed_elements.end());
     return hashed_elements;
 }
@@ -60,11 +64,11 @@ GCSFilter::GCSFilter(const Params& params, std::vector<unsigned char> encoded_fi
 
     // Verify that the encoded filter contains exactly N elements. If it has too much or too little
     // data, a std::ios_base::failure exception will be raised.
-    BitStreamReader bitreader{stream};
+    GolombRiceReader reader{Span{m_encoded}.last(stream.size())};
     for (uint64_t i = 0; i < m_N; ++i) {
-        GolombRiceDecode(bitreader, m_params.m_P);
+        reader.Decode(m_params.m_P);
     }
-    if (!stream.empty()) {
+    if (reader.BytesRead() != stream.size()) {
         throw std::ios_base::failure("encoded_filter contains excess data");
     }
 }
@@ -87,16 +91,16 @@ GCSFilter::GCSFilter(const Params& params, const ElementSet& elements)
         return;
     }
 
-    BitStreamWriter bitwriter{stream};
+    GolombRiceWriter writer{m_encoded};
 
     uint64_t last_value = 0;
     for (uint64_t value : BuildHashedSet(elements)) {
         uint64_t delta = value - last_value;
-        GolombRiceEncode(bitwriter, m_params.m_P, delta);
+        writer.Encode(m_params.m_P, delta);
         last_value = value;
     }
 
-    bitwriter.Flush();
+    writer.Flush();
 }
 
 bool GCSFilter::MatchInternal(const uint64_t* element_hashes, size_t size) const
@@ -107,12 +111,12 @@ bool GCSFilter::MatchInternal(const uint64_t* element_hashes, size_t size) const
     uint64_t N = ReadCompactSize(stream);
     assert(N == m_N);
 
-    BitStreamReader bitreader{stream};
+    GolombRiceReader reader{Span{m_encoded}.last(stream.size())};
 
     uint64_t value = 0;
     size_t hashes_index = 0;
     for (uint32_t i = 0; i < m_N; ++i) {
-        uint64_t delta = GolombRiceDecode(bitreader, m_params.m_P);
+        uint64_t delta = reader.Decode(m_params.m_P);
         value += delta;
 
         while (true) {
@@ -143,6 +147,34 @@ bool GCSFilter::MatchAny(const ElementSet& elements) const
     return MatchInternal(queries.data(), queries.size());
 }
 
+std::vector<bool> GCSFilter::MatchAny(Span<const GCSFilter* const> filters, const ElementSet& elements)
+{
+    // Lay the elements out once, as they are hashed again for every filter
+    size_t data_size{0};
+    for (const Element& element : elements) {
+        data_size += element.size();
+    }
+    std::vector<unsigned char> data;
+    data.reserve(data_size);
+    std::vector<Span<const unsigned char>> spans;
+    spans.reserve(elements.size());
+    for (const Element& element : elements) {
+        data.insert(data.end(), element.begin(), element.end());
+        spans.push_back(Span{data}.last(element.size()));
+    }
+
+    std::vector<bool> matches(filters.size(), false);
+    std::vector<uint64_t> queries(spans.size());
+    for (size_t i = 0; i < filters.size(); ++i) {
+        const GCSFilter& filter{*filters[i]};
+        if (filter.m_N == 0 || spans.empty()) continue;
+        filter.HashToRange(spans, queries);
+        std::sort(queries.begin(), queries.end());
+        matches[i] = filter.MatchInternal(queries.data(), queries.size());
+    }
+    return matches;
+}
+
 const std::string& BlockFilterTypeName(BlockFilterType filter_type)
 {
     static std::string unknown_retval;
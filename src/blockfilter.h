@@ -16,6 +16,7 @@
 #include <vector>
 
 #include <attributes.h>
+#include <span.h>
 #include <uint256.h>
 #include <util/bytevectorhash.h>
 
@@ -51,7 +52,9 @@ private:
     std::vector<unsigned char> m_encoded;
 
     /** Hash a data element to an integer in the range [0, N * M). */
-    uint64_t HashToRange(const Element& element) const;
+    uint64_t HashToRange(Span<const unsigned char> element) const;
+    /** Hash data elements, several at a time, as HashToRange() would. */
+    void HashToRange(Span<const Span<const unsigned char>> elements, Span<uint64_t> out) const;
 
     std::vector<uint64_t> BuildHashedSet(const ElementSet& elements) const;
 
@@ -85,6 +88,14 @@ public:
      * efficient that checking Match on multiple elements separately.
      */
     bool MatchAny(const ElementSet& elements) const;
+
+    /**
+     * Checks, for each filter, if any of the given elements may be in it, as
+     * MatchAny() on each filter would. The elements are laid out once and the
+     * query buffer is reused across filters, which matters when checking one
+     * set against many consecutive block filters, as rescans do.
+     */
+    static std::vector<bool> MatchAny(Span<const GCSFilter* const> filters, const ElementSet& elements);
 };
 
 constexpr uint8_t BASIC_FILTER_P = 19;
@@ -0,0 +1,85 @@
+// Copyright (c) 2017-2022 The Bitcoin Core developers
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_BLOCKSTATS_H
+#define BETGENIUS_BLOCKSTATS_H
+
+#include <consensus/amount.h>
+#include <serialize.h>
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class CBlock;
+class CBlockUndo;
+
+static constexpr int NUM_GETBLOCKSTATS_PERCENTILES = 5;
+
+/**
+ * Statistics of the transactions of a block, as reported by getblockstats.
+ * Amounts are in satoshis and feerates in satoshis per virtual byte. The
+ * statistics of the coinbase transaction are only counted in txs, outs and
+ * the utxo fields.
+ */
+struct BlockStats {
+    int64_t txs{0};
+    int64_t ins{0};
+    int64_t outs{0};
+    CAmount total_out{0};
+    CAmount totalfee{0};
+    CAmount minfee{0};
+    CAmount maxfee{0};
+    CAmount medianfee{0};
+    CAmount minfeerate{0};
+    CAmount maxfeerate{0};
+    std::array<CAmount, NUM_GETBLOCKSTATS_PERCENTILES> feerate_percentiles{};
+    int64_t total_size{0};
+    int64_t mintxsize{0};
+    int64_t maxtxsize{0};
+    int64_t mediantxsize{0};
+    int64_t total_weight{0};
+    int64_t swtxs{0};
+    int64_t swtotal_size{0};
+    int64_t swtotal_weight{0};
+    //! Spendable outputs created, which with ins gives utxo_increase_actual
+    int64_t utxos{0};
+    int64_t utxo_size_inc{0};
+    int64_t utxo_size_inc_actual{0};
+
+    CAmount AvgFee() const { return txs > 1 ? totalfee / (txs - 1) : 0; }
+    CAmount AvgFeeRate() const;
+    int64_t AvgTxSize() const { return txs > 1 ? total_size / (txs - 1) : 0; }
+
+    SERIALIZE_METHODS(BlockStats, obj)
+    {
+        for (const auto field : {&BlockStats::txs, &BlockStats::ins, &BlockStats::outs, &BlockStats::total_out,
+                                 &BlockStats::totalfee, &BlockStats::minfee, &BlockStats::maxfee, &BlockStats::medianfee,
+                                 &BlockStats::minfeerate, &BlockStats::maxfeerate, &BlockStats::total_size,
+                                 &BlockStats::mintxsize, &BlockStats::maxtxsize, &BlockStats::mediantxsize,
+                                 &BlockStats::total_weight, &BlockStats::swtxs, &BlockStats::swtotal_size,
+                                 &BlockStats::swtotal_weight, &BlockStats::utxos}) {
+            READWRITE(VARINT_MODE(obj.*field, VarIntMode::NONNEGATIVE_SIGNED));
+        }
+        for (auto& feerate : obj.feerate_percentiles) {
+            READWRITE(VARINT_MODE(feerate, VarIntMode::NONNEGATIVE_SIGNED));
+        }
+        // The utxo size increases are negative when a block spends more than it creates
+        READWRITE(obj.utxo_size_inc, obj.utxo_size_inc_actual);
+    }
+};
+
+/**
+ * Compute the statistics of a block. Without the undo data of the block, the
+ * fees and feerates are left at zero and the utxo size increases only count
+ * the outputs created.
+ */
+BlockStats ComputeBlockStats(const CBlock& block, const CBlockUndo* block_undo);
+
+/** Used by getblockstats to get feerates at different percentiles by weight  */
+void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight);
+
+#endif // BETGENIUS_BLOCKSTATS_H
@@ -15,8 +15,8 @@ std::string CBlockFileInfo::ToString() const
 
 std::string CBlockIndex::ToString() const
 {
-    return strprintf("CBlockIndex(pprev=%p, nHeight=%d,  hashBlock=%s, hashMix=%s, merkle=%s)",
-                     pprev, nHeight, GetBlockHash().ToString(), hashMix.ToString(), hashMerkleRoot.ToString());
+    return strprintf("CBlockIndex(pprev=%p, nHeight=%d, hashBlock=%s)",
+                     pprev, nHeight, GetBlockHash().ToString());
 }
 
 void CChain::SetTip(CBlockIndex& block)
@@ -199,13 +199,11 @@ public:
     //! @sa ActivateSnapshot
     uint32_t nStatus GUARDED_BY(::cs_main){0};
 
-    //! block header
+    //! block header, except for the fields in BlockHeaderColdData, which are
+    //! only held in the block tree database
     int32_t nVersion{0};
-    uint256 hashMix{};
-    uint256 hashMerkleRoot{};
     uint32_t nTime{0};
     uint32_t nBits{0};
-    uint64_t nNonce{0};
 
     //! (memory only) Sequential id assigned to distinguish order in which blocks are received.
     int32_t nSequenceId{0};
@@ -216,11 +214,8 @@ public:
     explicit CBlockIndex(const CBlockHeader& block)
         : nHeight(block.nHeight),
           nVersion{block.nVersion},
-          hashMix(block.hashMix),
-          hashMerkleRoot{block.hashMerkleRoot},
           nTime{block.nTime},
-          nBits{block.nBits},
-          nNonce{block.nNonce}
+          nBits{block.nBits}
     {
     }
 
@@ -246,21 +241,6 @@ public:
         return ret;
     }
 
-    CBlockHeader GetBlockHeader() const
-    {
-        CBlockHeader block;
-        block.nHeight = nHeight;
-        block.nVersion = nVersion;
-        if (pprev)
-            block.hashPrevBlock = pprev->GetBlockHash();
-        block.hashMix = hashMix;
-        block.hashMerkleRoot = hashMerkleRoot;
-        block.nTime = nTime;
-        block.nBits = nBits;
-        block.nNonce = nNonce;
-        return block;
-    }
-
     uint256 GetBlockHash() const
     {
         assert(phashBlock != nullptr);
@@ -386,8 +366,19 @@ int64_t GetBlockProofEquivalentTime(const CBlockIndex& to, const CBlockIndex& fr
 const CBlockIndex* LastCommonAncestor(const CBlockIndex* pa, const CBlockIndex* pb);
 
 
+/**
+ * Block header fields that are not kept in memory by CBlockIndex. They are
+ * only needed to relay, display or rehash a header, so they are read back from
+ * the block tree database when needed (see BlockManager::ReadBlockHeader).
+ */
+struct BlockHeaderColdData {
+    uint256 hashMix{};
+    uint256 hashMerkleRoot{};
+    uint64_t nNonce{0};
+};
+
 /** Used to marshal pointers into hashes for db storage. */
-class CDiskBlockIndex : public CBlockIndex
+class CDiskBlockIndex : public CBlockIndex, public BlockHeaderColdData
 {
     /** Historically CBlockLocator's version field has been written to disk
      * streams as the client version, but the value has never been used.
@@ -405,14 +396,22 @@ public:
         hashPrev = uint256();
     }
 
-    explicit CDiskBlockIndex(const CBlockIndex* pindex) : CBlockIndex(*pindex)
+    CDiskBlockIndex(const CBlockIndex* pindex, const BlockHeaderColdData& cold) : CBlockIndex(*pindex), BlockHeaderColdData(cold)
     {
         hashPrev = (pprev ? pprev->GetBlockHash() : uint256());
     }
 
-    SERIALIZE_METHODS(CDiskBlockIndex, obj)
+    // A CDiskBlockIndex is a private copy of a block index entry, so its
+    // fields need no lock. This lets the block index be deserialized on worker
+    // threads while cs_main is held by the loading thread.
+    BASE_SERIALIZE_METHODS(CDiskBlockIndex)
+    template <typename Stream>
+    static void Ser(Stream& s, const CDiskBlockIndex& obj) { SerializationOps(obj, s, ActionSerialize{}); }
+    template <typename Stream>
+    static void Unser(Stream& s, CDiskBlockIndex& obj) { SerializationOps(obj, s, ActionUnserialize{}); }
+    template <typename Stream, typename Type, typename Operation>
+    static void SerializationOps(Type& obj, Stream& s, Operation ser_action) NO_THREAD_SAFETY_ANALYSIS
     {
-        LOCK(::cs_main);
         int _nVersion = DUMMY_VERSION;
         READWRITE(VARINT_MODE(_nVersion, VarIntMode::NONNEGATIVE_SIGNED));
 
@@ -433,7 +432,7 @@ public:
         READWRITE(obj.hashMix);
     }
 
-    uint256 ConstructBlockHash() const
+    CBlockHeader GetBlockHeader() const
     {
         CBlockHeader block;
         block.nHeight = nHeight;
@@ -444,7 +443,12 @@ public:
         block.nTime = nTime;
         block.nBits = nBits;
         block.nNonce = nNonce;
-        return block.GetHash();
+        return block;
+    }
+
+    uint256 ConstructBlockHash() const
+    {
+        return GetBlockHeader().GetHash();
     }
 
     uint256 GetBlockHash() = delete;
@@ -20,7 +20,9 @@
 #include <stdint.h>
 
 #include <functional>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 /**
  * A UTXO entry.
@@ -198,6 +200,12 @@ public:
     //! Get a cursor to iterate over the whole state
     virtual std::unique_ptr<CCoinsViewCursor> Cursor() const;
 
+    //! Get a cursor to iterate over the coins whose txid lies in [begin, end),
+    //! or over all coins from begin onwards without an end bound. Ranges are
+    //! ordered like the whole-state cursor, so adjacent ranges can be scanned
+    //! independently and concatenated.
+    virtual std::unique_ptr<CCoinsViewCursor> Cursor(const uint256& begin, const std::optional<uint256>& end) const;
+
     //! As we use CCoinsViews polymorphically, have a virtual destructor
     virtual ~CCoinsView() {}
 
@@ -221,6 +229,7 @@ public:
     void SetBackend(CCoinsView &viewIn);
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, bool erase = true) override;
     std::unique_ptr<CCoinsViewCursor> Cursor() const override;
+    std::unique_ptr<CCoinsViewCursor> Cursor(const uint256& begin, const std::optional<uint256>& end) const override;
     size_t EstimateSize() const override;
 };
 
@@ -260,6 +269,9 @@ public:
     std::unique_ptr<CCoinsViewCursor> Cursor() const override {
         throw std::logic_error("CCoinsViewCache cursor iteration not supported.");
     }
+    std::unique_ptr<CCoinsViewCursor> Cursor(const uint256& begin, const std::optional<uint256>& end) const override {
+        throw std::logic_error("CCoinsViewCache cursor iteration not supported.");
+    }
 
     /**
      * Check if we have the given utxo already loaded in this cache.
@@ -295,6 +307,19 @@ public:
      */
     void EmplaceCoinInternalDANGER(COutPoint&& outpoint, Coin&& coin);
 
+    /**
+     * Insert a coin read from the backing view as a clean entry, as if it
+     * had been fetched by GetCoin(). Outpoints already in the cache are left
+     * untouched, since the cached version may be newer.
+     *
+     * The caller must guarantee that the coin is the current version in the
+     * backing view. Used to warm the cache with coins read in bulk.
+     */
+    void WarmCoin(const COutPoint& outpoint, Coin&& coin);
+
+    //! Return the outpoints of the unspent coins in the cache, in sorted order.
+    std::vector<COutPoint> GetCachedOutPoints() const;
+
     /**
      * Spend a coin. Pass moveto in order to get the deleted data.
      * If no unspent output exists for the passed outpoint, this call
@@ -245,3 +245,52 @@ void CRollingBloomFilter::reset()
     nGeneration = 1;
     std::fill(data.begin(), data.end(), 0);
 }
+
+/* 12 bits per element, of which each key sets up to 6 in its block. */
+static constexpr uint64_t BLOCKED_BLOOM_BITS_PER_ELEMENT{12};
+static constexpr int BLOCKED_BLOOM_HASH_FUNCS{6};
+static constexpr size_t BLOCKED_BLOOM_BLOCK_WORDS{8};
+
+CBlockedBloomFilter::CBlockedBloomFilter(uint64_t nElements)
+    : nBlocks{std::max<uint64_t>(1, (nElements * BLOCKED_BLOOM_BITS_PER_ELEMENT + 511) / 512)},
+      data(nBlocks * BLOCKED_BLOOM_BLOCK_WORDS)
+{
+}
+
+/* The block is picked with the upper bits of the key, and the bits within it
+ * with 9-bit slices of the upper 54 bits of a multiplicative remix of the key,
+ * so the key serves as its own hash. */
+static inline uint64_t BlockedBloomBits(uint64_t key)
+{
+    return key * 0x9E3779B97F4A7C15ULL;
+}
+
+uint64_t CBlockedBloomFilter::MaxElements(size_t max_memory)
+{
+    // Whole blocks of 512 bits
+    const uint64_t blocks{max_memory / (BLOCKED_BLOOM_BLOCK_WORDS * sizeof(uint64_t))};
+    return blocks * 512 / BLOCKED_BLOOM_BITS_PER_ELEMENT;
+}
+
+void CBlockedBloomFilter::insert(uint64_t key)
+{
+    const size_t block{static_cast<size_t>(FastRange64(key, nBlocks)) * BLOCKED_BLOOM_BLOCK_WORDS};
+    const uint64_t h{BlockedBloomBits(key)};
+    for (int n = 0; n < BLOCKED_BLOOM_HASH_FUNCS; n++) {
+        const unsigned int bit = (h >> (10 + 9 * n)) & 511;
+        data[block + (bit >> 6)].fetch_or(uint64_t{1} << (bit & 63), std::memory_order_relaxed);
+    }
+}
+
+bool CBlockedBloomFilter::contains(uint64_t key) const
+{
+    const size_t block{static_cast<size_t>(FastRange64(key, nBlocks)) * BLOCKED_BLOOM_BLOCK_WORDS};
+    const uint64_t h{BlockedBloomBits(key)};
+    for (int n = 0; n < BLOCKED_BLOOM_HASH_FUNCS; n++) {
+        const unsigned int bit = (h >> (10 + 9 * n)) & 511;
+        if (!((data[block + (bit >> 6)].load(std::memory_order_relaxed) >> (bit & 63)) & 1)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -9,6 +9,9 @@
 #include <serialize.h>
 #include <span.h>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 class COutPoint;
@@ -125,4 +128,33 @@ private:
     int nHashFuncs;
 };
 
+/**
+ * BlockedBloomFilter is a bloom filter of 64-bit keys which are uniformly
+ * distributed already, such as hash prefixes, for lookups of a large set kept
+ * in memory. All the bits of a key are in one 512-bit block, so a lookup reads
+ * a single cache line.
+ *
+ * Bits are set and read atomically, so the filter can be read while it is
+ * added to. Sized for nElements, it has a false positive rate of about 1%,
+ * which grows gradually past that number of elements.
+ */
+class CBlockedBloomFilter
+{
+public:
+    explicit CBlockedBloomFilter(uint64_t nElements);
+
+    void insert(uint64_t key);
+    bool contains(uint64_t key) const;
+
+    //! Memory used by the filter bits, in bytes
+    size_t GetMemoryUsage() const { return data.size() * sizeof(uint64_t); }
+
+    //! Largest number of elements a filter using at most max_memory bytes is sized for
+    static uint64_t MaxElements(size_t max_memory);
+
+private:
+    uint64_t nBlocks;
+    std::vector<std::atomic<uint64_t>> data;
+};
+
 #endif // BETGENIUS_COMMON_BLOOM_H
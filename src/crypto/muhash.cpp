@@ -133,6 +133,16 @@ bool Num3072::IsOverflow() const
     return true;
 }
 
+/** Indicates whether d is one, as it is after SetToOne(). */
+bool Num3072::IsOne() const
+{
+    if (this->limbs[0] != 1) return false;
+    for (int i = 1; i < LIMBS; ++i) {
+        if (this->limbs[i] != 0) return false;
+    }
+    return true;
+}
+
 void Num3072::FullReduce()
 {
     limb_t c0 = MAX_PRIME_DIFF;
@@ -263,6 +273,9 @@ void Num3072::Divide(const Num3072& a)
 {
     if (this->IsOverflow()) this->FullReduce();
 
+    // Dividing by one, as for a set without removals, needs no inverse
+    if (a.IsOne()) return;
+
     Num3072 inv{};
     if (a.IsOverflow()) {
         Num3072 b = a;
@@ -312,10 +325,16 @@ MuHash3072::MuHash3072(Span<const unsigned char> in) noexcept
     m_numerator = ToNum3072(in);
 }
 
-void MuHash3072::Finalize(uint256& out) noexcept
+MuHash3072& MuHash3072::Normalize() noexcept
 {
     m_numerator.Divide(m_denominator);
     m_denominator.SetToOne();  // Needed to keep the MuHash object valid
+    return *this;
+}
+
+void MuHash3072::Finalize(uint256& out) noexcept
+{
+    Normalize();
 
     unsigned char data[Num3072::BYTE_SIZE];
     m_numerator.ToBytes(data);
@@ -326,13 +345,13 @@ void MuHash3072::Finalize(uint256& out) noexcept
 MuHash3072& MuHash3072::operator*=(const MuHash3072& mul) noexcept
 {
     m_numerator.Multiply(mul.m_numerator);
-    m_denominator.Multiply(mul.m_denominator);
+    if (!mul.m_denominator.IsOne()) m_denominator.Multiply(mul.m_denominator);
     return *this;
 }
 
 MuHash3072& MuHash3072::operator/=(const MuHash3072& div) noexcept
 {
-    m_numerator.Multiply(div.m_denominator);
+    if (!div.m_denominator.IsOne()) m_numerator.Multiply(div.m_denominator);
     m_denominator.Multiply(div.m_numerator);
     return *this;
 }
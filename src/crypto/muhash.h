@@ -45,6 +45,7 @@ public:
     void Multiply(const Num3072& a);
     void Divide(const Num3072& a);
     void SetToOne();
+    bool IsOne() const;
     void Square();
     void ToBytes(unsigned char (&out)[BYTE_SIZE]);
 
@@ -115,6 +116,11 @@ public:
     /* Divide (resulting in a hash for the difference of the sets) */
     MuHash3072& operator/=(const MuHash3072& div) noexcept;
 
+    /* Combine the numerator and denominator with a single division, so that
+     * multiplying this into another set does not grow its denominator.
+     * Does not change the set represented. */
+    MuHash3072& Normalize() noexcept;
+
     /* Finalize into a 32-byte hash. Does not change this object's value. */
     void Finalize(uint256& out) noexcept;
 
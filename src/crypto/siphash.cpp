@@ -3,10 +3,34 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#if defined(HAVE_CONFIG_H)
+#include <config/betgenius-config.h>
+#endif
+
 #include <crypto/siphash.h>
 
+#include <compat/cpuid.h>
+#include <crypto/common.h>
+
+#include <array>
+#include <assert.h>
 #include <bit>
 
+namespace siphash_avx2
+{
+void Hash_4way(uint64_t k0, uint64_t k1, const Span<const unsigned char>* strings, const size_t* indexes, uint64_t* out);
+}
+
+namespace {
+/** Hash the strings at four indexes, which have the same number of whole words. */
+typedef void (*Hash4WayFn)(uint64_t k0, uint64_t k1, const Span<const unsigned char>* strings, const size_t* indexes, uint64_t* out);
+
+Hash4WayFn Hash4Way = nullptr;
+
+//! Strings of up to this many words are grouped for Hash4Way, longer ones are hashed one at a time
+constexpr size_t MAX_GROUPED_WORDS{16};
+} // namespace
+
 #define SIPROUND do { \
     v0 += v1; v1 = std::rotl(v1, 13); v1 ^= v0; \
     v0 = std::rotl(v0, 32); \
@@ -173,3 +197,98 @@ uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256& val, uint3
     SIPROUND;
     return v0 ^ v1 ^ v2 ^ v3;
 }
+
+uint64_t SipHashBytes(uint64_t k0, uint64_t k1, Span<const unsigned char> data)
+{
+    /* Specialized implementation for efficiency */
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1;
+
+    const size_t size{data.size()};
+    const unsigned char* ptr{data.data()};
+    for (const unsigned char* end{ptr + (size & ~size_t{7})}; ptr != end; ptr += 8) {
+        const uint64_t d{ReadLE64(ptr)};
+        v3 ^= d;
+        SIPROUND;
+        SIPROUND;
+        v0 ^= d;
+    }
+
+    // The last word holds the remaining bytes and the low byte of the size
+    uint64_t t = uint64_t{size} << 56;
+    for (size_t i = 0; i < (size & 7); ++i) {
+        t |= uint64_t{ptr[i]} << (8 * i);
+    }
+    v3 ^= t;
+    SIPROUND;
+    SIPROUND;
+    v0 ^= t;
+    v2 ^= 0xFF;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+void SipHashBytesBatch(uint64_t k0, uint64_t k1, Span<const Span<const unsigned char>> data, Span<uint64_t> out)
+{
+    assert(data.size() == out.size());
+    if (!Hash4Way) {
+        for (size_t i = 0; i < data.size(); ++i) {
+            out[i] = SipHashBytes(k0, k1, data[i]);
+        }
+        return;
+    }
+
+    // Strings of the same number of words go through the same rounds, so
+    // they are queued by word count and hashed four at a time.
+    std::array<std::array<size_t, 4>, MAX_GROUPED_WORDS + 1> queued;
+    std::array<size_t, MAX_GROUPED_WORDS + 1> num_queued{};
+    for (size_t i = 0; i < data.size(); ++i) {
+        const size_t words{data[i].size() / 8};
+        if (words > MAX_GROUPED_WORDS) {
+            out[i] = SipHashBytes(k0, k1, data[i]);
+            continue;
+        }
+        std::array<size_t, 4>& group{queued[words]};
+        group[num_queued[words]++] = i;
+        if (num_queued[words] == 4) {
+            uint64_t hashes[4];
+            Hash4Way(k0, k1, data.data(), group.data(), hashes);
+            for (size_t j = 0; j < 4; ++j) {
+                out[group[j]] = hashes[j];
+            }
+            num_queued[words] = 0;
+        }
+    }
+    for (size_t words = 0; words <= MAX_GROUPED_WORDS; ++words) {
+        for (size_t j = 0; j < num_queued[words]; ++j) {
+            out[queued[words][j]] = SipHashBytes(k0, k1, data[queued[words][j]]);
+        }
+    }
+}
+
+std::string SipHashAutoDetect()
+{
+    std::string ret = "standard";
+    Hash4Way = nullptr;
+
+#if defined(HAVE_GETCPUID) && defined(ENABLE_AVX2)
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    const bool have_xsave = (ecx >> 27) & 1;
+    const bool have_avx = (ecx >> 28) & 1;
+    if (have_xsave && have_avx && AVXEnabled()) {
+        GetCPUID(7, 0, eax, ebx, ecx, edx);
+        if ((ebx >> 5) & 1) {
+            Hash4Way = siphash_avx2::Hash_4way;
+            ret = "avx2(4way)";
+        }
+    }
+#endif
+
+    return ret;
+}
@@ -11,6 +11,8 @@
 #include <span.h>
 #include <uint256.h>
 
+#include <string>
+
 /** SipHash-2-4 */
 class CSipHasher
 {
@@ -46,4 +48,25 @@ public:
 uint64_t SipHashUint256(uint64_t k0, uint64_t k1, const uint256& val);
 uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256& val, uint32_t extra);
 
+/** Optimized SipHash-2-4 implementation for a byte string, reading it a 64-bit
+ *  word at a time.
+ *
+ *  It is identical to:
+ *    SipHasher(k0, k1)
+ *      .Write(data)
+ *      .Finalize()
+ */
+uint64_t SipHashBytes(uint64_t k0, uint64_t k1, Span<const unsigned char> data);
+
+/** SipHash-2-4 of several byte strings, as SipHashBytes() computes each of
+ *  them. Strings of the same number of words are hashed four at a time when
+ *  SipHashAutoDetect() found an implementation for it.
+ */
+void SipHashBytesBatch(uint64_t k0, uint64_t k1, Span<const Span<const unsigned char>> data, Span<uint64_t> out);
+
+/** Autodetect the best available SipHashBytesBatch() implementation.
+ *  Returns the name of the implementation.
+ */
+std::string SipHashAutoDetect();
+
 #endif // BETGENIUS_CRYPTO_SIPHASH_H
@@ -0,0 +1,86 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include <attributes.h>
+#include <crypto/common.h>
+#include <span.h>
+
+namespace siphash_avx2 {
+namespace {
+
+__m256i inline K(uint64_t x) { return _mm256_set1_epi64x(x); }
+
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi64(x, y); }
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+template <int n>
+__m256i inline RotL(__m256i x) { return _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - n)); }
+/** Rotations by whole bytes are a single shuffle. */
+__m256i inline RotL16(__m256i x) { return _mm256_shuffle_epi8(x, _mm256_setr_epi8(6, 7, 0, 1, 2, 3, 4, 5, 14, 15, 8, 9, 10, 11, 12, 13, 6, 7, 0, 1, 2, 3, 4, 5, 14, 15, 8, 9, 10, 11, 12, 13)); }
+__m256i inline RotL32(__m256i x) { return _mm256_shuffle_epi32(x, 0xB1); }
+
+/** One SipRound on four states. */
+void ALWAYS_INLINE Round(__m256i& v0, __m256i& v1, __m256i& v2, __m256i& v3)
+{
+    v0 = Add(v0, v1); v1 = Xor(RotL<13>(v1), v0);
+    v0 = RotL32(v0);
+    v2 = Add(v2, v3); v3 = Xor(RotL16(v3), v2);
+    v0 = Add(v0, v3); v3 = Xor(RotL<21>(v3), v0);
+    v2 = Add(v2, v1); v1 = Xor(RotL<17>(v1), v2);
+    v2 = RotL32(v2);
+}
+
+void ALWAYS_INLINE Compress(__m256i& v0, __m256i& v1, __m256i& v2, __m256i& v3, __m256i d)
+{
+    v3 = Xor(v3, d);
+    Round(v0, v1, v2, v3);
+    Round(v0, v1, v2, v3);
+    v0 = Xor(v0, d);
+}
+
+/** The last word of a message: its remaining bytes and the low byte of its size. */
+uint64_t inline LastWord(Span<const unsigned char> data)
+{
+    const size_t size{data.size()};
+    const unsigned char* ptr{data.data() + (size & ~size_t{7})};
+    uint64_t t = uint64_t{size} << 56;
+    for (size_t i = 0; i < (size & 7); ++i) {
+        t |= uint64_t{ptr[i]} << (8 * i);
+    }
+    return t;
+}
+
+} // namespace
+
+void Hash_4way(uint64_t k0, uint64_t k1, const Span<const unsigned char>* strings, const size_t* indexes, uint64_t* out)
+{
+    const Span<const unsigned char> data[4]{strings[indexes[0]], strings[indexes[1]], strings[indexes[2]], strings[indexes[3]]};
+    __m256i v0 = K(0x736f6d6570736575ULL ^ k0);
+    __m256i v1 = K(0x646f72616e646f6dULL ^ k1);
+    __m256i v2 = K(0x6c7967656e657261ULL ^ k0);
+    __m256i v3 = K(0x7465646279746573ULL ^ k1);
+
+    // All four messages have the same number of whole words
+    const size_t words{data[0].size() / 8};
+    for (size_t i = 0; i < words; ++i) {
+        Compress(v0, v1, v2, v3, _mm256_set_epi64x(ReadLE64(data[3].data() + 8 * i), ReadLE64(data[2].data() + 8 * i),
+                                                   ReadLE64(data[1].data() + 8 * i), ReadLE64(data[0].data() + 8 * i)));
+    }
+    Compress(v0, v1, v2, v3, _mm256_set_epi64x(LastWord(data[3]), LastWord(data[2]), LastWord(data[1]), LastWord(data[0])));
+
+    v2 = Xor(v2, K(0xFF));
+    Round(v0, v1, v2, v3);
+    Round(v0, v1, v2, v3);
+    Round(v0, v1, v2, v3);
+    Round(v0, v1, v2, v3);
+    _mm256_storeu_si256((__m256i*)out, Xor(Xor(v0, v1), Xor(v2, v3)));
+}
+
+} // namespace siphash_avx2
+
+#endif
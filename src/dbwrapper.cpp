@@ -10,11 +10,13 @@
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <sync.h>
 #include <util/fs.h>
 #include <util/fs_helpers.h>
 #include <util/strencodings.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdarg>
 #include <cstdint>
@@ -32,6 +34,7 @@
 #include <memory>
 #include <optional>
 #include <utility>
+#include <vector>
 
 static auto CharCast(const std::byte* data) { return reinterpret_cast<const char*>(data); }
 
@@ -135,10 +138,113 @@ static void SetMaxOpenFiles(leveldb::Options *options) {
              options->max_open_files, default_open_files);
 }
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+struct DBBlockCache::Impl {
+    //! Per-database accounting, shared with the cached blocks of the database
+    struct Client {
+        const std::string name;
+        const double priority;
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<size_t> usage{0};
+    };
+
+    const std::unique_ptr<leveldb::Cache> cache;
+    mutable Mutex mutex;
+    std::vector<std::shared_ptr<Client>> clients GUARDED_BY(mutex);
+
+    explicit Impl(size_t capacity) : cache{leveldb::NewLRUCache(capacity)} {}
+};
+
+namespace {
+/** A database's view of a DBBlockCache, handed to LevelDB as its block cache. */
+class SharedCacheClient : public leveldb::Cache
+{
+private:
+    using Client = DBBlockCache::Impl::Client;
+    using Deleter = void (*)(const leveldb::Slice& key, void* value);
+
+    //! Value stored in the shared cache, wrapping the database's value
+    struct Entry {
+        void* value;
+        Deleter deleter;
+        size_t charge;
+        std::shared_ptr<Client> client;
+    };
+
+    static void DeleteEntry(const leveldb::Slice& key, void* value)
+    {
+        auto* entry{static_cast<Entry*>(value)};
+        entry->client->usage -= entry->charge;
+        entry->deleter(key, entry->value);
+        delete entry;
+    }
+
+    DBBlockCache::Impl& m_shared;
+    const std::shared_ptr<Client> m_client;
+
+public:
+    SharedCacheClient(DBBlockCache::Impl& shared, std::string name, double priority)
+        : m_shared{shared}, m_client{std::make_shared<Client>(std::move(name), priority)}
+    {
+        LOCK(m_shared.mutex);
+        m_shared.clients.push_back(m_client);
+    }
+
+    ~SharedCacheClient() override
+    {
+        // Blocks of this database may stay cached until evicted, but are
+        // never looked up again as every table gets a fresh cache id.
+        LOCK(m_shared.mutex);
+        m_shared.clients.erase(std::find(m_shared.clients.begin(), m_shared.clients.end(), m_client));
+    }
+
+    Handle* Insert(const leveldb::Slice& key, void* value, size_t charge, Deleter deleter) override
+    {
+        m_client->usage += charge;
+        auto* entry{new Entry{value, deleter, charge, m_client}};
+        return m_shared.cache->Insert(key, entry, static_cast<size_t>(charge / m_client->priority), &DeleteEntry);
+    }
+
+    Handle* Lookup(const leveldb::Slice& key) override
+    {
+        Handle* handle{m_shared.cache->Lookup(key)};
+        ++(handle ? m_client->hits : m_client->misses);
+        return handle;
+    }
+
+    void Release(Handle* handle) override { m_shared.cache->Release(handle); }
+    void* Value(Handle* handle) override { return static_cast<Entry*>(m_shared.cache->Value(handle))->value; }
+    void Erase(const leveldb::Slice& key) override { m_shared.cache->Erase(key); }
+    uint64_t NewId() override { return m_shared.cache->NewId(); }
+    //! Only the blocks of this database, as reported in its memory usage
+    size_t TotalCharge() const override { return m_client->usage; }
+};
+} // namespace
+
+DBBlockCache::DBBlockCache(size_t capacity_bytes)
+    : m_capacity{capacity_bytes}, m_impl{std::make_unique<Impl>(capacity_bytes)} {}
+
+DBBlockCache::~DBBlockCache() = default;
+
+size_t DBBlockCache::TotalCharge() const
+{
+    return m_impl->cache->TotalCharge();
+}
+
+std::vector<DBBlockCache::DatabaseStats> DBBlockCache::GetStats() const
+{
+    std::vector<DatabaseStats> stats;
+    LOCK(m_impl->mutex);
+    for (const auto& client : m_impl->clients) {
+        stats.push_back({client->name, client->priority, client->hits, client->misses, client->usage});
+    }
+    return stats;
+}
+
+static leveldb::Options GetOptions(size_t nCacheSize, leveldb::Cache* block_cache)
 {
     leveldb::Options options;
-    options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
+    options.block_cache = block_cache ? block_cache : leveldb::NewLRUCache(nCacheSize / 2);
     options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
     options.filter_policy = leveldb::NewBloomFilterPolicy(10);
     options.compression = leveldb::kNoCompression;
@@ -217,6 +323,9 @@ struct LevelDBContext {
 
     //! the database itself
     leveldb::DB* pdb;
+
+    //! shared block cache the database's block cache is a view of, if any
+    std::shared_ptr<DBBlockCache> shared_block_cache;
 };
 
 CDBWrapper::CDBWrapper(const DBParams& params)
@@ -227,8 +336,14 @@ CDBWrapper::CDBWrapper(const DBParams& params)
     DBContext().iteroptions.verify_checksums = true;
     DBContext().iteroptions.fill_cache = false;
     DBContext().syncoptions.sync = true;
-    DBContext().options = GetOptions(params.cache_bytes);
+    leveldb::Cache* block_cache{nullptr};
+    if (params.options.block_cache) {
+        DBContext().shared_block_cache = params.options.block_cache;
+        block_cache = new SharedCacheClient(*params.options.block_cache->m_impl, fs::PathToString(params.path), params.options.cache_priority);
+    }
+    DBContext().options = GetOptions(params.cache_bytes, block_cache);
     DBContext().options.create_if_missing = true;
+    DBContext().options.max_subcompactions = params.options.compaction_threads;
     if (params.memory_only) {
         DBContext().penv = leveldb::NewMemEnv(leveldb::Env::Default());
         DBContext().options.env = DBContext().penv;
@@ -317,6 +432,17 @@ size_t CDBWrapper::DynamicMemoryUsage() const
     return parsed.value();
 }
 
+uint64_t CDBWrapper::SplitCompactions() const
+{
+    std::string count;
+    std::optional<uint64_t> parsed;
+    if (!DBContext().pdb->GetProperty("leveldb.num-split-compactions", &count) || !(parsed = ToIntegral<uint64_t>(count))) {
+        LogPrint(BCLog::LEVELDB, "Failed to get num-split-compactions property\n");
+        return 0;
+    }
+    return parsed.value();
+}
+
 // Prefixed with null character to avoid collisions with other keys
 //
 // We must use a string constructor which specifies length so that we copy
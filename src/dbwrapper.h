@@ -14,6 +14,7 @@
 #include <util/fs.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <memory>
 #include <optional>
@@ -24,10 +25,26 @@
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
 
+class DBBlockCache;
+
+//! Priority of a database in a shared block cache, see DBBlockCache.
+static constexpr double DEFAULT_DB_CACHE_PRIORITY{1.0};
+//! Number of threads working on a single LevelDB compaction.
+static constexpr int DEFAULT_DB_COMPACTION_THREADS{1};
+static constexpr int MAX_DB_COMPACTION_THREADS{16};
+
 //! User-controlled performance and debug options.
 struct DBOptions {
     //! Compact database on startup.
     bool force_compact = false;
+    //! Number of threads splitting the key range of each compaction between
+    //! them, so that level-0 files are merged faster after large writes.
+    int compaction_threads = DEFAULT_DB_COMPACTION_THREADS;
+    //! Block cache shared with other databases. If null, the database uses a
+    //! private cache of half its cache_bytes.
+    std::shared_ptr<DBBlockCache> block_cache{};
+    //! Priority of this database in the shared block cache, in (0, 1].
+    double cache_priority = DEFAULT_DB_CACHE_PRIORITY;
 };
 
 //! Application-specific storage settings.
@@ -47,6 +64,48 @@ struct DBParams {
     DBOptions options{};
 };
 
+/**
+ * LevelDB block cache shared by several databases under a single memory
+ * budget.
+ *
+ * Blocks of all databases compete in one sharded LRU cache, so memory flows
+ * to whichever databases are being read the most (the chainstate during IBD,
+ * the indexes when serving requests) instead of being split at startup.
+ * Blocks are charged their size divided by the priority of their database,
+ * so lower priority databases hold less of the budget under contention.
+ */
+class DBBlockCache
+{
+public:
+    struct Impl;
+
+    struct DatabaseStats {
+        std::string name;
+        double priority;
+        uint64_t hits;
+        uint64_t misses;
+        //! Bytes of cached blocks of this database
+        size_t usage;
+    };
+
+    explicit DBBlockCache(size_t capacity_bytes);
+    ~DBBlockCache();
+
+    DBBlockCache(const DBBlockCache&) = delete;
+    DBBlockCache& operator=(const DBBlockCache&) = delete;
+
+    size_t Capacity() const { return m_capacity; }
+    //! Total charge of the cached blocks, at most Capacity()
+    size_t TotalCharge() const;
+    //! Statistics of the databases currently using the cache
+    std::vector<DatabaseStats> GetStats() const;
+
+private:
+    friend class CDBWrapper;
+    const size_t m_capacity;
+    const std::unique_ptr<Impl> m_impl;
+};
+
 class dbwrapper_error : public std::runtime_error
 {
 public:
@@ -276,6 +335,9 @@ public:
     // Get an estimate of LevelDB memory usage (in bytes).
     size_t DynamicMemoryUsage() const;
 
+    // Get the number of compactions that were split across several threads.
+    uint64_t SplitCompactions() const;
+
     CDBIterator* NewIterator();
 
     /**
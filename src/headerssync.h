@@ -214,6 +214,9 @@ private:
     /** Return a set of headers that satisfy our proof-of-work threshold */
     std::vector<CBlockHeader> PopHeadersReadyForAcceptance();
 
+    /** Hash of m_last_header_received, which is m_chain_start until the first header is received */
+    uint256 LastHeaderReceivedHash() const;
+
 private:
     /** NodeId of the peer (used for log messages) **/
     const NodeId m_id;
@@ -243,7 +246,9 @@ private:
      * memory bound on m_header_commitments. */
     uint64_t m_max_commitments{0};
 
-    /** Store the latest header received while in PRESYNC (initialized to m_chain_start) */
+    /** Store the latest header received while in PRESYNC (initialized to
+     * m_chain_start, of which only nBits and nTime are set, as the block index
+     * does not hold the full header) */
     CBlockHeader m_last_header_received;
 
     /** Height of m_last_header_received */
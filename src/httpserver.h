@@ -6,6 +6,9 @@
 #ifndef BETGENIUS_HTTPSERVER_H
 #define BETGENIUS_HTTPSERVER_H
 
+#include <span.h>
+
+#include <cstddef>
 #include <functional>
 #include <optional>
 #include <string>
@@ -130,6 +133,8 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+    /** Write HTTP reply with a binary body, without copying it into a string first. */
+    void WriteReply(int nStatus, Span<const std::byte> reply);
 };
 
 /** Get the query parameter value from request uri for a specified key, or std::nullopt if the key
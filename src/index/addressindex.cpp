@@ -0,0 +1,259 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/addressindex.h>
+
+#include <common/args.h>
+#include <crypto/sha256.h>
+#include <dbwrapper.h>
+#include <kernel/chain.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <script/script.h>
+#include <serialize.h>
+#include <undo.h>
+#include <validation.h>
+
+#include <cassert>
+
+/* The index database stores one entry per output paying to a spendable
+ * script. Keys have the type [DB_ADDRESS_OUTPUT, uint256 script hash,
+ * uint32 height (BE), uint256 txid, uint32 vout (BE)], so that the outputs of
+ * a script are found with a single seek and read in block order. Values hold
+ * the amount of the output and, once it is spent, the spending input.
+ *
+ * Entries only depend on the block creating or spending an output, and are
+ * written as a whole: the entry of a spent output is overwritten, not read
+ * and updated. Blocks must still be written in order, as the entry written
+ * when an output is spent replaces the one written when it was created.
+ */
+constexpr uint8_t DB_ADDRESS_OUTPUT{'a'};
+
+std::unique_ptr<AddressIndex> g_address_index;
+
+namespace {
+
+struct DBAddressKey {
+    uint256 script_hash;
+    int height{0};
+    uint256 txid;
+    uint32_t vout{0};
+
+    DBAddressKey() = default;
+    DBAddressKey(const uint256& script_hash_in, int height_in, const uint256& txid_in, uint32_t vout_in)
+        : script_hash{script_hash_in}, height{height_in}, txid{txid_in}, vout{vout_in} {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_ADDRESS_OUTPUT);
+        s << script_hash;
+        ser_writedata32be(s, height);
+        s << txid;
+        ser_writedata32be(s, vout);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_ADDRESS_OUTPUT) {
+            throw std::ios_base::failure("Invalid format for address index DB key");
+        }
+        s >> script_hash;
+        height = ser_readdata32be(s);
+        s >> txid;
+        vout = ser_readdata32be(s);
+    }
+};
+
+struct DBAddressValue {
+    CAmount value{0};
+    uint256 spent_txid;
+    uint32_t spent_vin{0};
+    int spent_height{0};
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << value;
+        const bool spent{!spent_txid.IsNull()};
+        s << spent;
+        if (spent) s << spent_txid << VARINT(spent_vin) << VARINT_MODE(spent_height, VarIntMode::NONNEGATIVE_SIGNED);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        bool spent;
+        s >> value >> spent;
+        if (spent) s >> spent_txid >> VARINT(spent_vin) >> VARINT_MODE(spent_height, VarIntMode::NONNEGATIVE_SIGNED);
+    }
+};
+
+} // namespace
+
+AddressIndex::AddressIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "addressindex")
+{
+    m_db = std::make_unique<BaseIndex::DB>(gArgs.GetDataDirNet() / "indexes" / "addressindex", n_cache_size, f_memory, f_wipe,
+                                           /*f_obfuscate=*/false, SharedBlockCache());
+}
+
+uint256 AddressIndex::ScriptHash(const CScript& script)
+{
+    uint256 hash;
+    CSHA256().Write(script.data(), script.size()).Finalize(hash.begin());
+    return hash;
+}
+
+bool AddressIndex::WriteBlock(const interfaces::BlockInfo& block, bool disconnect, CDBBatch& batch) const
+{
+    // Exclude genesis block transaction because outputs are not spendable.
+    if (block.height == 0) return true;
+
+    assert(block.data);
+    const CBlockIndex* pindex{WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash))};
+    const std::shared_ptr<const CBlockUndo> block_undo{pindex ? m_chainstate->m_blockman.m_index_reader.ReadUndo(*pindex) : nullptr};
+    if (!block_undo) {
+        return error("%s: Failed to read undo data of block %s", __func__, block.hash.ToString());
+    }
+    const auto& vtx{block.data->vtx};
+    if (block_undo->vtxundo.size() + 1 != vtx.size()) {
+        return error("%s: Undo data of block %s does not match its transactions", __func__, block.hash.ToString());
+    }
+
+    // Disconnected blocks are undone in reverse, so that outputs created and
+    // spent in the block end up erased.
+    for (size_t n = 0; n < vtx.size(); ++n) {
+        const size_t i{disconnect ? vtx.size() - 1 - n : n};
+        const CTransaction& tx{*vtx[i]};
+
+        if (disconnect) {
+            for (uint32_t j = 0; j < tx.vout.size(); ++j) {
+                const CScript& script{tx.vout[j].scriptPubKey};
+                if (script.IsUnspendable()) continue;
+                batch.Erase(DBAddressKey{ScriptHash(script), block.height, tx.GetHash(), j});
+            }
+        }
+
+        if (i > 0) {
+            const CTxUndo& tx_undo{block_undo->vtxundo[i - 1]};
+            for (uint32_t j = 0; j < tx.vin.size(); ++j) {
+                const COutPoint& prevout{tx.vin[j].prevout};
+                const Coin& coin{tx_undo.vprevout[j]};
+                DBAddressValue value;
+                value.value = coin.out.nValue;
+                if (!disconnect) {
+                    value.spent_txid = tx.GetHash();
+                    value.spent_vin = j;
+                    value.spent_height = block.height;
+                }
+                batch.Write(DBAddressKey{ScriptHash(coin.out.scriptPubKey), static_cast<int>(coin.nHeight), prevout.hash, prevout.n}, value);
+            }
+        }
+
+        if (!disconnect) {
+            for (uint32_t j = 0; j < tx.vout.size(); ++j) {
+                const CTxOut& out{tx.vout[j]};
+                if (out.scriptPubKey.IsUnspendable()) continue;
+                DBAddressValue value;
+                value.value = out.nValue;
+                batch.Write(DBAddressKey{ScriptHash(out.scriptPubKey), block.height, tx.GetHash(), j}, value);
+            }
+        }
+    }
+    return true;
+}
+
+bool AddressIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    CDBBatch batch(*m_db);
+    return WriteBlock(block, /*disconnect=*/false, batch) && m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::CustomPrepare(const interfaces::BlockInfo& block, CDBBatch& batch, std::any& payload) const
+{
+    return WriteBlock(block, /*disconnect=*/false, batch);
+}
+
+bool AddressIndex::CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip)
+{
+    CDBBatch batch(*m_db);
+    {
+        LOCK(cs_main);
+        const CBlockIndex* iter_tip{m_chainstate->m_blockman.LookupBlockIndex(current_tip.hash)};
+        const CBlockIndex* new_tip_index{m_chainstate->m_blockman.LookupBlockIndex(new_tip.hash)};
+
+        do {
+            CBlock block;
+            if (!m_chainstate->m_blockman.ReadBlockFromDisk(block, *iter_tip)) {
+                return error("%s: Failed to read block %s from disk",
+                             __func__, iter_tip->GetBlockHash().ToString());
+            }
+            interfaces::BlockInfo block_info{kernel::MakeBlockInfo(iter_tip, &block)};
+            if (!WriteBlock(block_info, /*disconnect=*/true, batch)) {
+                return false; // failure cause logged internally
+            }
+
+            iter_tip = iter_tip->GetAncestor(iter_tip->nHeight - 1);
+        } while (new_tip_index != iter_tip);
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::ForEachOutput(const uint256& script_hash, const std::function<bool(const AddressOutput&)>& fn) const
+{
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    for (db_it->Seek(DBAddressKey{script_hash, 0, uint256{}, 0}); db_it->Valid(); db_it->Next()) {
+        DBAddressKey key;
+        if (!db_it->GetKey(key) || key.script_hash != script_hash) break;
+        DBAddressValue value;
+        if (!db_it->GetValue(value)) {
+            return error("%s: Failed to read address index entry of %s:%u", __func__, key.txid.ToString(), key.vout);
+        }
+        const AddressOutput output{
+            .height = key.height,
+            .txid = key.txid,
+            .vout = key.vout,
+            .value = value.value,
+            .spent_txid = value.spent_txid,
+            .spent_vin = value.spent_vin,
+            .spent_height = value.spent_height,
+        };
+        if (!fn(output)) break;
+    }
+    return true;
+}
+
+bool AddressIndex::FindOutputs(const uint256& script_hash, std::vector<AddressOutput>& outputs, bool unspent_only,
+                               size_t skip, size_t count) const
+{
+    outputs.clear();
+    if (count == 0) return true;
+    return ForEachOutput(script_hash, [&](const AddressOutput& output) {
+        if (unspent_only && output.IsSpent()) return true;
+        if (skip > 0) {
+            --skip;
+            return true;
+        }
+        outputs.push_back(output);
+        return outputs.size() < count;
+    });
+}
+
+bool AddressIndex::GetBalance(const uint256& script_hash, AddressBalance& balance) const
+{
+    balance = AddressBalance{};
+    return ForEachOutput(script_hash, [&](const AddressOutput& output) {
+        balance.received += output.value;
+        ++balance.outputs;
+        if (!output.IsSpent()) {
+            balance.balance += output.value;
+            ++balance.unspent_outputs;
+        }
+        return true;
+    });
+}
@@ -0,0 +1,112 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_INDEX_ADDRESSINDEX_H
+#define BETGENIUS_INDEX_ADDRESSINDEX_H
+
+#include <consensus/amount.h>
+#include <index/base.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+class CDBBatch;
+class CScript;
+
+static constexpr bool DEFAULT_ADDRESSINDEX{false};
+
+/** An output paying to an indexed script, and the input spending it, if any. */
+struct AddressOutput {
+    int height{0};
+    uint256 txid;
+    uint32_t vout{0};
+    CAmount value{0};
+    //! Transaction, input and block height spending the output, if it is spent
+    uint256 spent_txid;
+    uint32_t spent_vin{0};
+    int spent_height{0};
+
+    bool IsSpent() const { return !spent_txid.IsNull(); }
+};
+
+/** Totals of the outputs paying to an indexed script. */
+struct AddressBalance {
+    //! Amount of the unspent outputs
+    CAmount balance{0};
+    //! Amount of all outputs
+    CAmount received{0};
+    int64_t outputs{0};
+    int64_t unspent_outputs{0};
+};
+
+/**
+ * AddressIndex records the outputs paying to each scriptPubKey, and the
+ * inputs spending them, so that the history, unspent outputs and balance of
+ * an address can be looked up. The index is written to a LevelDB database,
+ * with one entry per output keyed by the SHA256 hash of its scriptPubKey and
+ * the height of its block, so that the outputs of a script are read in block
+ * order.
+ *
+ * The entries of a block only depend on the block and its undo data, so the
+ * initial sync prepares ranges of blocks in parallel.
+ */
+class AddressIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+    bool AllowPrune() const override { return true; }
+
+    /** Add the entries of a block, or remove them if it is disconnected, to batch. */
+    [[nodiscard]] bool WriteBlock(const interfaces::BlockInfo& block, bool disconnect, CDBBatch& batch) const;
+
+    /** Call fn on the outputs paying to a script, in block order, until it returns false. Returns false on a database error. */
+    bool ForEachOutput(const uint256& script_hash, const std::function<bool(const AddressOutput&)>& fn) const;
+
+protected:
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool AllowParallelSync() const override { return true; }
+
+    bool CustomPrepare(const interfaces::BlockInfo& block, CDBBatch& batch, std::any& payload) const override;
+
+    bool CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Hash of a scriptPubKey, as the index keys it.
+    static uint256 ScriptHash(const CScript& script);
+
+    /// Look up the outputs paying to a script, in block order, a page at a time.
+    ///
+    /// @param[in]   script_hash  The ScriptHash() of the script.
+    /// @param[out]  outputs  The outputs paying to the script.
+    /// @param[in]   unspent_only  Whether to leave out spent outputs.
+    /// @param[in]   skip  Number of outputs to leave out before the first one returned.
+    /// @param[in]   count  Maximum number of outputs returned.
+    /// @return  false on a database error
+    bool FindOutputs(const uint256& script_hash, std::vector<AddressOutput>& outputs, bool unspent_only = false,
+                     size_t skip = 0, size_t count = std::numeric_limits<size_t>::max()) const;
+
+    /// Sum the outputs paying to a script, without holding them in memory.
+    ///
+    /// @param[in]   script_hash  The ScriptHash() of the script.
+    /// @param[out]  balance  The totals of the outputs paying to the script.
+    /// @return  false on a database error
+    bool GetBalance(const uint256& script_hash, AddressBalance& balance) const;
+};
+
+/// The global address index, used by the address RPCs and REST endpoints. May be null.
+extern std::unique_ptr<AddressIndex> g_address_index;
+
+#endif // BETGENIUS_INDEX_ADDRESSINDEX_H
@@ -5,6 +5,7 @@
 
 #include <chainparams.h>
 #include <common/args.h>
+#include <common/system.h>
 #include <index/base.h>
 #include <interfaces/chain.h>
 #include <kernel/chain.h>
@@ -16,17 +17,38 @@
 #include <node/interface_ui.h>
 #include <tinyformat.h>
 #include <util/thread.h>
+#include <util/threadpool.h>
 #include <util/translation.h>
 #include <validation.h> // For g_chainman
 #include <warnings.h>
 
+#include <algorithm>
+#include <any>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <optional>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 constexpr uint8_t DB_BEST_BLOCK{'B'};
 
 constexpr auto SYNC_LOG_INTERVAL{30s};
 constexpr auto SYNC_LOCATOR_WRITE_INTERVAL{30s};
+//! Number of worker threads and blocks per range of an index that prepares blocks in parallel
+constexpr int MAX_SYNC_THREADS{8};
+constexpr size_t SYNC_RANGE_BLOCKS{16};
+//! Priority of index databases in a shared block cache. An index miss delays
+//! an RPC or peer request, while a chainstate or block index miss delays block
+//! validation, so index blocks are charged twice their size: they are evicted
+//! first under contention but still use cache the chainstate leaves idle.
+constexpr double INDEX_DB_CACHE_PRIORITY{0.5};
+
+//! Time the current thread spent writing index batches, so that AppendTimed
+//! leaves out the writes of CustomAppend but not those of other threads
+static thread_local std::chrono::microseconds g_thread_write_time{0};
 
 template <typename... Args>
 void BaseIndex::FatalErrorf(const char* fmt, const Args&... args)
@@ -44,14 +66,21 @@ CBlockLocator GetLocator(interfaces::Chain& chain, const uint256& block_hash)
     return locator;
 }
 
-BaseIndex::DB::DB(const fs::path& path, size_t n_cache_size, bool f_memory, bool f_wipe, bool f_obfuscate) :
+BaseIndex::DB::DB(const fs::path& path, size_t n_cache_size, bool f_memory, bool f_wipe, bool f_obfuscate,
+                  std::shared_ptr<DBBlockCache> block_cache) :
     CDBWrapper{DBParams{
         .path = path,
         .cache_bytes = n_cache_size,
         .memory_only = f_memory,
         .wipe_data = f_wipe,
         .obfuscate = f_obfuscate,
-        .options = [] { DBOptions options; node::ReadDatabaseArgs(gArgs, options); return options; }()}}
+        .options = [&] {
+            DBOptions options;
+            node::ReadDatabaseArgs(gArgs, options);
+            options.block_cache = std::move(block_cache);
+            options.cache_priority = INDEX_DB_CACHE_PRIORITY;
+            return options;
+        }()}}
 {}
 
 bool BaseIndex::DB::ReadBestBlock(CBlockLocator& locator) const
@@ -68,6 +97,42 @@ void BaseIndex::DB::WriteBestBlock(CDBBatch& batch, const CBlockLocator& locator
     batch.Write(DB_BEST_BLOCK, locator);
 }
 
+bool BaseIndex::DB::WriteBatch(CDBBatch& batch, bool fSync)
+{
+    const size_t bytes{batch.SizeEstimate()};
+    const auto start{SteadyClock::now()};
+    const bool ok{CDBWrapper::WriteBatch(batch, fSync)};
+    const auto duration{std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - start)};
+    g_thread_write_time += duration;
+
+    LOCK(m_write_stats_mutex);
+    m_writes.Add(duration);
+    m_bytes_written += bytes;
+    return ok;
+}
+
+void BaseIndex::DB::GetWriteStats(IndexStats& stats) const
+{
+    LOCK(m_write_stats_mutex);
+    stats.commit = m_writes;
+    stats.bytes_written = m_bytes_written;
+}
+
+void IndexLatency::Add(std::chrono::microseconds duration)
+{
+    ++count;
+    total += duration;
+    size_t i{0};
+    while (i < NUM_BUCKETS - 1 && duration >= BucketLimit(i)) ++i;
+    ++buckets[i];
+}
+
+std::shared_ptr<DBBlockCache> BaseIndex::SharedBlockCache() const
+{
+    const node::NodeContext* context{m_chain->context()};
+    return context ? context->db_block_cache : nullptr;
+}
+
 BaseIndex::BaseIndex(std::unique_ptr<interfaces::Chain> chain, std::string name)
     : m_chain{std::move(chain)}, m_name{std::move(name)} {}
 
@@ -83,6 +148,7 @@ bool BaseIndex::Init()
 
     // May need reset if index is being restarted.
     m_interrupt.reset();
+    WITH_LOCK(m_stats_mutex, m_start_time = SteadyClock::now());
 
     // m_chainstate member gives indexing code access to node internals. It is
     // removed in followup https://github.com/BetGenius/BetGenius/pull/24230
@@ -142,12 +208,107 @@ static const CBlockIndex* NextSyncBlock(const CBlockIndex* pindex_prev, CChain&
     return chain.Next(chain.FindFork(pindex_prev));
 }
 
+namespace {
+//! Blocks of a range prepared by a sync worker
+struct PreparedRange {
+    CDBBatch batch;
+    std::vector<std::any> payloads;
+    //! Time spent reading and preparing each block
+    std::vector<std::pair<std::chrono::microseconds, std::chrono::microseconds>> timings;
+
+    explicit PreparedRange(const CDBWrapper& db) : batch{db} {}
+};
+} // namespace
+
+bool BaseIndex::AppendPrepared(ThreadPool& pool, const std::vector<const CBlockIndex*>& blocks)
+{
+    std::vector<std::future<std::unique_ptr<PreparedRange>>> futures;
+    for (size_t begin = 0; begin < blocks.size(); begin += SYNC_RANGE_BLOCKS) {
+        const size_t end{std::min(begin + SYNC_RANGE_BLOCKS, blocks.size())};
+        futures.push_back(pool.Submit([this, &blocks, begin, end]() -> std::unique_ptr<PreparedRange> {
+            auto range{std::make_unique<PreparedRange>(GetDB())};
+            range->payloads.resize(end - begin);
+            range->timings.resize(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                const auto read_start{SteadyClock::now()};
+                const std::shared_ptr<const CBlock> block{m_chainstate->m_blockman.m_index_reader.ReadBlock(*blocks[i])};
+                if (!block) {
+                    LogPrintf("%s: Failed to read block %s from disk\n", GetName(), blocks[i]->GetBlockHash().ToString());
+                    return nullptr;
+                }
+                const auto prepare_start{SteadyClock::now()};
+                if (!CustomPrepare(kernel::MakeBlockInfo(blocks[i], block.get()), range->batch, range->payloads[i - begin])) {
+                    LogPrintf("%s: Failed to prepare block %s\n", GetName(), blocks[i]->GetBlockHash().ToString());
+                    return nullptr;
+                }
+                range->timings[i - begin] = {std::chrono::duration_cast<std::chrono::microseconds>(prepare_start - read_start),
+                                             std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - prepare_start)};
+            }
+            return range;
+        }));
+    }
+
+    // Ranges are applied and written in block order, as a later block may
+    // depend on or overwrite the entries of an earlier one. Every range is
+    // waited for, as they refer to blocks.
+    bool ok{true};
+    for (size_t r = 0; r < futures.size(); ++r) {
+        std::unique_ptr<PreparedRange> range{futures[r].get()};
+        ok = ok && range;
+        for (size_t i = 0; ok && i < range->payloads.size(); ++i) {
+            const CBlockIndex* pindex{blocks[r * SYNC_RANGE_BLOCKS + i]};
+            const auto apply_start{SteadyClock::now()};
+            if (!CustomApply(kernel::MakeBlockInfo(pindex), range->payloads[i], range->batch)) {
+                LogPrintf("%s: Failed to apply block %s\n", GetName(), pindex->GetBlockHash().ToString());
+                ok = false;
+                continue;
+            }
+            const auto& [read, prepare]{range->timings[i]};
+            RecordBlock(read, prepare + std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - apply_start));
+        }
+        ok = ok && GetDB().WriteBatch(range->batch);
+    }
+    return ok;
+}
+
+bool BaseIndex::AppendTimed(const interfaces::BlockInfo& block, std::optional<std::chrono::microseconds> read)
+{
+    const auto write_time{g_thread_write_time};
+    const auto start{SteadyClock::now()};
+    if (!CustomAppend(block)) return false;
+    // Writes of the index to its database are counted apart
+    const auto elapsed{std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - start)};
+    RecordBlock(read, elapsed - (g_thread_write_time - write_time));
+    return true;
+}
+
+void BaseIndex::RecordBlock(std::optional<std::chrono::microseconds> read, std::chrono::microseconds compute)
+{
+    LOCK(m_stats_mutex);
+    ++m_stats.blocks;
+    if (read) m_stats.read.Add(*read);
+    m_stats.compute.Add(compute);
+    m_last_block_time = SteadyClock::now();
+}
+
 void BaseIndex::ThreadSync()
 {
     const CBlockIndex* pindex = m_best_block_index.load();
     if (!m_synced) {
         std::chrono::steady_clock::time_point last_log_time{0s};
         std::chrono::steady_clock::time_point last_locator_write_time{0s};
+
+        // Indexes that prepare blocks in parallel take as many blocks at once
+        // as the workers can read and prepare ahead of the ones applied.
+        ThreadPool pool{"idxsync"};
+        size_t max_blocks{1};
+        if (AllowParallelSync()) {
+            const int num_threads{std::clamp(GetNumCores(), 1, MAX_SYNC_THREADS)};
+            pool.Start(num_threads);
+            max_blocks = 2 * num_threads * SYNC_RANGE_BLOCKS;
+        }
+        std::vector<const CBlockIndex*> blocks;
+
         while (true) {
             if (m_interrupt) {
                 LogPrintf("%s: m_interrupt set; exiting ThreadSync\n", GetName());
@@ -176,6 +337,12 @@ void BaseIndex::ThreadSync()
                     return;
                 }
                 pindex = pindex_next;
+                blocks.assign(1, pindex);
+                while (blocks.size() < max_blocks) {
+                    const CBlockIndex* next{m_chainstate->m_chain.Next(blocks.back())};
+                    if (!next) break;
+                    blocks.push_back(next);
+                }
             }
 
             auto current_time{std::chrono::steady_clock::now()};
@@ -192,16 +359,28 @@ void BaseIndex::ThreadSync()
                 Commit();
             }
 
-            CBlock block;
+            if (AllowParallelSync()) {
+                if (!AppendPrepared(pool, blocks)) {
+                    FatalErrorf("%s: Failed to write blocks %s to %s to index database",
+                               __func__, blocks.front()->GetBlockHash().ToString(), blocks.back()->GetBlockHash().ToString());
+                    return;
+                }
+                pindex = blocks.back();
+                continue;
+            }
+
+            // Other indexes catching up read the same blocks
+            const auto read_start{SteadyClock::now()};
+            const std::shared_ptr<const CBlock> block{m_chainstate->m_blockman.m_index_reader.ReadBlock(*pindex)};
             interfaces::BlockInfo block_info = kernel::MakeBlockInfo(pindex);
-            if (!m_chainstate->m_blockman.ReadBlockFromDisk(block, *pindex)) {
+            if (!block) {
                 FatalErrorf("%s: Failed to read block %s from disk",
                            __func__, pindex->GetBlockHash().ToString());
                 return;
             } else {
-                block_info.data = &block;
+                block_info.data = block.get();
             }
-            if (!CustomAppend(block_info)) {
+            if (!AppendTimed(block_info, std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - read_start))) {
                 FatalErrorf("%s: Failed to write block %s to index database",
                            __func__, pindex->GetBlockHash().ToString());
                 return;
@@ -303,7 +482,7 @@ void BaseIndex::BlockConnected(ChainstateRole role, const std::shared_ptr<const
         }
     }
     interfaces::BlockInfo block_info = kernel::MakeBlockInfo(pindex, block.get());
-    if (CustomAppend(block_info)) {
+    if (AppendTimed(block_info, /*read=*/std::nullopt)) {
         // Setting the best block index is intentionally the last step of this
         // function, so BlockUntilSyncedToCurrentChain callers waiting for the
         // best block index to be updated can rely on the block being fully
@@ -394,7 +573,13 @@ bool BaseIndex::StartBackgroundSync()
 {
     if (!m_init) throw std::logic_error("Error: Cannot start a non-initialized index");
 
-    m_thread_sync = std::thread(&util::TraceThread, GetName(), [this] { ThreadSync(); });
+    // Share the blocks read with the other indexes until this one is synced
+    node::SharedBlockReader& reader{m_chainstate->m_blockman.m_index_reader};
+    reader.BeginSync();
+    m_thread_sync = std::thread(&util::TraceThread, GetName(), [this, &reader] {
+        ThreadSync();
+        reader.EndSync();
+    });
     return true;
 }
 
@@ -422,6 +607,22 @@ IndexSummary BaseIndex::GetSummary() const
     return summary;
 }
 
+IndexStats BaseIndex::GetStats() const
+{
+    IndexStats stats;
+    {
+        LOCK(m_stats_mutex);
+        stats = m_stats;
+        const SecondsDouble elapsed{m_last_block_time - m_start_time};
+        if (stats.blocks > 0 && elapsed.count() > 0) {
+            stats.blocks_per_second = stats.blocks / elapsed.count();
+        }
+    }
+    GetDB().GetWriteStats(stats);
+    stats.notifications_pending = GetMainSignals().CallbacksPending();
+    return stats;
+}
+
 void BaseIndex::SetBestBlockIndex(const CBlockIndex* block)
 {
     assert(!m_chainstate->m_blockman.IsPruneMode() || AllowPrune());
@@ -8,15 +8,24 @@
 
 #include <dbwrapper.h>
 #include <interfaces/chain.h>
+#include <sync.h>
 #include <util/threadinterrupt.h>
+#include <util/time.h>
 #include <validationinterface.h>
 
+#include <any>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <vector>
 
 class CBlock;
 class CBlockIndex;
 class Chainstate;
 class ChainstateManager;
+class ThreadPool;
 namespace interfaces {
 class Chain;
 } // namespace interfaces
@@ -28,6 +37,37 @@ struct IndexSummary {
     uint256 best_block_hash;
 };
 
+/** Histogram of the durations of an index operation. */
+struct IndexLatency {
+    //! Bucket i counts durations below BucketLimit(i), and the last bucket the longer ones
+    static constexpr size_t NUM_BUCKETS{12};
+
+    uint64_t count{0};
+    std::chrono::microseconds total{0};
+    std::array<uint64_t, NUM_BUCKETS> buckets{};
+
+    /** Upper bound of bucket i, doubling from 100us. */
+    static constexpr std::chrono::microseconds BucketLimit(size_t i) { return std::chrono::microseconds{int64_t{100} << i}; }
+
+    void Add(std::chrono::microseconds duration);
+};
+
+/** Activity of an index since it was started. */
+struct IndexStats {
+    uint64_t blocks{0};
+    //! Blocks indexed per second since the index was started
+    double blocks_per_second{0};
+    //! Reading blocks from disk, once per block
+    IndexLatency read;
+    //! Indexing blocks, once per block, not counting database writes
+    IndexLatency compute;
+    //! Writing batches to the index database
+    IndexLatency commit;
+    uint64_t bytes_written{0};
+    //! Validation interface notifications waiting to be handled, by all indexes
+    size_t notifications_pending{0};
+};
+
 /**
  * Base class for indices of blockchain data. This implements
  * CValidationInterface and ensures blocks are indexed sequentially according
@@ -52,13 +92,26 @@ protected:
     {
     public:
         DB(const fs::path& path, size_t n_cache_size,
-           bool f_memory = false, bool f_wipe = false, bool f_obfuscate = false);
+           bool f_memory = false, bool f_wipe = false, bool f_obfuscate = false,
+           std::shared_ptr<DBBlockCache> block_cache = {});
 
         /// Read block locator of the chain that the index is in sync with.
         bool ReadBestBlock(CBlockLocator& locator) const;
 
         /// Write block locator of the chain that the index is in sync with.
         void WriteBestBlock(CDBBatch& batch, const CBlockLocator& locator);
+
+        /// Write a batch, counting its size and the time taken. Hides
+        /// CDBWrapper::WriteBatch, so that the writes of every index are counted.
+        bool WriteBatch(CDBBatch& batch, bool fSync = false) EXCLUSIVE_LOCKS_REQUIRED(!m_write_stats_mutex);
+
+        /// Fill in the database writes of stats.
+        void GetWriteStats(IndexStats& stats) const EXCLUSIVE_LOCKS_REQUIRED(!m_write_stats_mutex);
+
+    private:
+        mutable Mutex m_write_stats_mutex;
+        IndexLatency m_writes GUARDED_BY(m_write_stats_mutex);
+        uint64_t m_bytes_written GUARDED_BY(m_write_stats_mutex){0};
     };
 
 private:
@@ -79,6 +132,15 @@ private:
     std::thread m_thread_sync;
     CThreadInterrupt m_interrupt;
 
+    mutable Mutex m_stats_mutex;
+    IndexStats m_stats GUARDED_BY(m_stats_mutex);
+    SteadyClock::time_point m_start_time GUARDED_BY(m_stats_mutex);
+    SteadyClock::time_point m_last_block_time GUARDED_BY(m_stats_mutex);
+
+    /// Count a block indexed, and the time spent reading it, unless it was
+    /// passed in by a notification, and indexing it.
+    void RecordBlock(std::optional<std::chrono::microseconds> read, std::chrono::microseconds compute) EXCLUSIVE_LOCKS_REQUIRED(!m_stats_mutex);
+
     /// Sync the index with the block index starting from the current best block.
     /// Intended to be run in its own thread, m_thread_sync, and can be
     /// interrupted with m_interrupt. Once the index gets in sync, the m_synced
@@ -96,6 +158,13 @@ private:
     /// getting corrupted.
     bool Commit();
 
+    /// Call CustomAppend() and count the block in the index stats.
+    bool AppendTimed(const interfaces::BlockInfo& block, std::optional<std::chrono::microseconds> read);
+
+    /// Prepare consecutive blocks with CustomPrepare(), in ranges on the
+    /// pool's workers, then apply and write them in block order.
+    bool AppendPrepared(ThreadPool& pool, const std::vector<const CBlockIndex*>& blocks);
+
     /// Loop over disconnected blocks and call CustomRewind.
     bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip);
 
@@ -119,6 +188,21 @@ protected:
     /// Write update index entries for a newly connected block.
     [[nodiscard]] virtual bool CustomAppend(const interfaces::BlockInfo& block) { return true; }
 
+    /// Whether the initial sync may split the indexing of a block in two: the
+    /// work that does not depend on the index state, done by CustomPrepare()
+    /// for ranges of blocks read ahead on worker threads, and the rest, done
+    /// by CustomApply() in block order.
+    virtual bool AllowParallelSync() const { return false; }
+
+    /// Write the index entries of a block that do not depend on the index
+    /// state into batch, and keep anything CustomApply() needs in payload.
+    /// Called on worker threads, only if AllowParallelSync().
+    [[nodiscard]] virtual bool CustomPrepare(const interfaces::BlockInfo& block, CDBBatch& batch, std::any& payload) const { return false; }
+
+    /// Finish indexing a block prepared by CustomPrepare(), in block order,
+    /// writing the remaining entries into batch. The block data is not set.
+    [[nodiscard]] virtual bool CustomApply(const interfaces::BlockInfo& block, std::any& payload, CDBBatch& batch) { return true; }
+
     /// Virtual method called internally by Commit that can be overridden to atomically
     /// commit more index state.
     virtual bool CustomCommit(CDBBatch& batch) { return true; }
@@ -129,6 +213,9 @@ protected:
 
     virtual DB& GetDB() const = 0;
 
+    /// Block cache shared with the node's other databases, if any.
+    std::shared_ptr<DBBlockCache> SharedBlockCache() const;
+
     /// Update the internal best block index as well as the prune lock.
     void SetBestBlockIndex(const CBlockIndex* block);
 
@@ -161,6 +248,9 @@ public:
 
     /// Get a summary of the index and its state.
     IndexSummary GetSummary() const;
+
+    /// Get counters and latencies of the work of the index since it was started.
+    IndexStats GetStats() const EXCLUSIVE_LOCKS_REQUIRED(!m_stats_mutex);
 };
 
 #endif // BETGENIUS_INDEX_BASE_H
@@ -109,7 +109,7 @@ BlockFilterIndex::BlockFilterIndex(std::unique_ptr<interfaces::Chain> chain, Blo
     fs::path path = gArgs.GetDataDirNet() / "indexes" / "blockfilter" / fs::u8path(filter_name);
     fs::create_directories(path);
 
-    m_db = std::make_unique<BaseIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe);
+    m_db = std::make_unique<BaseIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe, /*f_obfuscate=*/false, SharedBlockCache());
     m_filter_fileseq = std::make_unique<FlatFileSeq>(std::move(path), "fltr", FLTR_FILE_CHUNK_SIZE);
 }
 
@@ -216,35 +216,45 @@ size_t BlockFilterIndex::WriteFilterToDisk(FlatFilePos& pos, const BlockFilter&
     return data_size;
 }
 
-bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
+bool BlockFilterIndex::ComputeFilter(const interfaces::BlockInfo& block, BlockFilter& filter) const
 {
-    CBlockUndo block_undo;
-    uint256 prev_header;
-
+    std::shared_ptr<const CBlockUndo> block_undo;
     if (block.height > 0) {
         // pindex variable gives indexing code access to node internals. It
         // will be removed in upcoming commit
         const CBlockIndex* pindex = WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash));
-        if (!m_chainstate->m_blockman.UndoReadFromDisk(block_undo, *pindex)) {
+        block_undo = m_chainstate->m_blockman.m_index_reader.ReadUndo(*pindex);
+        if (!block_undo) {
             return false;
         }
+    }
+    filter = BlockFilter(m_filter_type, *Assert(block.data), block_undo ? *block_undo : CBlockUndo{});
+    return true;
+}
 
-        std::pair<uint256, DBVal> read_out;
-        if (!m_db->Read(DBHeightKey(block.height - 1), read_out)) {
-            return false;
-        }
+bool BlockFilterIndex::WriteFilter(const interfaces::BlockInfo& block, const BlockFilter& filter, CDBBatch& batch)
+{
+    uint256 prev_header;
 
+    if (block.height > 0) {
         uint256 expected_block_hash = *Assert(block.prev_hash);
-        if (read_out.first != expected_block_hash) {
-            return error("%s: previous block header belongs to unexpected block %s; expected %s",
-                         __func__, read_out.first.ToString(), expected_block_hash.ToString());
+        if (m_last_header && m_last_header->first == expected_block_hash) {
+            prev_header = m_last_header->second;
+        } else {
+            std::pair<uint256, DBVal> read_out;
+            if (!m_db->Read(DBHeightKey(block.height - 1), read_out)) {
+                return false;
+            }
+
+            if (read_out.first != expected_block_hash) {
+                return error("%s: previous block header belongs to unexpected block %s; expected %s",
+                             __func__, read_out.first.ToString(), expected_block_hash.ToString());
+            }
+
+            prev_header = read_out.second.header;
         }
-
-        prev_header = read_out.second.header;
     }
 
-    BlockFilter filter(m_filter_type, *Assert(block.data), block_undo);
-
     size_t bytes_written = WriteFilterToDisk(m_next_filter_pos, filter);
     if (bytes_written == 0) return false;
 
@@ -254,14 +264,38 @@ bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
     value.second.header = filter.ComputeHeader(prev_header);
     value.second.pos = m_next_filter_pos;
 
-    if (!m_db->Write(DBHeightKey(block.height), value)) {
-        return false;
-    }
+    batch.Write(DBHeightKey(block.height), value);
 
+    m_last_header.emplace(block.hash, value.second.header);
     m_next_filter_pos.nPos += bytes_written;
     return true;
 }
 
+bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    BlockFilter filter;
+    if (!ComputeFilter(block, filter)) return false;
+
+    CDBBatch batch(*m_db);
+    return WriteFilter(block, filter, batch) && m_db->WriteBatch(batch);
+}
+
+bool BlockFilterIndex::CustomPrepare(const interfaces::BlockInfo& block, CDBBatch& batch, std::any& payload) const
+{
+    // Building the filter is the bulk of the work, while its position and
+    // header depend on the filters before it.
+    BlockFilter filter;
+    if (!ComputeFilter(block, filter)) return false;
+    payload = std::move(filter);
+    return true;
+}
+
+bool BlockFilterIndex::CustomApply(const interfaces::BlockInfo& block, std::any& payload, CDBBatch& batch)
+{
+    const BlockFilter* filter{std::any_cast<BlockFilter>(&payload)};
+    return filter && WriteFilter(block, *filter, batch);
+}
+
 [[nodiscard]] static bool CopyHeightIndexToHashIndex(CDBIterator& db_it, CDBBatch& batch,
                                        const std::string& index_name,
                                        int start_height, int stop_height)
@@ -13,7 +13,9 @@
 #include <index/base.h>
 #include <util/hasher.h>
 
+#include <optional>
 #include <unordered_map>
+#include <utility>
 
 static const char* const DEFAULT_BLOCKFILTERINDEX = "0";
 
@@ -36,9 +38,18 @@ private:
     FlatFilePos m_next_filter_pos;
     std::unique_ptr<FlatFileSeq> m_filter_fileseq;
 
+    /** Hash and filter header of the last block written, so that the next one
+     *  does not read it back from the database. */
+    std::optional<std::pair<uint256, uint256>> m_last_header;
+
     bool ReadFilterFromDisk(const FlatFilePos& pos, const uint256& hash, BlockFilter& filter) const;
     size_t WriteFilterToDisk(FlatFilePos& pos, const BlockFilter& filter);
 
+    /** Build the filter of a block from the block and its undo data. */
+    bool ComputeFilter(const interfaces::BlockInfo& block, BlockFilter& filter) const;
+    /** Write the filter of a block to disk, and its database entry to batch. */
+    bool WriteFilter(const interfaces::BlockInfo& block, const BlockFilter& filter, CDBBatch& batch);
+
     Mutex m_cs_headers_cache;
     /** cache of block hash to filter header, to avoid disk access when responding to getcfcheckpt. */
     std::unordered_map<uint256, uint256, FilterHeaderHasher> m_headers_cache GUARDED_BY(m_cs_headers_cache);
@@ -52,6 +63,12 @@ protected:
 
     bool CustomAppend(const interfaces::BlockInfo& block) override;
 
+    bool AllowParallelSync() const override { return true; }
+
+    bool CustomPrepare(const interfaces::BlockInfo& block, CDBBatch& batch, std::any& payload) const override;
+
+    bool CustomApply(const interfaces::BlockInfo& block, std::any& payload, CDBBatch& batch) override;
+
     bool CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip) override;
 
     BaseIndex::DB& GetDB() const LIFETIMEBOUND override { return *m_db; }
@@ -0,0 +1,152 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/blockstatsindex.h>
+
+#include <chain.h>
+#include <common/args.h>
+#include <dbwrapper.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <serialize.h>
+#include <undo.h>
+#include <validation.h>
+
+#include <cassert>
+
+/* The index database stores the statistics of each block under keys of the
+ * type [DB_BLOCK_HEIGHT, uint32 height (BE)], so that a range of heights is
+ * read in key order. Values hold the block hash next to the statistics, and
+ * entries above the tip are erased when blocks are disconnected.
+ */
+constexpr uint8_t DB_BLOCK_HEIGHT{'t'};
+
+std::unique_ptr<BlockStatsIndex> g_block_stats_index;
+
+namespace {
+
+struct DBHeightKey {
+    int height;
+
+    explicit DBHeightKey(int height_in) : height(height_in) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_BLOCK_HEIGHT);
+        ser_writedata32be(s, height);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_BLOCK_HEIGHT) {
+            throw std::ios_base::failure("Invalid format for block stats index DB height key");
+        }
+        height = ser_readdata32be(s);
+    }
+};
+
+struct DBVal {
+    uint256 block_hash;
+    BlockStats stats;
+
+    SERIALIZE_METHODS(DBVal, obj) { READWRITE(obj.block_hash, obj.stats); }
+};
+
+} // namespace
+
+BlockStatsIndex::BlockStatsIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "blockstatsindex")
+{
+    m_db = std::make_unique<BaseIndex::DB>(gArgs.GetDataDirNet() / "indexes" / "blockstats", n_cache_size, f_memory, f_wipe,
+                                           /*f_obfuscate=*/false, SharedBlockCache());
+}
+
+bool BlockStatsIndex::WriteBlock(const interfaces::BlockInfo& block, CDBBatch& batch) const
+{
+    assert(block.data);
+    DBVal value;
+    value.block_hash = block.hash;
+    if (block.height > 0) {
+        const CBlockIndex* pindex{WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash))};
+        if (!pindex) {
+            return error("%s: Block %s not found in the block index", __func__, block.hash.ToString());
+        }
+        const std::shared_ptr<const CBlockUndo> block_undo{m_chainstate->m_blockman.m_index_reader.ReadUndo(*pindex)};
+        if (!block_undo) {
+            return error("%s: Failed to read undo data of block %s", __func__, block.hash.ToString());
+        }
+        value.stats = ComputeBlockStats(*block.data, block_undo.get());
+    } else {
+        // The genesis block has no undo data, and no inputs
+        value.stats = ComputeBlockStats(*block.data, nullptr);
+    }
+    batch.Write(DBHeightKey(block.height), value);
+    return true;
+}
+
+bool BlockStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    CDBBatch batch(*m_db);
+    if (!WriteBlock(block, batch)) return false;
+    return m_db->WriteBatch(batch);
+}
+
+bool BlockStatsIndex::CustomPrepare(const interfaces::BlockInfo& block, CDBBatch& batch, std::any& payload) const
+{
+    return WriteBlock(block, batch);
+}
+
+bool BlockStatsIndex::CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip)
+{
+    CDBBatch batch(*m_db);
+    for (int height = current_tip.height; height > new_tip.height; --height) {
+        batch.Erase(DBHeightKey(height));
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool BlockStatsIndex::LookupStats(const CBlockIndex& block_index, BlockStats& stats) const
+{
+    DBVal value;
+    if (!m_db->Read(DBHeightKey(block_index.nHeight), value) || value.block_hash != block_index.GetBlockHash()) {
+        return false;
+    }
+    stats = value.stats;
+    return true;
+}
+
+bool BlockStatsIndex::LookupStatsRange(int start_height, const CBlockIndex& stop_index, std::vector<BlockStats>& stats) const
+{
+    if (start_height < 0 || start_height > stop_index.nHeight ||
+        stop_index.nHeight - start_height >= MAX_BLOCK_STATS_RANGE) {
+        return error("%s: invalid height range %d-%d", __func__, start_height, stop_index.nHeight);
+    }
+
+    std::vector<DBVal> values(stop_index.nHeight - start_height + 1);
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    db_it->Seek(DBHeightKey(start_height));
+    for (int height = start_height; height <= stop_index.nHeight; ++height) {
+        DBHeightKey key(height);
+        if (!db_it->Valid() || !db_it->GetKey(key) || key.height != height) {
+            return false;
+        }
+        if (!db_it->GetValue(values[height - start_height])) {
+            return error("%s: unable to read value in %s at height %d", __func__, GetName(), height);
+        }
+        db_it->Next();
+    }
+
+    // Entries are of the blocks of the chain ending at stop_index
+    stats.resize(values.size());
+    for (const CBlockIndex* block_index = &stop_index; block_index && block_index->nHeight >= start_height; block_index = block_index->pprev) {
+        DBVal& value{values[block_index->nHeight - start_height]};
+        if (value.block_hash != block_index->GetBlockHash()) return false;
+        stats[block_index->nHeight - start_height] = std::move(value.stats);
+    }
+    return true;
+}
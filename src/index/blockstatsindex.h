@@ -0,0 +1,67 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_INDEX_BLOCKSTATSINDEX_H
+#define BETGENIUS_INDEX_BLOCKSTATSINDEX_H
+
+#include <blockstats.h>
+#include <index/base.h>
+
+#include <memory>
+#include <vector>
+
+class CBlockIndex;
+class CDBBatch;
+
+static constexpr bool DEFAULT_BLOCKSTATSINDEX{false};
+
+//! Maximum number of blocks whose statistics are looked up at once
+static constexpr int MAX_BLOCK_STATS_RANGE{1000};
+
+/**
+ * BlockStatsIndex keeps the getblockstats statistics of each block of the
+ * active chain, so that they are served without reading the block and its
+ * undo data. The index is written to a LevelDB database keyed by height.
+ *
+ * The statistics of a block only depend on the block and its undo data, so
+ * the initial sync computes them for ranges of blocks in parallel.
+ */
+class BlockStatsIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+    bool AllowPrune() const override { return true; }
+
+    /** Compute the statistics of a block and add them to batch. */
+    bool WriteBlock(const interfaces::BlockInfo& block, CDBBatch& batch) const;
+
+protected:
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool AllowParallelSync() const override { return true; }
+
+    bool CustomPrepare(const interfaces::BlockInfo& block, CDBBatch& batch, std::any& payload) const override;
+
+    bool CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit BlockStatsIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Look up the statistics of a block. Returns false if they are not indexed.
+    bool LookupStats(const CBlockIndex& block_index, BlockStats& stats) const;
+
+    /// Look up the statistics of the blocks from a height up to a block, with a
+    /// single database iterator. Returns false unless all of them are indexed,
+    /// or if there are more than MAX_BLOCK_STATS_RANGE.
+    bool LookupStatsRange(int start_height, const CBlockIndex& stop_index, std::vector<BlockStats>& stats) const;
+};
+
+/// The global block statistics index, used by getblockstats. May be null.
+extern std::unique_ptr<BlockStatsIndex> g_block_stats_index;
+
+#endif // BETGENIUS_INDEX_BLOCKSTATSINDEX_H
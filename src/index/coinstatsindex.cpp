@@ -110,88 +110,105 @@ CoinStatsIndex::CoinStatsIndex(std::unique_ptr<interfaces::Chain> chain, size_t
     fs::path path{gArgs.GetDataDirNet() / "indexes" / "coinstats"};
     fs::create_directories(path);
 
-    m_db = std::make_unique<CoinStatsIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe);
+    m_db = std::make_unique<CoinStatsIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe, /*f_obfuscate=*/false, SharedBlockCache());
 }
 
-bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
-{
-    CBlockUndo block_undo;
-    const CAmount block_subsidy{GetBlockSubsidy(block.height, Params().GetConsensus())};
-    m_total_subsidy += block_subsidy;
+struct CoinStatsIndex::BlockDelta {
+    //! Coins created divided by coins spent, normalized to a single number
+    MuHash3072 muhash;
+    int64_t transaction_output_count{0};
+    int64_t bogo_size{0};
+    CAmount total_amount{0};
+    CAmount total_prevout_spent_amount{0};
+    CAmount total_new_outputs_ex_coinbase_amount{0};
+    CAmount total_coinbase_amount{0};
+    CAmount total_unspendables_scripts{0};
+};
 
+bool CoinStatsIndex::ComputeBlockDelta(const interfaces::BlockInfo& block, BlockDelta& delta) const
+{
     // Ignore genesis block
-    if (block.height > 0) {
-        // pindex variable gives indexing code access to node internals. It
-        // will be removed in upcoming commit
-        const CBlockIndex* pindex = WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash));
-        if (!m_chainstate->m_blockman.UndoReadFromDisk(block_undo, *pindex)) {
-            return false;
-        }
+    if (block.height == 0) return true;
 
-        std::pair<uint256, DBVal> read_out;
-        if (!m_db->Read(DBHeightKey(block.height - 1), read_out)) {
-            return false;
-        }
+    // pindex variable gives indexing code access to node internals. It
+    // will be removed in upcoming commit
+    const CBlockIndex* pindex = WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash));
+    const std::shared_ptr<const CBlockUndo> block_undo{m_chainstate->m_blockman.m_index_reader.ReadUndo(*pindex)};
+    if (!block_undo) {
+        return false;
+    }
 
-        uint256 expected_block_hash{*Assert(block.prev_hash)};
-        if (read_out.first != expected_block_hash) {
-            LogPrintf("WARNING: previous block header belongs to unexpected block %s; expected %s\n",
-                      read_out.first.ToString(), expected_block_hash.ToString());
+    // Add the new utxos created from the block
+    assert(block.data);
+    for (size_t i = 0; i < block.data->vtx.size(); ++i) {
+        const auto& tx{block.data->vtx.at(i)};
 
-            if (!m_db->Read(DBHashKey(expected_block_hash), read_out)) {
-                return error("%s: previous block header not found; expected %s",
-                             __func__, expected_block_hash.ToString());
+        for (uint32_t j = 0; j < tx->vout.size(); ++j) {
+            const CTxOut& out{tx->vout[j]};
+            Coin coin{out, block.height, tx->IsCoinBase()};
+            COutPoint outpoint{tx->GetHash(), j};
+
+            // Skip unspendable coins
+            if (coin.out.scriptPubKey.IsUnspendable()) {
+                delta.total_unspendables_scripts += coin.out.nValue;
+                continue;
             }
-        }
 
-        // Add the new utxos created from the block
-        assert(block.data);
-        for (size_t i = 0; i < block.data->vtx.size(); ++i) {
-            const auto& tx{block.data->vtx.at(i)};
+            ApplyCoinHash(delta.muhash, outpoint, coin);
 
-            for (uint32_t j = 0; j < tx->vout.size(); ++j) {
-                const CTxOut& out{tx->vout[j]};
-                Coin coin{out, block.height, tx->IsCoinBase()};
-                COutPoint outpoint{tx->GetHash(), j};
+            if (tx->IsCoinBase()) {
+                delta.total_coinbase_amount += coin.out.nValue;
+            } else {
+                delta.total_new_outputs_ex_coinbase_amount += coin.out.nValue;
+            }
 
-                // Skip unspendable coins
-                if (coin.out.scriptPubKey.IsUnspendable()) {
-                    m_total_unspendable_amount += coin.out.nValue;
-                    m_total_unspendables_scripts += coin.out.nValue;
-                    continue;
-                }
+            ++delta.transaction_output_count;
+            delta.total_amount += coin.out.nValue;
+            delta.bogo_size += GetBogoSize(coin.out.scriptPubKey);
+        }
 
-                ApplyCoinHash(m_muhash, outpoint, coin);
+        // The coinbase tx has no undo data since no former output is spent
+        if (!tx->IsCoinBase()) {
+            const auto& tx_undo{block_undo->vtxundo.at(i - 1)};
 
-                if (tx->IsCoinBase()) {
-                    m_total_coinbase_amount += coin.out.nValue;
-                } else {
-                    m_total_new_outputs_ex_coinbase_amount += coin.out.nValue;
-                }
+            for (size_t j = 0; j < tx_undo.vprevout.size(); ++j) {
+                Coin coin{tx_undo.vprevout[j]};
+                COutPoint outpoint{tx->vin[j].prevout.hash, tx->vin[j].prevout.n};
 
-                ++m_transaction_output_count;
-                m_total_amount += coin.out.nValue;
-                m_bogo_size += GetBogoSize(coin.out.scriptPubKey);
-            }
+                RemoveCoinHash(delta.muhash, outpoint, coin);
 
-            // The coinbase tx has no undo data since no former output is spent
-            if (!tx->IsCoinBase()) {
-                const auto& tx_undo{block_undo.vtxundo.at(i - 1)};
+                delta.total_prevout_spent_amount += coin.out.nValue;
 
-                for (size_t j = 0; j < tx_undo.vprevout.size(); ++j) {
-                    Coin coin{tx_undo.vprevout[j]};
-                    COutPoint outpoint{tx->vin[j].prevout.hash, tx->vin[j].prevout.n};
+                --delta.transaction_output_count;
+                delta.total_amount -= coin.out.nValue;
+                delta.bogo_size -= GetBogoSize(coin.out.scriptPubKey);
+            }
+        }
+    }
 
-                    RemoveCoinHash(m_muhash, outpoint, coin);
+    // Dividing once here leaves the running hash with a denominator of one,
+    // so that applying the block and finalizing the hash of every block take
+    // a multiplication each instead of a modular inverse.
+    delta.muhash.Normalize();
+    return true;
+}
 
-                    m_total_prevout_spent_amount += coin.out.nValue;
+void CoinStatsIndex::ApplyBlockDelta(const interfaces::BlockInfo& block, const BlockDelta& delta, CDBBatch& batch)
+{
+    const CAmount block_subsidy{GetBlockSubsidy(block.height, Params().GetConsensus())};
+    m_total_subsidy += block_subsidy;
 
-                    --m_transaction_output_count;
-                    m_total_amount -= coin.out.nValue;
-                    m_bogo_size -= GetBogoSize(coin.out.scriptPubKey);
-                }
-            }
-        }
+    // Ignore genesis block
+    if (block.height > 0) {
+        m_muhash *= delta.muhash;
+        m_transaction_output_count += delta.transaction_output_count;
+        m_bogo_size += delta.bogo_size;
+        m_total_amount += delta.total_amount;
+        m_total_prevout_spent_amount += delta.total_prevout_spent_amount;
+        m_total_new_outputs_ex_coinbase_amount += delta.total_new_outputs_ex_coinbase_amount;
+        m_total_coinbase_amount += delta.total_coinbase_amount;
+        m_total_unspendable_amount += delta.total_unspendables_scripts;
+        m_total_unspendables_scripts += delta.total_unspendables_scripts;
     } else {
         // genesis block
         m_total_unspendable_amount += block_subsidy;
@@ -227,7 +244,60 @@ bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
 
     // Intentionally do not update DB_MUHASH here so it stays in sync with
     // DB_BEST_BLOCK, and the index is not corrupted if there is an unclean shutdown.
-    return m_db->Write(DBHeightKey(block.height), value);
+    batch.Write(DBHeightKey(block.height), value);
+    m_block_hash = block.hash;
+}
+
+bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    if (block.height > 0) {
+        std::pair<uint256, DBVal> read_out;
+        if (!m_db->Read(DBHeightKey(block.height - 1), read_out)) {
+            return false;
+        }
+
+        uint256 expected_block_hash{*Assert(block.prev_hash)};
+        if (read_out.first != expected_block_hash) {
+            LogPrintf("WARNING: previous block header belongs to unexpected block %s; expected %s\n",
+                      read_out.first.ToString(), expected_block_hash.ToString());
+
+            if (!m_db->Read(DBHashKey(expected_block_hash), read_out)) {
+                return error("%s: previous block header not found; expected %s",
+                             __func__, expected_block_hash.ToString());
+            }
+        }
+    }
+
+    BlockDelta delta;
+    if (!ComputeBlockDelta(block, delta)) return false;
+
+    CDBBatch batch(*m_db);
+    ApplyBlockDelta(block, delta, batch);
+    return m_db->WriteBatch(batch);
+}
+
+bool CoinStatsIndex::CustomPrepare(const interfaces::BlockInfo& block, CDBBatch& batch, std::any& payload) const
+{
+    // Hashing the coins of a block is the bulk of the work, while the
+    // statistics depend on the blocks before it.
+    BlockDelta delta;
+    if (!ComputeBlockDelta(block, delta)) return false;
+    payload = std::move(delta);
+    return true;
+}
+
+bool CoinStatsIndex::CustomApply(const interfaces::BlockInfo& block, std::any& payload, CDBBatch& batch)
+{
+    const BlockDelta* delta{std::any_cast<BlockDelta>(&payload)};
+    if (!delta) return false;
+    // The entry of the previous block may not be written yet, unlike in
+    // CustomAppend, so the block is checked against the running statistics.
+    if (block.height > 0 && *Assert(block.prev_hash) != m_block_hash) {
+        return error("%s: previous block %s is not the one of the statistics, %s",
+                     __func__, block.prev_hash->ToString(), m_block_hash.ToString());
+    }
+    ApplyBlockDelta(block, *delta, batch);
+    return true;
 }
 
 [[nodiscard]] static bool CopyHeightIndexToHashIndex(CDBIterator& db_it, CDBBatch& batch,
@@ -290,6 +360,7 @@ bool CoinStatsIndex::CustomRewind(const interfaces::BlockKey& current_tip, const
             iter_tip = iter_tip->GetAncestor(iter_tip->nHeight - 1);
         } while (new_tip_index != iter_tip);
     }
+    m_block_hash = new_tip.hash;
 
     return true;
 }
@@ -378,6 +449,7 @@ bool CoinStatsIndex::CustomInit(const std::optional<interfaces::BlockKey>& block
         m_total_unspendables_bip30 = entry.total_unspendables_bip30;
         m_total_unspendables_scripts = entry.total_unspendables_scripts;
         m_total_unspendables_unclaimed_rewards = entry.total_unspendables_unclaimed_rewards;
+        m_block_hash = block->hash;
     }
 
     return true;
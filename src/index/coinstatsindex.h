@@ -38,6 +38,16 @@ private:
     CAmount m_total_unspendables_bip30{0};
     CAmount m_total_unspendables_scripts{0};
     CAmount m_total_unspendables_unclaimed_rewards{0};
+    //! Hash of the block the running statistics are at
+    uint256 m_block_hash;
+
+    /** Changes a block makes to the UTXO set statistics. */
+    struct BlockDelta;
+
+    /** Compute the changes of a block from the block and its undo data. */
+    [[nodiscard]] bool ComputeBlockDelta(const interfaces::BlockInfo& block, BlockDelta& delta) const;
+    /** Apply the changes of a block to the running statistics, and write its entry to batch. */
+    void ApplyBlockDelta(const interfaces::BlockInfo& block, const BlockDelta& delta, CDBBatch& batch);
 
     [[nodiscard]] bool ReverseBlock(const CBlock& block, const CBlockIndex* pindex);
 
@@ -50,6 +60,12 @@ protected:
 
     bool CustomAppend(const interfaces::BlockInfo& block) override;
 
+    bool AllowParallelSync() const override { return true; }
+
+    bool CustomPrepare(const interfaces::BlockInfo& block, CDBBatch& batch, std::any& payload) const override;
+
+    bool CustomApply(const interfaces::BlockInfo& block, std::any& payload, CDBBatch& batch) override;
+
     bool CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip) override;
 
     BaseIndex::DB& GetDB() const override { return *m_db; }
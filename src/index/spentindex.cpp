@@ -0,0 +1,155 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/spentindex.h>
+
+#include <common/args.h>
+#include <dbwrapper.h>
+#include <kernel/chain.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+/* The index database stores one entry per spent output. Keys have the type
+ * [DB_SPENT_OUTPUT, uint256 txid, uint32 vout (BE)], so that the outputs of a
+ * transaction are next to each other, and values hold the spending input.
+ */
+constexpr uint8_t DB_SPENT_OUTPUT{'p'};
+
+std::unique_ptr<SpentIndex> g_spent_index;
+
+namespace {
+
+struct DBSpentKey {
+    uint256 txid;
+    uint32_t vout{0};
+
+    DBSpentKey() = default;
+    explicit DBSpentKey(const COutPoint& outpoint) : txid{outpoint.hash}, vout{outpoint.n} {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_SPENT_OUTPUT);
+        s << txid;
+        ser_writedata32be(s, vout);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_SPENT_OUTPUT) {
+            throw std::ios_base::failure("Invalid format for spent index DB key");
+        }
+        s >> txid;
+        vout = ser_readdata32be(s);
+    }
+
+    bool operator==(const DBSpentKey& other) const { return txid == other.txid && vout == other.vout; }
+};
+
+struct DBSpentValue {
+    SpentInfo info;
+
+    SERIALIZE_METHODS(DBSpentValue, obj)
+    {
+        READWRITE(obj.info.txid, VARINT(obj.info.vin), VARINT_MODE(obj.info.height, VarIntMode::NONNEGATIVE_SIGNED));
+    }
+};
+
+} // namespace
+
+SpentIndex::SpentIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "spentindex")
+{
+    m_db = std::make_unique<BaseIndex::DB>(gArgs.GetDataDirNet() / "indexes" / "spentindex", n_cache_size, f_memory, f_wipe,
+                                           /*f_obfuscate=*/false, SharedBlockCache());
+}
+
+void SpentIndex::WriteBlock(const interfaces::BlockInfo& block, bool disconnect, CDBBatch& batch) const
+{
+    assert(block.data);
+    for (const auto& tx : block.data->vtx) {
+        if (tx->IsCoinBase()) continue;
+        for (uint32_t i = 0; i < tx->vin.size(); ++i) {
+            const DBSpentKey key{tx->vin[i].prevout};
+            if (disconnect) {
+                batch.Erase(key);
+            } else {
+                DBSpentValue value;
+                value.info.txid = tx->GetHash();
+                value.info.vin = i;
+                value.info.height = block.height;
+                batch.Write(key, value);
+            }
+        }
+    }
+}
+
+bool SpentIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    CDBBatch batch(*m_db);
+    WriteBlock(block, /*disconnect=*/false, batch);
+    return m_db->WriteBatch(batch);
+}
+
+bool SpentIndex::CustomPrepare(const interfaces::BlockInfo& block, CDBBatch& batch, std::any& payload) const
+{
+    WriteBlock(block, /*disconnect=*/false, batch);
+    return true;
+}
+
+bool SpentIndex::CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip)
+{
+    CDBBatch batch(*m_db);
+    {
+        LOCK(cs_main);
+        const CBlockIndex* iter_tip{m_chainstate->m_blockman.LookupBlockIndex(current_tip.hash)};
+        const CBlockIndex* new_tip_index{m_chainstate->m_blockman.LookupBlockIndex(new_tip.hash)};
+
+        do {
+            CBlock block;
+            if (!m_chainstate->m_blockman.ReadBlockFromDisk(block, *iter_tip)) {
+                return error("%s: Failed to read block %s from disk",
+                             __func__, iter_tip->GetBlockHash().ToString());
+            }
+            WriteBlock(kernel::MakeBlockInfo(iter_tip, &block), /*disconnect=*/true, batch);
+
+            iter_tip = iter_tip->GetAncestor(iter_tip->nHeight - 1);
+        } while (new_tip_index != iter_tip);
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool SpentIndex::FindSpends(const std::vector<COutPoint>& outpoints, std::vector<std::optional<SpentInfo>>& spends) const
+{
+    spends.assign(outpoints.size(), std::nullopt);
+
+    // Seeking in key order keeps the iterator moving forward through the database
+    std::vector<size_t> order(outpoints.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return outpoints[a] < outpoints[b]; });
+
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    for (const size_t i : order) {
+        const DBSpentKey key{outpoints[i]};
+        db_it->Seek(key);
+        DBSpentKey found;
+        if (!db_it->Valid() || !db_it->GetKey(found) || !(found == key)) continue;
+        DBSpentValue value;
+        if (!db_it->GetValue(value)) {
+            return error("%s: Failed to read spent index entry of %s", __func__, outpoints[i].ToString());
+        }
+        spends[i] = value.info;
+    }
+    return true;
+}
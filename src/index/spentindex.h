@@ -0,0 +1,75 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_INDEX_SPENTINDEX_H
+#define BETGENIUS_INDEX_SPENTINDEX_H
+
+#include <index/base.h>
+#include <uint256.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+class CDBBatch;
+class COutPoint;
+
+static constexpr bool DEFAULT_SPENTINDEX{false};
+
+/** The input spending an output. */
+struct SpentInfo {
+    uint256 txid;
+    uint32_t vin{0};
+    int height{0};
+};
+
+/**
+ * SpentIndex records, for each output spent in the active chain, the
+ * transaction input spending it. The index is written to a LevelDB database
+ * keyed by outpoint.
+ *
+ * The entries of a block only depend on its inputs, so the initial sync
+ * prepares ranges of blocks in parallel, and a disconnected block is undone
+ * without its undo data.
+ */
+class SpentIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+    bool AllowPrune() const override { return true; }
+
+    /** Add the entries of a block, or remove them if it is disconnected, to batch. */
+    void WriteBlock(const interfaces::BlockInfo& block, bool disconnect, CDBBatch& batch) const;
+
+protected:
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool AllowParallelSync() const override { return true; }
+
+    bool CustomPrepare(const interfaces::BlockInfo& block, CDBBatch& batch, std::any& payload) const override;
+
+    bool CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit SpentIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Look up the inputs spending outputs. Lookups are done in key order
+    /// with a single database iterator, so large batches are cheaper per
+    /// output than single ones.
+    ///
+    /// @param[in]   outpoints  The outputs to look up.
+    /// @param[out]  spends  For each output, the input spending it, if it is spent.
+    /// @return  false on a database error
+    bool FindSpends(const std::vector<COutPoint>& outpoints, std::vector<std::optional<SpentInfo>>& spends) const;
+};
+
+/// The global spent index, used by the getspendinginfo RPC. May be null.
+extern std::unique_ptr<SpentIndex> g_spent_index;
+
+#endif // BETGENIUS_INDEX_SPENTINDEX_H
@@ -7,59 +7,222 @@
 
 #include <clientversion.h>
 #include <common/args.h>
+#include <common/bloom.h>
 #include <index/disktxpos.h>
+#include <kernel/chain.h>
 #include <logging.h>
+#include <node/blockformat.h>
 #include <node/blockstorage.h>
+#include <serialize.h>
+#include <util/time.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+/* Transactions are stored under keys of the type
+ * [DB_TXINDEX_COMPACT, uint64 txid prefix, CDiskTxPos] and a zero byte value,
+ * where the prefix is the first 8 bytes of the txid. Transactions sharing a
+ * prefix have an entry each, told apart on lookup by reading the transaction
+ * at each position. Databases written by earlier versions hold entries of the
+ * type [DB_TXINDEX, uint256 txid] -> CDiskTxPos, which are still looked up.
+ *
+ * The number of entries is kept under DB_TXINDEX_COUNT, written on commit, to
+ * size the existence filter on startup. It may count entries written again
+ * after an unclean shutdown more than once.
+ */
 constexpr uint8_t DB_TXINDEX{'t'};
+constexpr uint8_t DB_TXINDEX_COMPACT{'T'};
+constexpr uint8_t DB_TXINDEX_COUNT{'c'};
+
+//! Minimum number of transactions the existence filter is sized for
+static constexpr uint64_t MIN_TXINDEX_FILTER_ELEMENTS{1 << 20};
+//! Part of the txindex cache, in 1/N, that the existence filter may use
+static constexpr size_t TXINDEX_FILTER_CACHE_DIVISOR{4};
 
 std::unique_ptr<TxIndex> g_txindex;
 
+namespace {
+
+uint64_t TxidPrefix(const uint256& txid) { return txid.GetUint64(0); }
+
+struct DBTxPrefix {
+    uint64_t prefix{0};
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_TXINDEX_COMPACT);
+        ser_writedata64(s, prefix);
+    }
+};
+
+struct DBTxKey {
+    uint64_t prefix{0};
+    CDiskTxPos pos;
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_TXINDEX_COMPACT);
+        ser_writedata64(s, prefix);
+        s << pos;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t key{ser_readdata8(s)};
+        if (key != DB_TXINDEX_COMPACT) {
+            throw std::ios_base::failure("Invalid format for txindex DB key");
+        }
+        prefix = ser_readdata64(s);
+        s >> pos;
+    }
+};
+
+} // namespace
 
 /** Access to the txindex database (indexes/txindex/) */
 class TxIndex::DB : public BaseIndex::DB
 {
+private:
+    //! Prefixes of the indexed txids, so that most lookups of transactions
+    //! which are not indexed return without reading the database
+    std::unique_ptr<CBlockedBloomFilter> m_filter;
+    //! Whether the database has entries of the former format
+    bool m_legacy_entries{false};
+    //! Number of entries, at least
+    std::atomic<uint64_t> m_count{0};
+
+    void LoadFilter(size_t max_memory);
+
 public:
-    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false, std::shared_ptr<DBBlockCache> block_cache = {});
 
-    /// Read the disk location of the transaction data with the given hash. Returns false if the
-    /// transaction hash is not indexed.
-    bool ReadTxPos(const uint256& txid, CDiskTxPos& pos) const;
+    /// Read the disk locations of the transactions whose hash may be the given one. Returns
+    /// false if there are none.
+    bool ReadTxPos(const uint256& txid, std::vector<CDiskTxPos>& positions);
 
     /// Write a batch of transaction positions to the DB.
     [[nodiscard]] bool WriteTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos);
+
+    /// Add transaction positions to batch.
+    void WriteTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos, CDBBatch& batch);
+
+    /// Add the removal of transaction positions to batch.
+    void EraseTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos, CDBBatch& batch);
+
+    /// Add the number of entries to batch.
+    void WriteCount(CDBBatch& batch) const;
 };
 
-TxIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
-    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "txindex", n_cache_size, f_memory, f_wipe)
-{}
+TxIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe, std::shared_ptr<DBBlockCache> block_cache) :
+    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "txindex", n_cache_size - n_cache_size / TXINDEX_FILTER_CACHE_DIVISOR,
+                  f_memory, f_wipe, /*f_obfuscate=*/false, std::move(block_cache))
+{
+    LoadFilter(n_cache_size / TXINDEX_FILTER_CACHE_DIVISOR);
+}
 
-bool TxIndex::DB::ReadTxPos(const uint256 &txid, CDiskTxPos& pos) const
+void TxIndex::DB::LoadFilter(size_t max_memory)
 {
-    return Read(std::make_pair(DB_TXINDEX, txid), pos);
+    const auto start{SteadyClock::now()};
+    std::unique_ptr<CDBIterator> db_it(NewIterator());
+    const auto for_each_prefix{[&](const auto& fn) {
+        for (db_it->Seek(DB_TXINDEX_COMPACT); db_it->Valid(); db_it->Next()) {
+            DBTxKey key;
+            if (!db_it->GetKey(key)) break;
+            fn(key.prefix);
+        }
+        for (db_it->Seek(DB_TXINDEX); db_it->Valid(); db_it->Next()) {
+            std::pair<uint8_t, uint256> key;
+            if (!db_it->GetKey(key) || key.first != DB_TXINDEX) break;
+            fn(TxidPrefix(key.second));
+            m_legacy_entries = true;
+        }
+    }};
+
+    uint64_t count{0};
+    if (!Read(DB_TXINDEX_COUNT, count)) {
+        // Databases written before the count was kept are counted once
+        for_each_prefix([&](uint64_t) { ++count; });
+    }
+    m_count = count;
+
+    // Leave room for the index to grow until the next start, within the part
+    // of the cache the filter may use
+    m_filter = std::make_unique<CBlockedBloomFilter>(std::min(std::max<uint64_t>(2 * count, MIN_TXINDEX_FILTER_ELEMENTS),
+                                                              CBlockedBloomFilter::MaxElements(max_memory)));
+    uint64_t loaded{0};
+    for_each_prefix([&](uint64_t prefix) {
+        m_filter->insert(prefix);
+        ++loaded;
+    });
+    LogPrintf("txindex: loaded filter of %u transactions (%.1f MiB) in %dms\n", loaded,
+              m_filter->GetMemoryUsage() / double(1 << 20), Ticks<std::chrono::milliseconds>(SteadyClock::now() - start));
+}
+
+bool TxIndex::DB::ReadTxPos(const uint256& txid, std::vector<CDiskTxPos>& positions)
+{
+    positions.clear();
+    const uint64_t prefix{TxidPrefix(txid)};
+    if (!m_filter->contains(prefix)) return false;
+
+    std::unique_ptr<CDBIterator> db_it(NewIterator());
+    for (db_it->Seek(DBTxPrefix{prefix}); db_it->Valid(); db_it->Next()) {
+        DBTxKey key;
+        if (!db_it->GetKey(key) || key.prefix != prefix) break;
+        positions.push_back(key.pos);
+    }
+    if (m_legacy_entries) {
+        CDiskTxPos pos;
+        if (Read(std::make_pair(DB_TXINDEX, txid), pos)) positions.push_back(pos);
+    }
+    return !positions.empty();
 }
 
 bool TxIndex::DB::WriteTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos)
 {
     CDBBatch batch(*this);
-    for (const auto& tuple : v_pos) {
-        batch.Write(std::make_pair(DB_TXINDEX, tuple.first), tuple.second);
-    }
+    WriteTxs(v_pos, batch);
     return WriteBatch(batch);
 }
 
+void TxIndex::DB::WriteTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos, CDBBatch& batch)
+{
+    for (const auto& [txid, pos] : v_pos) {
+        // The filter has the entry before it can be read
+        m_filter->insert(TxidPrefix(txid));
+        batch.Write(DBTxKey{TxidPrefix(txid), pos}, uint8_t{0});
+    }
+    m_count += v_pos.size();
+}
+
+void TxIndex::DB::EraseTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos, CDBBatch& batch)
+{
+    // Prefixes stay in the filter, which only makes lookups of them read the database
+    for (const auto& [txid, pos] : v_pos) {
+        batch.Erase(DBTxKey{TxidPrefix(txid), pos});
+        if (m_legacy_entries) batch.Erase(std::make_pair(DB_TXINDEX, txid));
+    }
+    m_count -= std::min<uint64_t>(m_count, v_pos.size());
+}
+
+void TxIndex::DB::WriteCount(CDBBatch& batch) const
+{
+    batch.Write(DB_TXINDEX_COUNT, m_count.load());
+}
+
 TxIndex::TxIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
-    : BaseIndex(std::move(chain), "txindex"), m_db(std::make_unique<TxIndex::DB>(n_cache_size, f_memory, f_wipe))
+    : BaseIndex(std::move(chain), "txindex"), m_db(std::make_unique<TxIndex::DB>(n_cache_size, f_memory, f_wipe, SharedBlockCache()))
 {}
 
 TxIndex::~TxIndex() = default;
 
-bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
+/** Disk positions of the transactions of a block. */
+static std::vector<std::pair<uint256, CDiskTxPos>> GetTxPositions(const interfaces::BlockInfo& block)
 {
-    // Exclude genesis block transaction because outputs are not spendable.
-    if (block.height == 0) return true;
-
     assert(block.data);
     CDiskTxPos pos({block.file_number, block.data_pos}, GetSizeOfCompactSize(block.data->vtx.size()));
     std::vector<std::pair<uint256, CDiskTxPos>> vPos;
@@ -68,35 +231,122 @@ bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
         vPos.emplace_back(tx->GetHash(), pos);
         pos.nTxOffset += ::GetSerializeSize(TX_WITH_WITNESS(*tx));
     }
-    return m_db->WriteTxs(vPos);
+    return vPos;
 }
 
-BaseIndex::DB& TxIndex::GetDB() const { return *m_db; }
+bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    // Exclude genesis block transaction because outputs are not spendable.
+    if (block.height == 0) return true;
 
-bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRef& tx) const
+    return m_db->WriteTxs(GetTxPositions(block));
+}
+
+bool TxIndex::CustomPrepare(const interfaces::BlockInfo& block, CDBBatch& batch, std::any& payload) const
 {
-    CDiskTxPos postx;
-    if (!m_db->ReadTxPos(tx_hash, postx)) {
-        return false;
+    // Transaction positions only depend on the block, so they are written as
+    // they are prepared.
+    if (block.height > 0) m_db->WriteTxs(GetTxPositions(block), batch);
+    return true;
+}
+
+bool TxIndex::CustomCommit(CDBBatch& batch)
+{
+    m_db->WriteCount(batch);
+    return true;
+}
+
+bool TxIndex::CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip)
+{
+    // Entries of disconnected blocks would otherwise still be found, in the
+    // blocks left on disk
+    CDBBatch batch(*m_db);
+    {
+        LOCK(cs_main);
+        const CBlockIndex* iter_tip{m_chainstate->m_blockman.LookupBlockIndex(current_tip.hash)};
+        const CBlockIndex* new_tip_index{m_chainstate->m_blockman.LookupBlockIndex(new_tip.hash)};
+
+        do {
+            CBlock block;
+            if (!m_chainstate->m_blockman.ReadBlockFromDisk(block, *iter_tip)) {
+                return error("%s: Failed to read block %s from disk",
+                             __func__, iter_tip->GetBlockHash().ToString());
+            }
+            if (iter_tip->nHeight > 0) {
+                m_db->EraseTxs(GetTxPositions(kernel::MakeBlockInfo(iter_tip, &block)), batch);
+            }
+
+            iter_tip = iter_tip->GetAncestor(iter_tip->nHeight - 1);
+        } while (new_tip_index != iter_tip);
     }
+    return m_db->WriteBatch(batch);
+}
 
-    AutoFile file{m_chainstate->m_blockman.OpenBlockFile(postx, true)};
+BaseIndex::DB& TxIndex::GetDB() const { return *m_db; }
+
+/** Read the transaction at a position, and the header of its block. tx is left null if
+ * the block holds no transaction with the given hash there. */
+static bool ReadTxAt(const node::BlockManager& blockman, const CDiskTxPos& postx, const uint256& tx_hash, CBlockHeader& header, CTransactionRef& tx)
+{
+    // Open at the record header, which tells the format of the block data
+    FlatFilePos hpos{postx};
+    if (hpos.nPos < node::BLOCK_SERIALIZATION_HEADER_SIZE) {
+        return error("%s: invalid block position", __func__);
+    }
+    hpos.nPos -= node::BLOCK_SERIALIZATION_HEADER_SIZE;
+    AutoFile file{blockman.OpenBlockFile(hpos, true)};
     if (file.IsNull()) {
         return error("%s: OpenBlockFile failed", __func__);
     }
-    CBlockHeader header;
     try {
-        file >> header;
-        if (fseek(file.Get(), postx.nTxOffset, SEEK_CUR)) {
-            return error("%s: fseek(...) failed", __func__);
+        node::BlockFormat format;
+        unsigned int size;
+        if (!blockman.ReadBlockRecordHeader(file, postx, format, size)) {
+            return false;
+        }
+        if (format == node::BlockFormat::COMPACT_V1) {
+            // Transaction offsets are those of the network serialization, so
+            // the block is decoded to find the transaction
+            CBlock block;
+            file >> Using<node::CompactBlockFormatter>(block);
+            const auto it{std::find_if(block.vtx.begin(), block.vtx.end(), [&](const CTransactionRef& block_tx) {
+                return block_tx->GetHash() == tx_hash;
+            })};
+            if (it != block.vtx.end()) tx = *it;
+            header = block.GetBlockHeader();
+        } else {
+            file >> header;
+            if (fseek(file.Get(), postx.nTxOffset, SEEK_CUR)) {
+                return error("%s: fseek(...) failed", __func__);
+            }
+            file >> TX_WITH_WITNESS(tx);
         }
-        file >> TX_WITH_WITNESS(tx);
     } catch (const std::exception& e) {
         return error("%s: Deserialize or I/O error - %s", __func__, e.what());
     }
-    if (tx->GetHash() != tx_hash) {
-        return error("%s: txid mismatch", __func__);
-    }
-    block_hash = header.GetHash();
     return true;
 }
+
+bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRef& tx) const
+{
+    std::vector<CDiskTxPos> positions;
+    if (!m_db->ReadTxPos(tx_hash, positions)) {
+        return false;
+    }
+
+    // Positions of transactions sharing the prefix of the hash are skipped,
+    // as are those that cannot be read, the failure being logged
+    for (const CDiskTxPos& postx : positions) {
+        CBlockHeader header;
+        CTransactionRef found;
+        if (!ReadTxAt(m_chainstate->m_blockman, postx, tx_hash, header, found)) {
+            continue;
+        }
+        if (found && found->GetHash() == tx_hash) {
+            tx = std::move(found);
+            block_hash = header.GetHash();
+            return true;
+        }
+    }
+    return false;
+}
@@ -17,6 +17,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <string>
+#include <utility>
 #include <vector>
 
 class ArgsManager;
@@ -157,6 +158,13 @@ public:
     //! or std::nullopt if the block filter for this block couldn't be found.
     virtual std::optional<bool> blockFilterMatchesAny(BlockFilterType filter_type, const uint256& block_hash, const GCSFilter::ElementSet& filter_set) = 0;
 
+    //! Returns the hashes of up to max_count blocks of the active chain from
+    //! start_block on, each with whether any of the elements match it via a
+    //! BIP 157 block filter, or std::nullopt if its filter couldn't be found.
+    //! The set is matched against all the filters at once. Returns nothing if
+    //! start_block is not in the active chain.
+    virtual std::vector<std::pair<uint256, std::optional<bool>>> blockFiltersMatchAny(BlockFilterType filter_type, const uint256& start_block, int max_count, const GCSFilter::ElementSet& filter_set) = 0;
+
     //! Return whether node has the block and optionally return block metadata
     //! or contents.
     virtual bool findBlock(const uint256& hash, const FoundBlock& block={}) = 0;
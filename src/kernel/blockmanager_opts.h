@@ -9,7 +9,9 @@
 #include <kernel/notifications_interface.h>
 #include <util/fs.h>
 
+#include <cstddef>
 #include <cstdint>
+#include <optional>
 
 class CChainParams;
 
@@ -23,6 +25,11 @@ struct BlockManagerOpts {
     const CChainParams& chainparams;
     uint64_t prune_target{0};
     bool fast_prune{false};
+    //! Store new blocks in node::BlockFormat::COMPACT_V1 where possible
+    bool compact_block_files{false};
+    //! Memory for the blocks and undo data shared by the indexes catching up,
+    //! node::DEFAULT_SHARED_BLOCK_READER_SIZE if unset
+    std::optional<size_t> index_reader_size{};
     const fs::path blocks_dir;
     Notifications& notifications;
 };
@@ -0,0 +1,222 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <kernel/coinscache_persist.h>
+
+#include <coins.h>
+#include <logging.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <streams.h>
+#include <sync.h>
+#include <txdb.h>
+#include <txmempool.h>
+#include <uint256.h>
+#include <util/fs.h>
+#include <util/fs_helpers.h>
+#include <util/signalinterrupt.h>
+#include <util/threadpool.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using fsbridge::FopenFn;
+
+namespace kernel {
+
+static const uint64_t COINS_CACHE_DUMP_VERSION{1};
+
+//! Number of coins read by each thread in a batch, added to the cache under cs_main.
+static constexpr size_t COINS_CACHE_LOAD_CHUNK{4096};
+
+bool DumpCoinsCache(Chainstate& chainstate, const fs::path& dump_path, FopenFn mockable_fopen_function, bool skip_file_commit)
+{
+    AssertLockHeld(::cs_main);
+    if (!chainstate.CanFlushToDisk()) return false;
+
+    const auto start{SteadyClock::now()};
+    const uint256 best_block{chainstate.CoinsTip().GetBestBlock()};
+    std::vector<COutPoint> outpoints{chainstate.CoinsTip().GetCachedOutPoints()};
+    // The mempool is reloaded after the cache, and looks up the coins its
+    // transactions spend, which a flush may have dropped from the cache.
+    if (const CTxMemPool* pool{chainstate.GetMempool()}) {
+        LOCK(pool->cs);
+        for (const CTxMemPoolEntryRef& entry : pool->entryAll()) {
+            for (const CTxIn& txin : entry.get().GetTx().vin) {
+                if (!pool->exists(GenTxid::Txid(txin.prevout.hash))) outpoints.push_back(txin.prevout);
+            }
+        }
+        std::sort(outpoints.begin(), outpoints.end());
+        outpoints.erase(std::unique(outpoints.begin(), outpoints.end()), outpoints.end());
+    }
+    const auto mid{SteadyClock::now()};
+
+    AutoFile file{mockable_fopen_function(dump_path + ".new", "wb")};
+    if (file.IsNull()) {
+        return false;
+    }
+
+    try {
+        file << COINS_CACHE_DUMP_VERSION;
+        file << best_block;
+
+        // Outpoints are sorted, so the outputs of a transaction are stored
+        // after a single copy of its txid.
+        uint64_t num_txids{0};
+        for (size_t i = 0; i < outpoints.size(); ++i) {
+            if (i == 0 || outpoints[i].hash != outpoints[i - 1].hash) ++num_txids;
+        }
+        file << num_txids;
+        std::vector<uint32_t> indexes;
+        for (size_t i = 0; i < outpoints.size(); ++i) {
+            indexes.push_back(outpoints[i].n);
+            if (i + 1 == outpoints.size() || outpoints[i + 1].hash != outpoints[i].hash) {
+                file << outpoints[i].hash << indexes;
+                indexes.clear();
+            }
+        }
+
+        if (!skip_file_commit && !FileCommit(file.Get()))
+            throw std::runtime_error("FileCommit failed");
+        file.fclose();
+        if (!RenameOver(dump_path + ".new", dump_path)) {
+            throw std::runtime_error("Rename failed");
+        }
+        const auto last{SteadyClock::now()};
+
+        LogPrintf("Dumped %u cached coins: %.3fs to copy, %.3fs to dump\n",
+                  outpoints.size(),
+                  Ticks<SecondsDouble>(mid - start),
+                  Ticks<SecondsDouble>(last - mid));
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to dump coins cache: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    return true;
+}
+
+bool LoadCoinsCache(Chainstate& chainstate, const fs::path& load_path, int num_threads, FopenFn mockable_fopen_function)
+{
+    if (load_path.empty()) return false;
+
+    AutoFile file{mockable_fopen_function(load_path, "rb")};
+    if (file.IsNull()) {
+        LogPrintf("Failed to open coins cache file from disk. Continuing anyway.\n");
+        return false;
+    }
+
+    const auto start{SteadyClock::now()};
+    uint256 best_block;
+    std::vector<COutPoint> outpoints;
+    try {
+        uint64_t version;
+        file >> version;
+        if (version != COINS_CACHE_DUMP_VERSION) {
+            return false;
+        }
+        file >> best_block;
+        uint64_t num_txids;
+        file >> num_txids;
+        Txid txid;
+        std::vector<uint32_t> indexes;
+        for (uint64_t i = 0; i < num_txids; ++i) {
+            file >> txid >> indexes;
+            for (const uint32_t n : indexes) {
+                outpoints.emplace_back(txid, n);
+            }
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to deserialize coins cache data on disk: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+
+    CCoinsViewCache* coins_tip;
+    const CCoinsViewDB* coins_db;
+    uint256 db_best_block;
+    size_t max_usage;
+    {
+        LOCK(::cs_main);
+        if (!chainstate.CanFlushToDisk()) return false;
+        coins_tip = &chainstate.CoinsTip();
+        coins_db = &chainstate.CoinsDB();
+        db_best_block = coins_db->GetBestBlock();
+        if (best_block != coins_tip->GetBestBlock()) {
+            LogPrintf("Coins cache file was written at another block, some of its coins may be spent\n");
+        }
+        // Stay below the size at which the cache is considered large and flushed
+        max_usage = chainstate.m_coinstip_cache_size_bytes / 10 * 9;
+    }
+    LogInfo("Loading %u cached coins from disk...\n", outpoints.size());
+
+    ThreadPool pool{"coinsload"};
+    pool.Start(std::max(num_threads, 1));
+    const size_t batch_size{pool.WorkersCount() * COINS_CACHE_LOAD_CHUNK};
+    size_t loaded{0};
+    bool full{false};
+    bool stale{false};
+    try {
+        for (size_t batch_begin = 0; batch_begin < outpoints.size() && !full && !stale; batch_begin += batch_size) {
+            if (chainstate.m_chainman.m_interrupt) return false;
+
+            // Coins are read without cs_main, each thread reading a contiguous
+            // chunk of sorted outpoints, which are close to each other in the
+            // database.
+            const size_t batch_end{std::min(batch_begin + batch_size, outpoints.size())};
+            std::vector<std::future<std::vector<std::pair<COutPoint, Coin>>>> futures;
+            for (size_t begin = batch_begin; begin < batch_end; begin += COINS_CACHE_LOAD_CHUNK) {
+                const size_t end{std::min(begin + COINS_CACHE_LOAD_CHUNK, batch_end)};
+                futures.push_back(pool.Submit([&outpoints, coins_db, begin, end] {
+                    std::vector<std::pair<COutPoint, Coin>> coins;
+                    coins.reserve(end - begin);
+                    for (size_t i = begin; i < end; ++i) {
+                        Coin coin;
+                        if (coins_db->GetCoin(outpoints[i], coin)) {
+                            coins.emplace_back(outpoints[i], std::move(coin));
+                        }
+                    }
+                    return coins;
+                }));
+            }
+            std::vector<std::vector<std::pair<COutPoint, Coin>>> batch;
+            for (auto& future : futures) batch.push_back(future.get());
+
+            // A flush since loading started may have spent coins read from the
+            // database, so they are only added if it was not written since.
+            LOCK(::cs_main);
+            if (coins_db->GetBestBlock() != db_best_block) {
+                stale = true;
+                break;
+            }
+            for (auto& coins : batch) {
+                for (auto& [outpoint, coin] : coins) {
+                    if (coins_tip->DynamicMemoryUsage() + coin.DynamicMemoryUsage() > max_usage) {
+                        full = true;
+                        break;
+                    }
+                    coins_tip->WarmCoin(outpoint, std::move(coin));
+                    ++loaded;
+                }
+                if (full) break;
+            }
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to load cached coins: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+
+    LogPrintf("Loaded %u of %u cached coins from disk in %.3fs%s\n",
+              loaded, outpoints.size(),
+              Ticks<SecondsDouble>(SteadyClock::now() - start),
+              full ? " (stopped at cache size limit)" : stale ? " (stopped as the coins database was written)" : "");
+    return true;
+}
+
+} // namespace kernel
@@ -0,0 +1,38 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_KERNEL_COINSCACHE_PERSIST_H
+#define BETGENIUS_KERNEL_COINSCACHE_PERSIST_H
+
+#include <kernel/cs_main.h>
+#include <sync.h>
+#include <util/fs.h>
+
+class Chainstate;
+
+namespace kernel {
+
+/**
+ * Dump the outpoints of the unspent coins held in the chainstate's coins
+ * cache, and of the confirmed coins spent by its mempool, to a file. Must be
+ * called before the cache is flushed, which empties it.
+ */
+bool DumpCoinsCache(Chainstate& chainstate, const fs::path& dump_path,
+                    fsbridge::FopenFn mockable_fopen_function = fsbridge::fopen,
+                    bool skip_file_commit = false)
+    EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+/**
+ * Read the coins listed in the file from the coins database, using
+ * num_threads threads, and add them to the chainstate's coins cache. Coins
+ * are read in batches without cs_main, which is held only to add each batch.
+ * Loading stops before the cache grows large enough to trigger a flush.
+ */
+bool LoadCoinsCache(Chainstate& chainstate, const fs::path& load_path, int num_threads,
+                    fsbridge::FopenFn mockable_fopen_function = fsbridge::fopen)
+    LOCKS_EXCLUDED(::cs_main);
+
+} // namespace kernel
+
+#endif // BETGENIUS_KERNEL_COINSCACHE_PERSIST_H
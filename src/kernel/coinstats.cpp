@@ -7,6 +7,7 @@
 
 #include <chain.h>
 #include <coins.h>
+#include <common/system.h>
 #include <crypto/muhash.h>
 #include <hash.h>
 #include <logging.h>
@@ -21,15 +22,22 @@
 #include <uint256.h>
 #include <util/check.h>
 #include <util/overflow.h>
+#include <util/threadpool.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <exception>
+#include <future>
 #include <iosfwd>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace kernel {
 
@@ -61,6 +69,11 @@ static void ApplyCoinHash(HashWriter& ss, const COutPoint& outpoint, const Coin&
     TxOutSer(ss, outpoint, coin);
 }
 
+static void ApplyCoinHash(DataStream& ss, const COutPoint& outpoint, const Coin& coin)
+{
+    TxOutSer(ss, outpoint, coin);
+}
+
 void ApplyCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin)
 {
     DataStream ss{};
@@ -151,6 +164,163 @@ static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, c
     return true;
 }
 
+//! Number of txid ranges the UTXO set is split into for a parallel walk
+static constexpr int UTXO_STATS_SHARDS{256};
+//! Maximum number of threads used for a parallel walk of the UTXO set
+static constexpr int MAX_UTXO_STATS_THREADS{16};
+
+/**
+ * Per-range hashing state. Ranges of a MuHash can be combined in any order, but
+ * the serialized hash is a single stream, so each range keeps its serialized
+ * coins to be hashed in range order.
+ */
+template <typename T> struct ShardHash { using type = T; };
+template <> struct ShardHash<HashWriter> { using type = DataStream; };
+
+static void CombineHash(HashWriter& ss, const DataStream& shard) { ss.write(MakeByteSpan(shard)); }
+static void CombineHash(MuHash3072& muhash, const MuHash3072& shard) { muhash *= shard; }
+static void CombineHash(std::nullptr_t, std::nullptr_t) {}
+
+static void CombineStats(CCoinsStats& stats, const CCoinsStats& shard)
+{
+    stats.nTransactions += shard.nTransactions;
+    stats.nTransactionOutputs += shard.nTransactionOutputs;
+    stats.nBogoSize += shard.nBogoSize;
+    stats.coins_count += shard.coins_count;
+    if (stats.total_amount.has_value() && shard.total_amount.has_value()) {
+        stats.total_amount = CheckedAdd(*stats.total_amount, *shard.total_amount);
+    } else {
+        stats.total_amount = std::nullopt;
+    }
+}
+
+template <typename T>
+struct UTXOStatsShard {
+    std::unique_ptr<CCoinsViewCursor> cursor;
+    CCoinsStats stats;
+    typename ShardHash<T>::type hash_obj{};
+};
+
+//! Walk one txid range of the UTXO set. Ranges never split the outputs of a transaction.
+template <typename T>
+static bool ComputeShardStats(UTXOStatsShard<T>& shard, const std::atomic<bool>& interrupted, const std::function<void()>& interruption_point)
+{
+    CCoinsViewCursor* pcursor{shard.cursor.get()};
+    Txid prevkey;
+    std::map<uint32_t, Coin> outputs;
+    while (pcursor->Valid()) {
+        if (interruption_point) interruption_point();
+        if (interrupted) return false;
+        COutPoint key;
+        Coin coin;
+        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
+            if (!outputs.empty() && key.hash != prevkey) {
+                ApplyStats(shard.stats, prevkey, outputs);
+                ApplyHash(shard.hash_obj, prevkey, outputs);
+                outputs.clear();
+            }
+            prevkey = key.hash;
+            outputs[key.n] = std::move(coin);
+            shard.stats.coins_count++;
+        } else {
+            return error("%s: unable to read value", __func__);
+        }
+        pcursor->Next();
+    }
+    if (!outputs.empty()) {
+        ApplyStats(shard.stats, prevkey, outputs);
+        ApplyHash(shard.hash_obj, prevkey, outputs);
+    }
+    // Release the database iterator as early as possible
+    shard.cursor.reset();
+    return true;
+}
+
+//! Smallest txid in the range with the given index
+static uint256 ShardBegin(int index)
+{
+    const uint32_t prefix = 0x10000 * index / UTXO_STATS_SHARDS;
+    uint256 txid;
+    txid.begin()[0] = prefix >> 8;
+    txid.begin()[1] = prefix & 0xff;
+    return txid;
+}
+
+/**
+ * Calculate statistics about the unspent transaction output set, walking
+ * txid ranges of it on a pool of worker threads. Ranges are combined in
+ * key order, so the result is identical to that of a sequential walk.
+ *
+ * Returns std::nullopt if the view does not support range cursors.
+ */
+template <typename T>
+static std::optional<bool> ComputeUTXOStatsParallel(CCoinsView* view, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point)
+{
+    std::vector<UTXOStatsShard<T>> shards(UTXO_STATS_SHARDS);
+    {
+        // Writes to the coins database happen under cs_main, so creating all
+        // cursors under it gives them a consistent view.
+        LOCK(::cs_main);
+        for (int i = 0; i < UTXO_STATS_SHARDS; ++i) {
+            const std::optional<uint256> end{i + 1 < UTXO_STATS_SHARDS ? std::make_optional(ShardBegin(i + 1)) : std::nullopt};
+            shards[i].cursor = view->Cursor(ShardBegin(i), end);
+            if (!shards[i].cursor) return std::nullopt;
+        }
+    }
+
+    const int num_threads{std::clamp(GetNumCores(), 1, MAX_UTXO_STATS_THREADS)};
+    ThreadPool pool{"coinstats"};
+    pool.Start(num_threads);
+
+    // Keep a bounded number of ranges in flight, since ranges of the serialized
+    // hash are buffered until all preceding ranges have been hashed.
+    std::atomic<bool> interrupted{false};
+    const size_t window{2 * size_t(num_threads)};
+    std::vector<std::future<bool>> futures;
+    const auto submit{[&](size_t i) {
+        futures.push_back(pool.Submit([&, i] {
+            try {
+                const bool ok{ComputeShardStats(shards[i], interrupted, interruption_point)};
+                if (!ok) interrupted = true;
+                return ok;
+            } catch (...) {
+                interrupted = true;
+                throw;
+            }
+        }));
+    }};
+    for (size_t i = 0; i < std::min(window, shards.size()); ++i) submit(i);
+
+    bool success{true};
+    std::exception_ptr error;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        try {
+            success &= futures[i].get();
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+        if (success && !error) {
+            CombineStats(stats, shards[i].stats);
+            CombineHash(hash_obj, shards[i].hash_obj);
+            if (i + window < shards.size()) submit(i + window);
+        }
+        shards[i] = {};
+        if (!success || error) {
+            // Wait for the ranges still in flight before unwinding
+            for (size_t j = i + 1; j < futures.size(); ++j) futures[j].wait();
+            break;
+        }
+    }
+    if (error) std::rethrow_exception(error);
+    if (!success) return false;
+
+    FinalizeHash(hash_obj, stats);
+
+    stats.nDiskSize = view->EstimateSize();
+
+    return true;
+}
+
 std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView* view, node::BlockManager& blockman, const std::function<void()>& interruption_point)
 {
     CBlockIndex* pindex = WITH_LOCK(::cs_main, return blockman.LookupBlockIndex(view->GetBestBlock()));
@@ -160,13 +330,16 @@ std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsV
         switch (hash_type) {
         case(CoinStatsHashType::HASH_SERIALIZED): {
             HashWriter ss{};
+            if (auto res{ComputeUTXOStatsParallel(view, stats, ss, interruption_point)}) return *res;
             return ComputeUTXOStats(view, stats, ss, interruption_point);
         }
         case(CoinStatsHashType::MUHASH): {
             MuHash3072 muhash;
+            if (auto res{ComputeUTXOStatsParallel(view, stats, muhash, interruption_point)}) return *res;
             return ComputeUTXOStats(view, stats, muhash, interruption_point);
         }
         case(CoinStatsHashType::NONE): {
+            if (auto res{ComputeUTXOStatsParallel(view, stats, nullptr, interruption_point)}) return *res;
             return ComputeUTXOStats(view, stats, nullptr, interruption_point);
         }
         } // no default case, so the compiler can warn about missing cases
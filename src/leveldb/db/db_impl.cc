@@ -11,6 +11,7 @@
 #include <atomic>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "db/builder.h"
@@ -84,6 +85,16 @@ struct DBImpl::CompactionState {
   TableBuilder* builder;
 
   uint64_t total_bytes;
+
+  // User key range (start, end] handled by this subcompaction.  A side
+  // without a bound extends to the first or last input key respectively.
+  bool has_start = false;
+  std::string start;
+  bool has_end = false;
+  std::string end;
+
+  // Grandparent overlap and base level state for this key range
+  Compaction::Progress progress;
 };
 
 // Fix user-supplied options to be reasonable
@@ -103,6 +114,7 @@ Options SanitizeOptions(const std::string& dbname,
   ClipToRange(&result.write_buffer_size, 64 << 10, 1 << 30);
   ClipToRange(&result.max_file_size, 1 << 20, 1 << 30);
   ClipToRange(&result.block_size, 1 << 10, 4 << 20);
+  ClipToRange(&result.max_subcompactions, 1, 64);
   if (result.info_log == nullptr) {
     // Open a log file in the same directory as the db
     src.env->CreateDir(dbname);  // In case it does not exist
@@ -147,6 +159,7 @@ DBImpl::DBImpl(const Options& raw_options, const std::string& dbname)
       tmp_batch_(new WriteBatch),
       background_compaction_scheduled_(false),
       manual_compaction_(nullptr),
+      split_compactions_(0),
       versions_(new VersionSet(dbname_, &options_, table_cache_,
                                &internal_comparator_)) {}
 
@@ -887,7 +900,6 @@ Status DBImpl::InstallCompactionResults(CompactionState* compact) {
 
 Status DBImpl::DoCompactionWork(CompactionState* compact) {
   const uint64_t start_micros = env_->NowMicros();
-  int64_t imm_micros = 0;  // Micros spent doing imm_ compactions
 
   Log(options_.info_log, "Compacting %d@%d + %d@%d files",
       compact->compaction->num_input_files(0), compact->compaction->level(),
@@ -903,12 +915,116 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
     compact->smallest_snapshot = snapshots_.oldest()->sequence_number();
   }
 
-  Iterator* input = versions_->MakeInputIterator(compact->compaction);
+  // Split the key space into disjoint ranges that are compacted
+  // concurrently.  Every user key, with all of its entries, falls in a
+  // single range, so each range can drop obsolete entries on its own.
+  std::vector<std::string> boundaries;
+  compact->compaction->GetSplitPoints(options_.max_subcompactions - 1,
+                                      &boundaries);
+  std::vector<CompactionState*> subcompactions;
+  subcompactions.push_back(compact);
+  for (size_t i = 0; i < boundaries.size(); i++) {
+    CompactionState* sub = new CompactionState(compact->compaction);
+    sub->smallest_snapshot = compact->smallest_snapshot;
+    sub->has_start = true;
+    sub->start = boundaries[i];
+    subcompactions.back()->has_end = true;
+    subcompactions.back()->end = boundaries[i];
+    subcompactions.push_back(sub);
+  }
+  std::vector<Iterator*> inputs;
+  for (size_t i = 0; i < subcompactions.size(); i++) {
+    inputs.push_back(versions_->MakeInputIterator(compact->compaction));
+  }
+  if (subcompactions.size() > 1) {
+    Log(options_.info_log, "Compacting in %d subcompactions",
+        static_cast<int>(subcompactions.size()));
+  }
 
   // Release mutex while we're actually doing the compaction work
   mutex_.Unlock();
 
-  input->SeekToFirst();
+  std::atomic<bool> imm_busy(false);
+  std::atomic<int64_t> imm_micros(0);  // Micros spent doing imm_ compactions
+  std::vector<Status> statuses(subcompactions.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < subcompactions.size(); i++) {
+    threads.emplace_back([this, i, &subcompactions, &inputs, &statuses,
+                          &imm_busy, &imm_micros]() {
+      statuses[i] = DoSubcompactionWork(subcompactions[i], inputs[i],
+                                        &imm_busy, &imm_micros);
+    });
+  }
+  statuses[0] = DoSubcompactionWork(compact, inputs[0], &imm_busy, &imm_micros);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  // The ranges are ordered, so appending their outputs keeps the outputs of
+  // the whole compaction sorted.
+  Status status;
+  for (size_t i = 0; i < subcompactions.size(); i++) {
+    if (status.ok()) {
+      status = statuses[i];
+    }
+    if (i == 0) {
+      continue;
+    }
+    CompactionState* sub = subcompactions[i];
+    compact->outputs.insert(compact->outputs.end(), sub->outputs.begin(),
+                            sub->outputs.end());
+    compact->total_bytes += sub->total_bytes;
+    if (sub->builder != nullptr) {
+      sub->builder->Abandon();
+      delete sub->builder;
+    }
+    delete sub->outfile;
+    delete sub;
+  }
+
+  CompactionStats stats;
+  stats.micros = env_->NowMicros() - start_micros - imm_micros.load();
+  for (int which = 0; which < 2; which++) {
+    for (int i = 0; i < compact->compaction->num_input_files(which); i++) {
+      stats.bytes_read += compact->compaction->input(which, i)->file_size;
+    }
+  }
+  for (size_t i = 0; i < compact->outputs.size(); i++) {
+    stats.bytes_written += compact->outputs[i].file_size;
+  }
+
+  mutex_.Lock();
+  stats_[compact->compaction->level() + 1].Add(stats);
+  if (subcompactions.size() > 1) {
+    split_compactions_++;
+  }
+
+  if (status.ok()) {
+    status = InstallCompactionResults(compact);
+  }
+  if (!status.ok()) {
+    RecordBackgroundError(status);
+  }
+  VersionSet::LevelSummaryStorage tmp;
+  Log(options_.info_log, "compacted to: %s", versions_->LevelSummary(&tmp));
+  return status;
+}
+
+Status DBImpl::DoSubcompactionWork(CompactionState* compact, Iterator* input,
+                                   std::atomic<bool>* imm_busy,
+                                   std::atomic<int64_t>* imm_micros) {
+  if (compact->has_start) {
+    // Position at the first entry past the start of the range
+    input->Seek(InternalKey(compact->start, 0, static_cast<ValueType>(0))
+                    .Encode());
+    while (input->Valid() && input->key().size() >= 8 &&
+           user_comparator()->Compare(ExtractUserKey(input->key()),
+                                      compact->start) <= 0) {
+      input->Next();
+    }
+  } else {
+    input->SeekToFirst();
+  }
   Status status;
   ParsedInternalKey ikey;
   std::string current_user_key;
@@ -916,7 +1032,8 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
   SequenceNumber last_sequence_for_key = kMaxSequenceNumber;
   while (input->Valid() && !shutting_down_.load(std::memory_order_acquire)) {
     // Prioritize immutable compaction work
-    if (has_imm_.load(std::memory_order_relaxed)) {
+    if (has_imm_.load(std::memory_order_relaxed) &&
+        !imm_busy->exchange(true, std::memory_order_acquire)) {
       const uint64_t imm_start = env_->NowMicros();
       mutex_.Lock();
       if (imm_ != nullptr) {
@@ -925,11 +1042,19 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
         background_work_finished_signal_.SignalAll();
       }
       mutex_.Unlock();
-      imm_micros += (env_->NowMicros() - imm_start);
+      imm_busy->store(false, std::memory_order_release);
+      *imm_micros += (env_->NowMicros() - imm_start);
     }
 
     Slice key = input->key();
-    if (compact->compaction->ShouldStopBefore(key) &&
+    const bool parsed = ParseInternalKey(key, &ikey);
+    if (parsed && compact->has_end &&
+        user_comparator()->Compare(ikey.user_key, compact->end) > 0) {
+      // Past the end of this subcompaction's range
+      break;
+    }
+
+    if (compact->compaction->ShouldStopBefore(key, &compact->progress) &&
         compact->builder != nullptr) {
       status = FinishCompactionOutputFile(compact, input);
       if (!status.ok()) {
@@ -939,7 +1064,7 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
 
     // Handle key/value, add to state, etc.
     bool drop = false;
-    if (!ParseInternalKey(key, &ikey)) {
+    if (!parsed) {
       // Do not hide error keys
       current_user_key.clear();
       has_current_user_key = false;
@@ -959,7 +1084,8 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
         drop = true;  // (A)
       } else if (ikey.type == kTypeDeletion &&
                  ikey.sequence <= compact->smallest_snapshot &&
-                 compact->compaction->IsBaseLevelForKey(ikey.user_key)) {
+                 compact->compaction->IsBaseLevelForKey(ikey.user_key,
+                                                        &compact->progress)) {
         // For this user key:
         // (1) there is no data in higher levels
         // (2) data in lower levels will have larger sequence numbers
@@ -1019,30 +1145,6 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
     status = input->status();
   }
   delete input;
-  input = nullptr;
-
-  CompactionStats stats;
-  stats.micros = env_->NowMicros() - start_micros - imm_micros;
-  for (int which = 0; which < 2; which++) {
-    for (int i = 0; i < compact->compaction->num_input_files(which); i++) {
-      stats.bytes_read += compact->compaction->input(which, i)->file_size;
-    }
-  }
-  for (size_t i = 0; i < compact->outputs.size(); i++) {
-    stats.bytes_written += compact->outputs[i].file_size;
-  }
-
-  mutex_.Lock();
-  stats_[compact->compaction->level() + 1].Add(stats);
-
-  if (status.ok()) {
-    status = InstallCompactionResults(compact);
-  }
-  if (!status.ok()) {
-    RecordBackgroundError(status);
-  }
-  VersionSet::LevelSummaryStorage tmp;
-  Log(options_.info_log, "compacted to: %s", versions_->LevelSummary(&tmp));
   return status;
 }
 
@@ -1421,6 +1523,12 @@ bool DBImpl::GetProperty(const Slice& property, std::string* value) {
       }
     }
     return true;
+  } else if (in == "num-split-compactions") {
+    char buf[50];
+    snprintf(buf, sizeof(buf), "%llu",
+             static_cast<unsigned long long>(split_compactions_));
+    value->append(buf);
+    return true;
   } else if (in == "sstables") {
     *value = versions_->current()->DebugString();
     return true;
@@ -145,6 +145,14 @@ class DBImpl : public DB {
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   Status DoCompactionWork(CompactionState* compact)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Merge the entries of "input" within the key range of "compact" into
+  // new output files.  Several of these may run concurrently on disjoint
+  // ranges of one compaction; "imm_busy" makes sure only one of them at a
+  // time compacts the immutable memtable.  Takes ownership of "input".
+  Status DoSubcompactionWork(CompactionState* compact, Iterator* input,
+                             std::atomic<bool>* imm_busy,
+                             std::atomic<int64_t>* imm_micros)
+      LOCKS_EXCLUDED(mutex_);
 
   Status OpenCompactionOutputFile(CompactionState* compact);
   Status FinishCompactionOutputFile(CompactionState* compact, Iterator* input);
@@ -203,6 +211,9 @@ class DBImpl : public DB {
   Status bg_error_ GUARDED_BY(mutex_);
 
   CompactionStats stats_[config::kNumLevels] GUARDED_BY(mutex_);
+
+  // Number of compactions that were split into more than one subcompaction.
+  uint64_t split_compactions_ GUARDED_BY(mutex_);
 };
 
 // Sanitize db options.  The caller should delete result.info_log if
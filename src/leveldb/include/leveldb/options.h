@@ -130,6 +130,16 @@ struct LEVELDB_EXPORT Options {
   // efficiently detect that and will switch to uncompressed mode.
   CompressionType compression = kSnappyCompression;
 
+  // Maximum number of threads that cooperate on a single compaction.  If
+  // greater than one, a compaction whose inputs span several files is split
+  // into disjoint user key ranges ("subcompactions") that are merged and
+  // written concurrently, and whose outputs are installed together.
+  // Raising this shortens the time level-0 files stay around after a burst
+  // of writes, at the expense of using more cores during compactions.
+  //
+  // Default: 1, which compacts on the background thread only.
+  int max_subcompactions = 1;
+
   // EXPERIMENTAL: If true, append to existing MANIFEST and log files
   // when a database is opened.  This can significantly speed up open.
   //
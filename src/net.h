@@ -129,13 +129,25 @@ struct CSerializedNetMsg {
     {
         CSerializedNetMsg copy;
         copy.data = data;
+        copy.m_shared_data = m_shared_data;
         copy.m_type = m_type;
         return copy;
     }
 
     std::vector<unsigned char> data;
+    /**
+     * Payload shared with a cache, sent instead of data if set, so that a
+     * payload sent to many peers is not copied for each of them.
+     */
+    std::shared_ptr<const std::vector<unsigned char>> m_shared_data;
     std::string m_type;
 
+    /** The payload to send: m_shared_data if set, data otherwise. */
+    Span<const unsigned char> Payload() const noexcept
+    {
+        return m_shared_data ? Span<const unsigned char>{*m_shared_data} : Span<const unsigned char>{data};
+    }
+
     /** Compute total memory usage of this object (own memory + any dynamic memory). */
     size_t GetMemoryUsage() const noexcept;
 };
@@ -24,6 +24,7 @@
 #include <netbase.h>
 #include <netmessagemaker.h>
 #include <node/blockstorage.h>
+#include <node/recentblocks.h>
 #include <node/txreconciliation.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
@@ -1347,6 +1348,21 @@ static bool PeerHasHeader(CNodeState *state, const CBlockIndex *pindex) EXCLUSIV
     return false;
 }
 
+/** Read the headers of consecutive blocks, with a single read from the header store when it holds them. */
+static bool ReadHeaders(const node::BlockManager& blockman, Span<const CBlockIndex* const> blocks, std::vector<CBlock>& headers)
+{
+    std::vector<uint8_t> raw;
+    if (!blockman.ReadBlockHeaders(blocks, raw)) return false;
+    headers.reserve(headers.size() + blocks.size());
+    SpanReader stream{raw};
+    while (!stream.empty()) {
+        CBlockHeader header;
+        stream >> header;
+        headers.emplace_back(header);
+    }
+    return true;
+}
+
 void PeerManagerImpl::ProcessBlockAvailability(NodeId nodeid) {
     CNodeState *state = State(nodeid);
     assert(state != nullptr);
@@ -2331,16 +2347,31 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
         return;
     }
     std::shared_ptr<const CBlock> pblock;
-    if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
+    std::shared_ptr<const node::RecentBlocks::SerializedBlock> serialized_block;
+    if (inv.IsMsgBlk() || inv.IsMsgWitnessBlk()) {
+        serialized_block = m_chainman.m_blockman.m_recent_blocks.GetSerializedBlock(pindex->GetBlockHash(), /*with_witness=*/inv.IsMsgWitnessBlk());
+    }
+    if (serialized_block) {
+        // Blocks near the tip are sent from their cached serialization, which
+        // the message shares instead of copying
+        CSerializedNetMsg msg;
+        msg.m_type = NetMsgType::BLOCK;
+        msg.m_shared_data = std::move(serialized_block);
+        PushMessage(pfrom, std::move(msg));
+    } else if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
         pblock = a_recent_block;
+    } else if (auto recent_block{m_chainman.m_blockman.m_recent_blocks.GetBlock(pindex->GetBlockHash())}) {
+        pblock = std::move(recent_block);
     } else if (inv.IsMsgWitnessBlk()) {
         // Fast-path: in this case it is possible to serve the block directly from disk,
-        // as the network format matches the format on disk
-        std::vector<uint8_t> block_data;
-        if (!m_chainman.m_blockman.ReadRawBlockFromDisk(block_data, pindex->GetBlockPos())) {
+        // as the network format matches the format on disk. The block is read straight
+        // into the message, which the transport sends without copying it again.
+        CSerializedNetMsg msg;
+        msg.m_type = NetMsgType::BLOCK;
+        if (!m_chainman.m_blockman.ReadRawBlockFromDisk(msg.data, pindex->GetBlockPos())) {
             assert(!"cannot load block from disk");
         }
-        MakeAndPushMessage(pfrom, NetMsgType::BLOCK, Span{block_data});
+        PushMessage(pfrom, std::move(msg));
         // Don't set pblock as we've sent the block
     } else {
         // Send block from disk
@@ -4134,7 +4165,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             return;
         }
 
-        LOCK(cs_main);
+        WAIT_LOCK(cs_main, lock);
 
         // Note that if we were to be on a chain that forks from the checkpointed
         // chain, then serving those headers to a peer that has seen the
@@ -4177,14 +4208,25 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
 
         // we must use CBlocks, as CBlockHeaders won't include the 0x00 nTx count at the end
         std::vector<CBlock> vHeaders;
+        std::vector<const CBlockIndex*> blocks;
         int nLimit = MAX_HEADERS_RESULTS;
         LogPrint(BCLog::NET, "getheaders %d to %s from peer=%d\n", (pindex ? pindex->nHeight : -1), hashStop.IsNull() ? "end" : hashStop.ToString(), pfrom.GetId());
         for (; pindex; pindex = m_chainman.ActiveChain().Next(pindex))
         {
-            vHeaders.emplace_back(pindex->GetBlockHeader());
+            blocks.push_back(pindex);
             if (--nLimit <= 0 || pindex->GetBlockHash() == hashStop)
                 break;
         }
+        const CBlockIndex* const best_header_sent{pindex ? pindex : m_chainman.ActiveChain().Tip()};
+        {
+            // Headers the header store does not hold are rebuilt from the block
+            // tree database, which does not need cs_main.
+            REVERSE_LOCK(lock);
+            if (!ReadHeaders(m_chainman.m_blockman, blocks, vHeaders)) {
+                LogPrintf("Failed to read %u headers from %s for getheaders from peer=%d\n", blocks.size(), blocks.front()->GetBlockHash().ToString(), pfrom.GetId());
+                return;
+            }
+        }
         // pindex can be nullptr either if we sent m_chainman.ActiveChain().Tip() OR
         // if our peer has m_chainman.ActiveChain().Tip() (and thus we are sending an empty
         // headers message). In both cases it's safe to update
@@ -4197,7 +4239,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         // without the new block. By resetting the BestHeaderSent, we ensure we
         // will re-announce the new block via headers (or compact blocks again)
         // in the SendMessages logic.
-        nodestate->pindexBestHeaderSent = pindex ? pindex : m_chainman.ActiveChain().Tip();
+        nodestate->pindexBestHeaderSent = best_header_sent;
         MakeAndPushMessage(pfrom, NetMsgType::HEADERS, TX_WITH_WITNESS(vHeaders));
         return;
     }
@@ -5643,6 +5685,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
             // add all to the inv queue.
             LOCK(peer->m_block_inv_mutex);
             std::vector<CBlock> vHeaders;
+            std::vector<const CBlockIndex*> header_blocks;
             bool fRevertToInv = ((!peer->m_prefers_headers &&
                                  (!state.m_requested_hb_cmpctblocks || peer->m_blocks_for_headers_relay.size() > 1)) ||
                                  peer->m_blocks_for_headers_relay.size() > MAX_BLOCKS_TO_ANNOUNCE);
@@ -5680,14 +5723,14 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     pBestIndex = pindex;
                     if (fFoundStartingHeader) {
                         // add this to the headers message
-                        vHeaders.emplace_back(pindex->GetBlockHeader());
+                        header_blocks.push_back(pindex);
                     } else if (PeerHasHeader(&state, pindex)) {
                         continue; // keep looking for the first new block
                     } else if (pindex->pprev == nullptr || PeerHasHeader(&state, pindex->pprev)) {
                         // Peer doesn't have this header but they do have the prior one.
                         // Start sending headers.
                         fFoundStartingHeader = true;
-                        vHeaders.emplace_back(pindex->GetBlockHeader());
+                        header_blocks.push_back(pindex);
                     } else {
                         // Peer doesn't have this header or the prior one -- nothing will
                         // connect, so bail out.
@@ -5695,6 +5738,10 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                         break;
                     }
                 }
+                if (!fRevertToInv && !ReadHeaders(m_chainman.m_blockman, header_blocks, vHeaders)) {
+                    LogPrintf("Failed to read %u headers to announce to peer=%d, reverting to inv\n", header_blocks.size(), pto->GetId());
+                    fRevertToInv = true;
+                }
             }
             if (!fRevertToInv && !vHeaders.empty()) {
                 if (vHeaders.size() == 1 && state.m_requested_hb_cmpctblocks) {
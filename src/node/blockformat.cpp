@@ -0,0 +1,23 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockformat.h>
+
+#include <consensus/amount.h>
+#include <script/script.h>
+
+namespace node {
+bool CanStoreCompact(const CBlock& block)
+{
+    for (const CTransactionRef& tx : block.vtx) {
+        for (const CTxOut& txout : tx->vout) {
+            // Amounts must survive compression, and ScriptCompression
+            // replaces scripts above MAX_SCRIPT_SIZE with OP_RETURN.
+            if (txout.nValue < 0 || DecompressAmount(CompressAmount(txout.nValue)) != uint64_t(txout.nValue)) return false;
+            if (txout.scriptPubKey.size() > MAX_SCRIPT_SIZE) return false;
+        }
+    }
+    return true;
+}
+} // namespace node
@@ -0,0 +1,172 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_NODE_BLOCKFORMAT_H
+#define BETGENIUS_NODE_BLOCKFORMAT_H
+
+#include <compressor.h>
+#include <consensus/consensus.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <uint256.h>
+#include <util/hasher.h>
+
+#include <cstdint>
+#include <ios>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace node {
+/**
+ * Format of the block data in a block file record. Each record is the
+ * message start, a 32-bit size field and the block data. The format is kept
+ * in the top byte of the size field, which is zero for blocks in network
+ * serialization, so older block files read as network serialization.
+ */
+enum class BlockFormat : uint8_t {
+    NETWORK = 0,
+    //! See CompactBlockFormatter
+    COMPACT_V1 = 1,
+};
+
+//! Bits of the size field of a block record that hold the size of the block data
+static constexpr uint32_t BLOCK_RECORD_SIZE_MASK{0x00ffffff};
+static_assert(MAX_BLOCK_SERIALIZED_SIZE <= BLOCK_RECORD_SIZE_MASK);
+
+inline uint32_t MakeBlockRecordSize(BlockFormat format, uint32_t size)
+{
+    return (uint32_t{static_cast<uint8_t>(format)} << 24) | size;
+}
+
+//! Split the size field of a block record into the block format and the size of the block data
+inline std::pair<BlockFormat, uint32_t> ParseBlockRecordSize(uint32_t size_field)
+{
+    return {static_cast<BlockFormat>(size_field >> 24), size_field & BLOCK_RECORD_SIZE_MASK};
+}
+
+inline bool IsKnownBlockFormat(BlockFormat format)
+{
+    return format == BlockFormat::NETWORK || format == BlockFormat::COMPACT_V1;
+}
+
+/** Whether a block can be stored with CompactBlockFormatter without losing data. */
+bool CanStoreCompact(const CBlock& block);
+
+/**
+ * Compact storage format for blocks (BlockFormat::COMPACT_V1).
+ *
+ * The header is stored as in network serialization. Transaction outputs are
+ * stored like coins in the UTXO set, with compressed amounts and scripts.
+ * Prevouts that spend a transaction earlier in the same block refer to it by
+ * position instead of by txid. Version, prevout index, sequence and lock time
+ * are stored as VARINTs, with the sequence inverted so that final sequence
+ * numbers take a single byte.
+ *
+ * Serialization requires CanStoreCompact(block).
+ */
+struct CompactBlockFormatter {
+    template <typename Stream>
+    static void SerTx(Stream& s, const CTransaction& tx, const std::unordered_map<uint256, uint32_t, SaltedTxidHasher>& earlier_txs)
+    {
+        s << VARINT(static_cast<uint32_t>(tx.nVersion));
+        const bool has_witness{tx.HasWitness()};
+        s << uint8_t{has_witness};
+        WriteCompactSize(s, tx.vin.size());
+        for (const CTxIn& txin : tx.vin) {
+            // 0 for a txid that follows, otherwise one more than the position of an earlier transaction
+            const auto it{earlier_txs.find(txin.prevout.hash.ToUint256())};
+            if (it == earlier_txs.end()) {
+                s << VARINT(uint32_t{0}) << txin.prevout.hash;
+            } else {
+                s << VARINT(it->second + 1);
+            }
+            // Wraps the index of a null prevout to 0
+            s << VARINT(uint32_t(txin.prevout.n + 1));
+            s << txin.scriptSig;
+            s << VARINT(uint32_t(~txin.nSequence));
+        }
+        WriteCompactSize(s, tx.vout.size());
+        for (const CTxOut& txout : tx.vout) {
+            s << Using<TxOutCompression>(txout);
+        }
+        if (has_witness) {
+            for (const CTxIn& txin : tx.vin) {
+                s << txin.scriptWitness.stack;
+            }
+        }
+        s << VARINT(tx.nLockTime);
+    }
+
+    template <typename Stream>
+    static void UnserTx(Stream& s, CMutableTransaction& tx, const std::vector<CTransactionRef>& earlier_txs)
+    {
+        uint32_t version;
+        s >> VARINT(version);
+        tx.nVersion = static_cast<int32_t>(version);
+        uint8_t flags;
+        s >> flags;
+        if (flags > 1) throw std::ios_base::failure("Unknown transaction flags");
+        const uint64_t num_inputs{ReadCompactSize(s)};
+        for (uint64_t i = 0; i < num_inputs; ++i) {
+            CTxIn& txin{tx.vin.emplace_back()};
+            uint32_t tx_ref;
+            s >> VARINT(tx_ref);
+            if (tx_ref == 0) {
+                s >> txin.prevout.hash;
+            } else if (tx_ref <= earlier_txs.size()) {
+                txin.prevout.hash = earlier_txs[tx_ref - 1]->GetHash();
+            } else {
+                throw std::ios_base::failure("Invalid transaction reference");
+            }
+            uint32_t index;
+            s >> VARINT(index);
+            txin.prevout.n = index - 1;
+            s >> txin.scriptSig;
+            uint32_t sequence;
+            s >> VARINT(sequence);
+            txin.nSequence = ~sequence;
+        }
+        const uint64_t num_outputs{ReadCompactSize(s)};
+        for (uint64_t i = 0; i < num_outputs; ++i) {
+            s >> Using<TxOutCompression>(tx.vout.emplace_back());
+        }
+        if (flags & 1) {
+            for (CTxIn& txin : tx.vin) {
+                s >> txin.scriptWitness.stack;
+            }
+        }
+        s >> VARINT(tx.nLockTime);
+    }
+
+    template <typename Stream>
+    static void Ser(Stream& s, const CBlock& block)
+    {
+        s << static_cast<const CBlockHeader&>(block);
+        WriteCompactSize(s, block.vtx.size());
+        std::unordered_map<uint256, uint32_t, SaltedTxidHasher> earlier_txs;
+        earlier_txs.reserve(block.vtx.size());
+        for (uint32_t i = 0; i < block.vtx.size(); ++i) {
+            SerTx(s, *block.vtx[i], earlier_txs);
+            earlier_txs.try_emplace(block.vtx[i]->GetHash().ToUint256(), i);
+        }
+    }
+
+    template <typename Stream>
+    static void Unser(Stream& s, CBlock& block)
+    {
+        block.SetNull();
+        s >> static_cast<CBlockHeader&>(block);
+        const uint64_t num_txs{ReadCompactSize(s)};
+        for (uint64_t i = 0; i < num_txs; ++i) {
+            CMutableTransaction tx;
+            UnserTx(s, tx, block.vtx);
+            block.vtx.push_back(MakeTransactionRef(std::move(tx)));
+        }
+    }
+};
+} // namespace node
+
+#endif // BETGENIUS_NODE_BLOCKFORMAT_H
@@ -0,0 +1,57 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockmap.h>
+
+#include <memusage.h>
+#include <util/hasher.h>
+
+#include <algorithm>
+
+namespace node {
+BlockMap::~BlockMap()
+{
+    for (size_t pos = 0; pos < m_size; ++pos) {
+        Entry(pos).~value_type();
+    }
+}
+
+size_t BlockMap::FindSlot(const uint256& hash) const
+{
+    const size_t mask{m_slots.size() - 1};
+    for (size_t slot = BlockHasher{}(hash) & mask;; slot = (slot + 1) & mask) {
+        if (m_slots[slot] == EMPTY_SLOT || Entry(m_slots[slot] - 1).first == hash) return slot;
+    }
+}
+
+size_t BlockMap::FindPos(const uint256& hash) const
+{
+    if (m_slots.empty()) return m_size;
+    const size_t slot{FindSlot(hash)};
+    return m_slots[slot] == EMPTY_SLOT ? m_size : m_slots[slot] - 1;
+}
+
+void BlockMap::Rehash(size_t num_slots)
+{
+    m_slots.assign(num_slots, EMPTY_SLOT);
+    for (size_t pos = 0; pos < m_size; ++pos) {
+        m_slots[FindSlot(Entry(pos).first)] = pos + 1;
+    }
+}
+
+void BlockMap::reserve(size_t num_entries)
+{
+    m_chunks.reserve((num_entries + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    size_t num_slots{std::max(m_slots.size(), MIN_SLOTS)};
+    while (num_slots < 2 * num_entries) num_slots *= 2;
+    if (num_slots != m_slots.size()) Rehash(num_slots);
+}
+
+size_t BlockMap::DynamicMemoryUsage() const
+{
+    return memusage::DynamicUsage(m_chunks) +
+           m_chunks.size() * memusage::MallocUsage(sizeof(Chunk)) +
+           memusage::DynamicUsage(m_slots);
+}
+} // namespace node
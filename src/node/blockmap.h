@@ -0,0 +1,176 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_NODE_BLOCKMAP_H
+#define BETGENIUS_NODE_BLOCKMAP_H
+
+#include <chain.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace node {
+/**
+ * Map from block hash to the CBlockIndex of that block.
+ *
+ * Validation code takes pointers to the map's CBlockIndex objects, so they
+ * must never move. Instead of a heap allocation per entry, entries are
+ * constructed in place in large chunks that are never reallocated, in
+ * insertion order. Lookups go through an open-addressing table of 32-bit
+ * entry positions with linear probing, kept at most half full.
+ *
+ * Entries are never erased, as block index entries live as long as the
+ * BlockManager.
+ */
+class BlockMap
+{
+public:
+    using key_type = uint256;
+    using mapped_type = CBlockIndex;
+    using value_type = std::pair<const uint256, CBlockIndex>;
+
+private:
+    //! Number of entries stored in each chunk
+    static constexpr size_t CHUNK_SIZE{1024};
+    //! Smallest size of the slot table, a power of two
+    static constexpr size_t MIN_SLOTS{1024};
+    //! Value of an unused slot. Used slots hold the position of an entry plus one.
+    static constexpr uint32_t EMPTY_SLOT{0};
+
+    //! Uninitialized storage for CHUNK_SIZE entries
+    struct Chunk {
+        alignas(value_type) std::byte data[CHUNK_SIZE * sizeof(value_type)];
+    };
+
+    std::vector<std::unique_ptr<Chunk>> m_chunks;
+    std::vector<uint32_t> m_slots;
+    size_t m_size{0};
+
+    value_type& Entry(size_t pos)
+    {
+        return std::launder(reinterpret_cast<value_type*>(m_chunks[pos / CHUNK_SIZE]->data))[pos % CHUNK_SIZE];
+    }
+    const value_type& Entry(size_t pos) const
+    {
+        return std::launder(reinterpret_cast<const value_type*>(m_chunks[pos / CHUNK_SIZE]->data))[pos % CHUNK_SIZE];
+    }
+
+    //! Return the slot of the entry with the given hash, or the unused slot it would take
+    size_t FindSlot(const uint256& hash) const;
+    //! Rebuild the slot table with the given number of slots, a power of two
+    void Rehash(size_t num_slots);
+    //! Position of the entry with the given hash, or m_size if there is none
+    size_t FindPos(const uint256& hash) const;
+
+    template <bool IsConst>
+    class Iterator
+    {
+        using Map = std::conditional_t<IsConst, const BlockMap, BlockMap>;
+
+        Map* m_map{nullptr};
+        size_t m_pos{0};
+
+        friend class BlockMap;
+        friend class Iterator<true>;
+
+        Iterator(Map* map, size_t pos) : m_map{map}, m_pos{pos} {}
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = BlockMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+        using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+
+        Iterator() = default;
+
+        //! Convert an iterator to a const_iterator
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        Iterator(const Iterator<OtherConst>& other) : m_map{other.m_map}, m_pos{other.m_pos} {}
+
+        reference operator*() const { return m_map->Entry(m_pos); }
+        pointer operator->() const { return &m_map->Entry(m_pos); }
+
+        Iterator& operator++()
+        {
+            ++m_pos;
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator copy{*this};
+            ++m_pos;
+            return copy;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) { return a.m_pos == b.m_pos; }
+        friend bool operator!=(const Iterator& a, const Iterator& b) { return a.m_pos != b.m_pos; }
+    };
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    BlockMap() = default;
+    ~BlockMap();
+
+    BlockMap(const BlockMap&) = delete;
+    BlockMap& operator=(const BlockMap&) = delete;
+
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, m_size}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, m_size}; }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator find(const uint256& hash) { return {this, FindPos(hash)}; }
+    const_iterator find(const uint256& hash) const { return {this, FindPos(hash)}; }
+    size_t count(const uint256& hash) const { return FindPos(hash) != m_size ? 1 : 0; }
+
+    /** Make room for the given number of entries without rehashing. */
+    void reserve(size_t num_entries);
+
+    /**
+     * Insert an entry for hash with a CBlockIndex constructed from args, unless
+     * there already is one. Returns an iterator to the entry for hash and
+     * whether it was inserted.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const uint256& hash, Args&&... args)
+    {
+        if (m_slots.empty()) Rehash(MIN_SLOTS);
+        size_t slot{FindSlot(hash)};
+        if (m_slots[slot] != EMPTY_SLOT) return {iterator{this, m_slots[slot] - size_t{1}}, false};
+
+        if (2 * (m_size + 1) > m_slots.size()) {
+            Rehash(2 * m_slots.size());
+            slot = FindSlot(hash);
+        }
+        if (m_size == m_chunks.size() * CHUNK_SIZE) {
+            m_chunks.push_back(std::unique_ptr<Chunk>{new Chunk});
+        }
+        ::new (&m_chunks.back()->data[(m_size % CHUNK_SIZE) * sizeof(value_type)])
+            value_type(std::piecewise_construct, std::forward_as_tuple(hash), std::forward_as_tuple(std::forward<Args>(args)...));
+        m_slots[slot] = ++m_size;
+        return {iterator{this, m_size - 1}, true};
+    }
+
+    CBlockIndex& operator[](const uint256& hash) { return try_emplace(hash).first->second; }
+
+    /** Memory allocated by the map, including the entries themselves. */
+    size_t DynamicMemoryUsage() const;
+};
+} // namespace node
+
+#endif // BETGENIUS_NODE_BLOCKMAP_H
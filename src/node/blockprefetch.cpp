@@ -0,0 +1,149 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockprefetch.h>
+
+#include <chain.h>
+#include <coins.h>
+#include <core_memusage.h>
+#include <flatfile.h>
+#include <memusage.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <uint256.h>
+#include <undo.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace node {
+static size_t UndoMemoryUsage(const CBlockUndo& blockundo)
+{
+    size_t usage{memusage::DynamicUsage(blockundo.vtxundo)};
+    for (const CTxUndo& txundo : blockundo.vtxundo) {
+        usage += memusage::DynamicUsage(txundo.vprevout);
+        for (const Coin& coin : txundo.vprevout) {
+            usage += coin.DynamicMemoryUsage();
+        }
+    }
+    return usage;
+}
+
+BlockPrefetcher::~BlockPrefetcher()
+{
+    m_pool.Stop();
+}
+
+bool BlockPrefetcher::HasRoom(size_t max_bytes) const
+{
+    AssertLockHeld(::cs_main);
+    return m_blocks.size() < MAX_BLOCK_PREFETCH && DynamicMemoryUsage() < max_bytes;
+}
+
+void BlockPrefetcher::ScheduleBlock(const CBlockIndex& index)
+{
+    AssertLockHeld(::cs_main);
+    if (m_pool.WorkersCount() == 0) m_pool.Start(BLOCK_PREFETCH_THREADS);
+    // Reads must not take cs_main, which validation holds while waiting for them
+    m_blocks.emplace(&index, m_pool.Submit([this, pos = index.GetBlockPos(), hash = index.GetBlockHash()] {
+        auto block{std::make_shared<CBlock>()};
+        if (!m_blockman.ReadBlockFromDisk(*block, pos) || block->GetHash() != hash) {
+            // Validation reads the block again and reports the error
+            return Prefetched<CBlock>{};
+        }
+        const size_t size{RecursiveDynamicUsage(*block)};
+        return Prefetched<CBlock>{std::move(block), size};
+    }));
+}
+
+void BlockPrefetcher::ScheduleUndo(const CBlockIndex& index)
+{
+    AssertLockHeld(::cs_main);
+    if (m_pool.WorkersCount() == 0) m_pool.Start(BLOCK_PREFETCH_THREADS);
+    m_undo.emplace(&index, m_pool.Submit([this, pos = index.GetUndoPos(), prev_hash = index.pprev->GetBlockHash()] {
+        auto undo{std::make_shared<CBlockUndo>()};
+        if (!m_blockman.UndoReadFromDisk(*undo, pos, prev_hash)) {
+            return Prefetched<CBlockUndo>{};
+        }
+        const size_t size{UndoMemoryUsage(*undo)};
+        return Prefetched<CBlockUndo>{std::move(undo), size};
+    }));
+}
+
+void BlockPrefetcher::Retain(const std::vector<const CBlockIndex*>& blocks)
+{
+    AssertLockHeld(::cs_main);
+    const auto erase_others{[&](auto& map) {
+        std::erase_if(map, [&](const auto& entry) {
+            return std::find(blocks.begin(), blocks.end(), entry.first) == blocks.end();
+        });
+    }};
+    erase_others(m_blocks);
+    erase_others(m_undo);
+}
+
+void BlockPrefetcher::PrefetchConnect(const std::vector<const CBlockIndex*>& blocks, size_t max_bytes)
+{
+    AssertLockHeld(::cs_main);
+    Retain(blocks);
+    m_undo.clear();
+    for (const CBlockIndex* index : blocks) {
+        if (m_blocks.count(index)) continue;
+        if (!HasRoom(max_bytes)) break;
+        ScheduleBlock(*index);
+    }
+}
+
+void BlockPrefetcher::PrefetchDisconnect(const std::vector<const CBlockIndex*>& blocks, size_t max_bytes)
+{
+    AssertLockHeld(::cs_main);
+    Retain(blocks);
+    for (const CBlockIndex* index : blocks) {
+        if (m_blocks.count(index)) continue;
+        if (!HasRoom(max_bytes)) break;
+        ScheduleBlock(*index);
+        ScheduleUndo(*index);
+    }
+}
+
+std::shared_ptr<const CBlock> BlockPrefetcher::TakeBlock(const CBlockIndex& index)
+{
+    AssertLockHeld(::cs_main);
+    const auto it{m_blocks.find(&index)};
+    if (it == m_blocks.end()) return nullptr;
+    const std::shared_future<Prefetched<CBlock>> prefetched{std::move(it->second)};
+    m_blocks.erase(it);
+    return prefetched.get().data;
+}
+
+bool BlockPrefetcher::TakeUndo(const CBlockIndex& index, CBlockUndo& blockundo)
+{
+    AssertLockHeld(::cs_main);
+    const auto it{m_undo.find(&index)};
+    if (it == m_undo.end()) return false;
+    const std::shared_future<Prefetched<CBlockUndo>> prefetched{std::move(it->second)};
+    m_undo.erase(it);
+    // The future was the only reference to the data, so it can be moved from
+    const std::shared_ptr<CBlockUndo>& data{prefetched.get().data};
+    if (!data) return false;
+    blockundo = std::move(*data);
+    return true;
+}
+
+size_t BlockPrefetcher::DynamicMemoryUsage() const
+{
+    AssertLockHeld(::cs_main);
+    size_t usage{0};
+    const auto add_ready{[&](const auto& map) {
+        for (const auto& [_, prefetched] : map) {
+            if (prefetched.wait_for(std::chrono::seconds::zero()) == std::future_status::ready) {
+                usage += prefetched.get().size;
+            }
+        }
+    }};
+    add_ready(m_blocks);
+    add_ready(m_undo);
+    return usage;
+}
+} // namespace node
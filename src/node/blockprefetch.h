@@ -0,0 +1,95 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_NODE_BLOCKPREFETCH_H
+#define BETGENIUS_NODE_BLOCKPREFETCH_H
+
+#include <kernel/cs_main.h>
+#include <sync.h>
+#include <util/threadpool.h>
+
+#include <cstddef>
+#include <future>
+#include <map>
+#include <memory>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+class CBlockUndo;
+
+namespace node {
+class BlockManager;
+
+//! Maximum number of blocks read ahead of validation
+static constexpr size_t MAX_BLOCK_PREFETCH{16};
+//! Number of threads reading blocks ahead of validation
+static constexpr int BLOCK_PREFETCH_THREADS{2};
+
+/**
+ * Reads the blocks that are about to be connected, and the blocks and undo
+ * data of those about to be disconnected, on background threads, so that
+ * validation does not wait for the disk and deserialization for every block.
+ *
+ * Prefetched data is held until taken by validation, or until the blocks drop
+ * out of the list passed to the next Prefetch call. At most MAX_BLOCK_PREFETCH
+ * blocks are in flight, and no new reads start while the data held exceeds
+ * the memory limit.
+ */
+class BlockPrefetcher
+{
+public:
+    explicit BlockPrefetcher(const BlockManager& blockman) : m_blockman{blockman} {}
+    ~BlockPrefetcher();
+
+    BlockPrefetcher(const BlockPrefetcher&) = delete;
+    BlockPrefetcher& operator=(const BlockPrefetcher&) = delete;
+
+    /**
+     * Start reading the given blocks, in order, for connecting them. Blocks
+     * that were prefetched before but are not in the list are dropped.
+     */
+    void PrefetchConnect(const std::vector<const CBlockIndex*>& blocks, size_t max_bytes) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /** Start reading the given blocks and their undo data, in order, for disconnecting them. */
+    void PrefetchDisconnect(const std::vector<const CBlockIndex*>& blocks, size_t max_bytes) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /**
+     * Take the prefetched block, waiting for its read to finish. Returns
+     * nullptr if it was not prefetched or could not be read.
+     */
+    std::shared_ptr<const CBlock> TakeBlock(const CBlockIndex& index) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /** Move the prefetched undo data of a block into blockundo. Returns false if it was not prefetched or could not be read. */
+    bool TakeUndo(const CBlockIndex& index, CBlockUndo& blockundo) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /** Memory held by prefetched data that has been read. */
+    size_t DynamicMemoryUsage() const EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+private:
+    template <typename T>
+    struct Prefetched {
+        std::shared_ptr<T> data;
+        //! Dynamic memory usage of data
+        size_t size{0};
+    };
+    template <typename T>
+    using PrefetchMap = std::map<const CBlockIndex*, std::shared_future<Prefetched<T>>>;
+
+    const BlockManager& m_blockman;
+    //! Started on first use, as most chainstates never read ahead
+    ThreadPool m_pool{"blkprefetch"};
+    PrefetchMap<CBlock> m_blocks GUARDED_BY(::cs_main);
+    PrefetchMap<CBlockUndo> m_undo GUARDED_BY(::cs_main);
+
+    //! Whether another read can start without exceeding the limits
+    bool HasRoom(size_t max_bytes) const EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    void ScheduleBlock(const CBlockIndex& index) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    void ScheduleUndo(const CBlockIndex& index) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    //! Drop prefetched data of blocks that are not in the list
+    void Retain(const std::vector<const CBlockIndex*>& blocks) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+};
+} // namespace node
+
+#endif // BETGENIUS_NODE_BLOCKPREFETCH_H
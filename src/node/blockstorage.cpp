@@ -7,6 +7,7 @@
 
 #include <arith_uint256.h>
 #include <chain.h>
+#include <common/system.h>
 #include <consensus/params.h>
 #include <consensus/validation.h>
 #include <dbwrapper.h>
@@ -33,11 +34,20 @@
 #include <util/fs.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
+#include <util/threadpool.h>
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <future>
 #include <map>
+#include <memory>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace kernel {
 static constexpr uint8_t DB_BLOCK_FILES{'f'};
@@ -74,19 +84,24 @@ bool BlockTreeDB::ReadLastBlockFile(int& nFile)
     return Read(DB_LAST_BLOCK, nFile);
 }
 
-bool BlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*>>& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo)
+bool BlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*>>& fileInfo, int nLastFile, const std::vector<std::pair<uint256, CDiskBlockIndex>>& blockinfo)
 {
     CDBBatch batch(*this);
     for (const auto& [file, info] : fileInfo) {
         batch.Write(std::make_pair(DB_BLOCK_FILES, file), *info);
     }
     batch.Write(DB_LAST_BLOCK, nLastFile);
-    for (const CBlockIndex* bi : blockinfo) {
-        batch.Write(std::make_pair(DB_BLOCK_INDEX, bi->GetBlockHash()), CDiskBlockIndex{bi});
+    for (const auto& [hash, diskindex] : blockinfo) {
+        batch.Write(std::make_pair(DB_BLOCK_INDEX, hash), diskindex);
     }
     return WriteBatch(batch, true);
 }
 
+bool BlockTreeDB::ReadBlockIndex(const uint256& hash, CDiskBlockIndex& diskindex) const
+{
+    return Read(std::make_pair(DB_BLOCK_INDEX, hash), diskindex);
+}
+
 bool BlockTreeDB::WriteFlag(const std::string& name, bool fValue)
 {
     return Write(std::make_pair(DB_FLAG, name), fValue ? uint8_t{'1'} : uint8_t{'0'});
@@ -102,49 +117,130 @@ bool BlockTreeDB::ReadFlag(const std::string& name, bool& fValue)
     return true;
 }
 
-bool BlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, const util::SignalInterrupt& interrupt)
+//! Number of hash ranges the block index is split into for loading
+static constexpr int BLOCK_INDEX_LOAD_SHARDS{256};
+//! Upper bound on the number of threads reading the block index
+static constexpr int MAX_BLOCK_INDEX_LOAD_THREADS{8};
+
+//! The fields of a block index entry read from the database that are kept in memory
+struct LoadedBlockIndex {
+    uint256 hash;
+    uint256 hashPrev;
+    int nHeight;
+    int nFile;
+    unsigned int nDataPos;
+    unsigned int nUndoPos;
+    int32_t nVersion;
+    uint32_t nTime;
+    uint32_t nBits;
+    uint32_t nStatus;
+    unsigned int nTx;
+};
+
+//! Block index entries are keyed by block hash, so shard i holds the hashes whose first byte is i.
+static uint256 BlockIndexShardBegin(int index)
 {
-    AssertLockHeld(::cs_main);
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
-    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
+    uint256 hash;
+    hash.begin()[0] = index;
+    return hash;
+}
 
-    // Load m_block_index
+/**
+ * Read, hash and check the proof of work of all block index entries in one
+ * hash range. This runs on worker threads and does not touch shared state:
+ * the CDiskBlockIndex objects read are private, so need no cs_main.
+ */
+static bool LoadBlockIndexShard(CDBWrapper& db, int index, const Consensus::Params& consensusParams,
+                                std::vector<LoadedBlockIndex>& entries, const util::SignalInterrupt& interrupt,
+                                const std::atomic<bool>& failed) NO_THREAD_SAFETY_ANALYSIS
+{
+    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, BlockIndexShardBegin(index)));
     while (pcursor->Valid()) {
-        if (interrupt) return false;
+        if (interrupt || failed) return false;
         std::pair<uint8_t, uint256> key;
-        if (pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
-            CDiskBlockIndex diskindex;
-            if (pcursor->GetValue(diskindex)) {
-                // Construct block index object
-                CBlockIndex* pindexNew = insertBlockIndex(diskindex.ConstructBlockHash());
-                pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
-                pindexNew->nHeight        = diskindex.nHeight;
-                pindexNew->nFile          = diskindex.nFile;
-                pindexNew->nDataPos       = diskindex.nDataPos;
-                pindexNew->nUndoPos       = diskindex.nUndoPos;
-                pindexNew->nVersion       = diskindex.nVersion;
-                pindexNew->hashMix        = diskindex.hashMix;
-                pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-                pindexNew->nTime          = diskindex.nTime;
-                pindexNew->nBits          = diskindex.nBits;
-                pindexNew->nNonce         = diskindex.nNonce;
-                pindexNew->nStatus        = diskindex.nStatus;
-                pindexNew->nTx            = diskindex.nTx;
-
-                if (!CheckProofOfWork(pindexNew->GetBlockHash(), pindexNew->nBits, consensusParams)) {
-                    return error("%s: CheckProofOfWork failed: %s", __func__, pindexNew->ToString());
-                }
+        if (!pcursor->GetKey(key) || key.first != DB_BLOCK_INDEX) break;
+        if (index + 1 < BLOCK_INDEX_LOAD_SHARDS && key.second.begin()[0] != index) break;
+        CDiskBlockIndex diskindex;
+        if (!pcursor->GetValue(diskindex)) {
+            return error("%s: failed to read value", __func__);
+        }
+        const uint256 hash{diskindex.ConstructBlockHash()};
+        if (!CheckProofOfWork(hash, diskindex.nBits, consensusParams)) {
+            return error("%s: CheckProofOfWork failed: %s", __func__, hash.ToString());
+        }
+        entries.push_back({hash, diskindex.hashPrev, diskindex.nHeight, diskindex.nFile, diskindex.nDataPos, diskindex.nUndoPos,
+                           diskindex.nVersion, diskindex.nTime, diskindex.nBits, diskindex.nStatus, diskindex.nTx});
+        pcursor->Next();
+    }
+    return true;
+}
 
-                pcursor->Next();
-            } else {
-                return error("%s: failed to read value", __func__);
+bool BlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, const util::SignalInterrupt& interrupt)
+{
+    AssertLockHeld(::cs_main);
+
+    // Deserializing and hashing entries dominates, so hash ranges are read on
+    // worker threads, each through its own cursor. Only the insertion into the
+    // block index happens on this thread, range by range.
+    const int num_threads{std::clamp(GetNumCores(), 1, MAX_BLOCK_INDEX_LOAD_THREADS)};
+    ThreadPool pool{"loadblkindex"};
+    pool.Start(num_threads);
+
+    // Keep a bounded number of ranges in flight, as each one is buffered until
+    // it is inserted.
+    std::atomic<bool> failed{false};
+    const size_t window{2 * size_t(num_threads)};
+    std::vector<std::vector<LoadedBlockIndex>> shards(BLOCK_INDEX_LOAD_SHARDS);
+    std::vector<std::future<bool>> futures;
+    const auto submit{[&](int i) {
+        futures.push_back(pool.Submit([&, i] {
+            try {
+                const bool ok{LoadBlockIndexShard(*this, i, consensusParams, shards[i], interrupt, failed)};
+                if (!ok) failed = true;
+                return ok;
+            } catch (...) {
+                failed = true;
+                throw;
             }
-        } else {
+        }));
+    }};
+    for (size_t i = 0; i < std::min<size_t>(window, BLOCK_INDEX_LOAD_SHARDS); ++i) submit(i);
+
+    bool success{true};
+    std::exception_ptr exception;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        try {
+            success &= futures[i].get();
+        } catch (...) {
+            if (!exception) exception = std::current_exception();
+        }
+        if (!success || exception) {
+            // Wait for the ranges still in flight before unwinding
+            for (size_t j = i + 1; j < futures.size(); ++j) futures[j].wait();
             break;
         }
+        if (i + window < shards.size()) submit(i + window);
+
+        for (const LoadedBlockIndex& diskindex : shards[i]) {
+            // Construct block index object
+            CBlockIndex* pindexNew = insertBlockIndex(diskindex.hash);
+            pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
+            pindexNew->nHeight        = diskindex.nHeight;
+            pindexNew->nFile          = diskindex.nFile;
+            pindexNew->nDataPos       = diskindex.nDataPos;
+            pindexNew->nUndoPos       = diskindex.nUndoPos;
+            pindexNew->nVersion       = diskindex.nVersion;
+            pindexNew->nTime          = diskindex.nTime;
+            pindexNew->nBits          = diskindex.nBits;
+            pindexNew->nStatus        = diskindex.nStatus;
+            pindexNew->nTx            = diskindex.nTx;
+        }
+        shards[i] = std::vector<LoadedBlockIndex>{};
     }
+    if (exception) std::rethrow_exception(exception);
 
-    return true;
+    return success;
 }
 } // namespace kernel
 
@@ -186,6 +282,35 @@ std::vector<CBlockIndex*> BlockManager::GetAllBlockIndices()
     return rv;
 }
 
+std::vector<CBlockIndex*> BlockManager::GetAllBlockIndicesByHeight()
+{
+    AssertLockHeld(cs_main);
+    // Counting sort: heights are dense, from 0 to the best header's height.
+    // Heights come from the block tree db, so fall back to a comparison sort
+    // if one is out of that range, and let the caller reject the index.
+    int max_height{-1};
+    for (const auto& [_, block_index] : m_block_index) {
+        if (block_index.nHeight < 0 || static_cast<size_t>(block_index.nHeight) >= m_block_index.size()) {
+            std::vector<CBlockIndex*> rv{GetAllBlockIndices()};
+            std::sort(rv.begin(), rv.end(), CBlockIndexHeightOnlyComparator());
+            return rv;
+        }
+        max_height = std::max(max_height, block_index.nHeight);
+    }
+    std::vector<size_t> offsets(max_height + 2, 0);
+    for (const auto& [_, block_index] : m_block_index) {
+        ++offsets[block_index.nHeight + 1];
+    }
+    for (size_t height = 1; height < offsets.size(); ++height) {
+        offsets[height] += offsets[height - 1];
+    }
+    std::vector<CBlockIndex*> rv(m_block_index.size());
+    for (auto& [_, block_index] : m_block_index) {
+        rv[offsets[block_index.nHeight]++] = &block_index;
+    }
+    return rv;
+}
+
 CBlockIndex* BlockManager::LookupBlockIndex(const uint256& hash)
 {
     AssertLockHeld(cs_main);
@@ -230,18 +355,27 @@ CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, CBlockInde
     }
 
     m_dirty_blockindex.insert(pindexNew);
+    WITH_LOCK(m_unwritten_headers_mutex, m_unwritten_headers.emplace(pindexNew, BlockHeaderColdData{block.hashMix, block.hashMerkleRoot, block.nNonce}));
 
     return pindexNew;
 }
 
 void BlockManager::PruneOneBlockFile(const int fileNumber)
+{
+    PruneBlockFiles({fileNumber});
+}
+
+void BlockManager::PruneBlockFiles(const std::vector<int>& files)
 {
     AssertLockHeld(cs_main);
     LOCK(cs_LastBlockFile);
 
+    if (files.empty()) return;
+    // Visit the block index once for all files
+    const std::set<int> file_set{files.begin(), files.end()};
     for (auto& entry : m_block_index) {
         CBlockIndex* pindex = &entry.second;
-        if (pindex->nFile == fileNumber) {
+        if (file_set.count(pindex->nFile)) {
             pindex->nStatus &= ~BLOCK_HAVE_DATA;
             pindex->nStatus &= ~BLOCK_HAVE_UNDO;
             pindex->nFile = 0;
@@ -264,8 +398,92 @@ void BlockManager::PruneOneBlockFile(const int fileNumber)
         }
     }
 
-    m_blockfile_info.at(fileNumber) = CBlockFileInfo{};
-    m_dirty_fileinfo.insert(fileNumber);
+    for (const int fileNumber : files) {
+        m_prune_candidates.erase({m_blockfile_info.at(fileNumber).nHeightLast, fileNumber});
+        m_blockfile_info.at(fileNumber) = CBlockFileInfo{};
+        m_dirty_fileinfo.insert(fileNumber);
+    }
+}
+
+void BlockManager::UpdatePruneCandidate(int file, unsigned int old_height_last)
+{
+    AssertLockHeld(cs_LastBlockFile);
+    m_prune_candidates.erase({old_height_last, file});
+    const CBlockFileInfo& info{m_blockfile_info[file]};
+    if (info.nBlocks > 0) {
+        m_prune_candidates.emplace(info.nHeightLast, file);
+    }
+}
+
+PrunePlan BlockManager::PlanPruning(std::optional<uint64_t> target, int last_prune, const Chainstate& chain, ChainstateManager& chainman)
+{
+    AssertLockHeld(cs_main);
+    LOCK(cs_LastBlockFile);
+
+    PrunePlan plan;
+    plan.usage_before = plan.usage_after = CalculateCurrentUsage();
+    if (chain.m_chain.Height() < 0) {
+        return plan;
+    }
+    uint64_t nBuffer{0};
+    if (target) {
+        // Distribute our -prune budget over all chainstates.
+        target = std::max(MIN_DISK_SPACE_FOR_BLOCK_FILES, *target / chainman.GetAll().size());
+        if (*target == 0 || static_cast<uint64_t>(chain.m_chain.Height()) <= chainman.GetParams().PruneAfterHeight()) {
+            return plan;
+        }
+    }
+
+    std::tie(plan.min_height, plan.max_height) = chainman.GetPruneRange(chain, last_prune);
+
+    if (target) {
+        // We don't check to prune until after we've allocated new space for files
+        // So we should leave a buffer under our target to account for another allocation
+        // before the next pruning.
+        nBuffer = BLOCKFILE_CHUNK_SIZE + UNDOFILE_CHUNK_SIZE;
+        if (plan.usage_after + nBuffer < *target) {
+            return plan;
+        }
+        // On a prune event, the chainstate DB is flushed.
+        // To avoid excessive prune events negating the benefit of high dbcache
+        // values, we should not prune too rapidly.
+        // So when pruning in IBD, increase the buffer to avoid a re-prune too soon.
+        const uint64_t target_sync_height = chainman.m_best_header->nHeight;
+        const auto chain_tip_height = chain.m_chain.Height();
+        if (chainman.IsInitialBlockDownload() && target_sync_height > (uint64_t)chain_tip_height) {
+            // Since this is only relevant during IBD, we assume blocks are at least 1 MB on average
+            static constexpr uint64_t average_block_size = 1000000;  /* 1 MB */
+            const uint64_t remaining_blocks = target_sync_height - chain_tip_height;
+            nBuffer += average_block_size * remaining_blocks;
+        }
+    }
+
+    // Files are visited by the height of their last block, and none after
+    // the first one holding blocks above the prunable range.
+    const int max_blockfile{MaxBlockfileNum()};
+    for (const auto& [height_last, fileNumber] : m_prune_candidates) {
+        if (height_last > (unsigned)plan.max_height) {
+            break;
+        }
+        const auto& fileinfo = m_blockfile_info[fileNumber];
+        if (fileNumber >= max_blockfile || fileinfo.nSize == 0) {
+            continue;
+        }
+
+        if (target && plan.usage_after + nBuffer < *target) { // are we below our target?
+            break;
+        }
+
+        // don't prune files that could have a block that's not within the allowable
+        // prune range for the chain being pruned.
+        if (fileinfo.nHeightFirst < (unsigned)plan.min_height) {
+            continue;
+        }
+
+        plan.files.push_back(fileNumber);
+        plan.usage_after -= fileinfo.nSize + fileinfo.nUndoSize;
+    }
+    return plan;
 }
 
 void BlockManager::FindFilesToPruneManual(
@@ -281,21 +499,11 @@ void BlockManager::FindFilesToPruneManual(
         return;
     }
 
-    const auto [min_block_to_prune, last_block_can_prune] = chainman.GetPruneRange(chain, nManualPruneHeight);
-
-    int count = 0;
-    for (int fileNumber = 0; fileNumber < this->MaxBlockfileNum(); fileNumber++) {
-        const auto& fileinfo = m_blockfile_info[fileNumber];
-        if (fileinfo.nSize == 0 || fileinfo.nHeightLast > (unsigned)last_block_can_prune || fileinfo.nHeightFirst < (unsigned)min_block_to_prune) {
-            continue;
-        }
-
-        PruneOneBlockFile(fileNumber);
-        setFilesToPrune.insert(fileNumber);
-        count++;
-    }
+    const PrunePlan plan{PlanPruning(/*target=*/std::nullopt, nManualPruneHeight, chain, chainman)};
+    PruneBlockFiles(plan.files);
+    setFilesToPrune.insert(plan.files.begin(), plan.files.end());
     LogPrintf("[%s] Prune (Manual): prune_height=%d removed %d blk/rev pairs\n",
-        chain.GetRole(), last_block_can_prune, count);
+        chain.GetRole(), plan.max_height, plan.files.size());
 }
 
 void BlockManager::FindFilesToPrune(
@@ -305,71 +513,36 @@ void BlockManager::FindFilesToPrune(
     ChainstateManager& chainman)
 {
     LOCK2(cs_main, cs_LastBlockFile);
-    // Distribute our -prune budget over all chainstates.
-    const auto target = std::max(
-        MIN_DISK_SPACE_FOR_BLOCK_FILES, GetPruneTarget() / chainman.GetAll().size());
-    const uint64_t target_sync_height = chainman.m_best_header->nHeight;
-
-    if (chain.m_chain.Height() < 0 || target == 0) {
-        return;
-    }
-    if (static_cast<uint64_t>(chain.m_chain.Height()) <= chainman.GetParams().PruneAfterHeight()) {
+    if (GetPruneTarget() == 0) {
         return;
     }
 
-    const auto [min_block_to_prune, last_block_can_prune] = chainman.GetPruneRange(chain, last_prune);
-
-    uint64_t nCurrentUsage = CalculateCurrentUsage();
-    // We don't check to prune until after we've allocated new space for files
-    // So we should leave a buffer under our target to account for another allocation
-    // before the next pruning.
-    uint64_t nBuffer = BLOCKFILE_CHUNK_SIZE + UNDOFILE_CHUNK_SIZE;
-    uint64_t nBytesToPrune;
-    int count = 0;
-
-    if (nCurrentUsage + nBuffer >= target) {
-        // On a prune event, the chainstate DB is flushed.
-        // To avoid excessive prune events negating the benefit of high dbcache
-        // values, we should not prune too rapidly.
-        // So when pruning in IBD, increase the buffer to avoid a re-prune too soon.
-        const auto chain_tip_height = chain.m_chain.Height();
-        if (chainman.IsInitialBlockDownload() && target_sync_height > (uint64_t)chain_tip_height) {
-            // Since this is only relevant during IBD, we assume blocks are at least 1 MB on average
-            static constexpr uint64_t average_block_size = 1000000;  /* 1 MB */
-            const uint64_t remaining_blocks = target_sync_height - chain_tip_height;
-            nBuffer += average_block_size * remaining_blocks;
-        }
-
-        for (int fileNumber = 0; fileNumber < this->MaxBlockfileNum(); fileNumber++) {
-            const auto& fileinfo = m_blockfile_info[fileNumber];
-            nBytesToPrune = fileinfo.nSize + fileinfo.nUndoSize;
-
-            if (fileinfo.nSize == 0) {
-                continue;
-            }
-
-            if (nCurrentUsage + nBuffer < target) { // are we below our target?
-                break;
-            }
+    const PrunePlan plan{PlanPruning(GetPruneTarget(), last_prune, chain, chainman)};
+    PruneBlockFiles(plan.files);
+    setFilesToPrune.insert(plan.files.begin(), plan.files.end());
 
-            // don't prune files that could have a block that's not within the allowable
-            // prune range for the chain being pruned.
-            if (fileinfo.nHeightLast > (unsigned)last_block_can_prune || fileinfo.nHeightFirst < (unsigned)min_block_to_prune) {
-                continue;
-            }
+    const auto target = std::max(
+        MIN_DISK_SPACE_FOR_BLOCK_FILES, GetPruneTarget() / chainman.GetAll().size());
+    LogPrint(BCLog::PRUNE, "[%s] target=%dMiB actual=%dMiB diff=%dMiB min_height=%d max_prune_height=%d removed %d blk/rev pairs\n",
+             chain.GetRole(), target / 1024 / 1024, plan.usage_after / 1024 / 1024,
+             (int64_t(target) - int64_t(plan.usage_after)) / 1024 / 1024,
+             plan.min_height, plan.max_height, plan.files.size());
+}
 
-            PruneOneBlockFile(fileNumber);
-            // Queue up the files for removal
-            setFilesToPrune.insert(fileNumber);
-            nCurrentUsage -= nBytesToPrune;
-            count++;
+int BlockManager::GetLastPrunableHeight(int chain_height, std::optional<std::string>& limiting_lock) const
+{
+    AssertLockHeld(::cs_main);
+    int last_prune{chain_height}; // last height we can prune
+    for (const auto& prune_lock : m_prune_locks) {
+        if (prune_lock.second.height_first == std::numeric_limits<int>::max()) continue;
+        // Remove the buffer and one additional block here to get actual height that is outside of the buffer
+        const int lock_height{prune_lock.second.height_first - PRUNE_LOCK_BUFFER - 1};
+        last_prune = std::max(1, std::min(last_prune, lock_height));
+        if (last_prune == lock_height) {
+            limiting_lock = prune_lock.first;
         }
     }
-
-    LogPrint(BCLog::PRUNE, "[%s] target=%dMiB actual=%dMiB diff=%dMiB min_height=%d max_prune_height=%d removed %d blk/rev pairs\n",
-             chain.GetRole(), target / 1024 / 1024, nCurrentUsage / 1024 / 1024,
-             (int64_t(target) - int64_t(nCurrentUsage)) / 1024 / 1024,
-             min_block_to_prune, last_block_can_prune, count);
+    return last_prune;
 }
 
 void BlockManager::UpdatePruneLock(const std::string& name, const PruneLockInfo& lock_info) {
@@ -425,13 +598,14 @@ bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockha
     Assert(m_snapshot_height.has_value() == snapshot_blockhash.has_value());
 
     // Calculate nChainWork
-    std::vector<CBlockIndex*> vSortedByHeight{GetAllBlockIndices()};
-    std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
-              CBlockIndexHeightOnlyComparator());
+    std::vector<CBlockIndex*> vSortedByHeight{GetAllBlockIndicesByHeight()};
 
     CBlockIndex* previous_index{nullptr};
     for (CBlockIndex* pindex : vSortedByHeight) {
         if (m_interrupt) return false;
+        if (pindex->nHeight < 0) {
+            return error("%s: block index has negative height %d", __func__, pindex->nHeight);
+        }
         if (previous_index && pindex->nHeight > previous_index->nHeight + 1) {
             return error("%s: block index is non-contiguous, index of height %d missing", __func__, previous_index->nHeight + 1);
         }
@@ -480,16 +654,32 @@ bool BlockManager::WriteBlockIndexDB()
         vFiles.emplace_back(*it, &m_blockfile_info[*it]);
         m_dirty_fileinfo.erase(it++);
     }
-    std::vector<const CBlockIndex*> vBlocks;
+    std::vector<std::pair<uint256, CDiskBlockIndex>> vBlocks;
     vBlocks.reserve(m_dirty_blockindex.size());
-    for (std::set<CBlockIndex*>::iterator it = m_dirty_blockindex.begin(); it != m_dirty_blockindex.end();) {
-        vBlocks.push_back(*it);
-        m_dirty_blockindex.erase(it++);
+    for (const CBlockIndex* pindex : m_dirty_blockindex) {
+        BlockHeaderColdData cold;
+        if (!ReadBlockHeaderColdData(*pindex, cold)) {
+            return error("%s: failed to read header of block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+        vBlocks.emplace_back(pindex->GetBlockHash(), CDiskBlockIndex{pindex, cold});
     }
+    const std::set<CBlockIndex*> written{std::move(m_dirty_blockindex)};
+    m_dirty_blockindex.clear();
     int max_blockfile = WITH_LOCK(cs_LastBlockFile, return this->MaxBlockfileNum());
     if (!m_block_tree_db->WriteBatchSync(vFiles, max_blockfile, vBlocks)) {
         return false;
     }
+    LOCK(m_unwritten_headers_mutex);
+    auto block{vBlocks.cbegin()};
+    for (const CBlockIndex* pindex : written) {
+        m_unwritten_headers.erase(pindex);
+        if (!pindex->IsValid(BLOCK_VALID_SCRIPTS) && m_unconnected_headers.size() < MAX_UNCONNECTED_HEADERS) {
+            m_unconnected_headers.emplace(pindex, block->second);
+        } else {
+            m_unconnected_headers.erase(pindex);
+        }
+        ++block;
+    }
     return true;
 }
 
@@ -533,11 +723,12 @@ bool BlockManager::LoadBlockIndexDB(const std::optional<uint256>& snapshot_block
     }
 
     {
-        // Initialize the blockfile cursors.
+        // Initialize the blockfile cursors and pruning candidates.
         LOCK(cs_LastBlockFile);
         for (size_t i = 0; i < m_blockfile_info.size(); ++i) {
             const auto last_height_in_file = m_blockfile_info[i].nHeightLast;
             m_blockfile_cursors[BlockfileTypeForHeight(last_height_in_file)] = {static_cast<int>(i), 0};
+            UpdatePruneCandidate(static_cast<int>(i), last_height_in_file);
         }
     }
 
@@ -667,45 +858,40 @@ CBlockFileInfo* BlockManager::GetBlockFileInfo(size_t n)
     return &m_blockfile_info.at(n);
 }
 
-bool BlockManager::UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const uint256& hashBlock) const
+void BlockManager::UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const uint256& hashBlock)
 {
-    // Open history file to append
-    AutoFile fileout{OpenUndoFile(pos)};
-    if (fileout.IsNull()) {
-        return error("%s: OpenUndoFile failed", __func__);
-    }
-
-    // Write index header
-    unsigned int nSize = GetSerializeSize(blockundo);
-    fileout << GetParams().MessageStart() << nSize;
-
-    // Write undo data
-    long fileOutPos = ftell(fileout.Get());
-    if (fileOutPos < 0) {
-        return error("%s: ftell failed", __func__);
-    }
-    pos.nPos = (unsigned int)fileOutPos;
-    fileout << blockundo;
+    // Serialize the index header, undo data and checksum
+    const unsigned int nSize = GetSerializeSize(blockundo);
+    std::vector<uint8_t> record;
+    record.reserve(BLOCK_SERIALIZATION_HEADER_SIZE + nSize + uint256::size());
+    VectorWriter{record, 0, GetParams().MessageStart(), nSize, blockundo};
 
     // calculate & write checksum
     HashWriter hasher{};
     hasher << hashBlock;
-    hasher << blockundo;
-    fileout << hasher.GetHash();
+    hasher.write(MakeByteSpan(record).subspan(BLOCK_SERIALIZATION_HEADER_SIZE));
+    VectorWriter{record, record.size(), hasher.GetHash()};
 
-    return true;
+    m_block_writer.Write(BlockFileWriter::FileType::UNDO, pos, std::move(record));
+    pos.nPos += BLOCK_SERIALIZATION_HEADER_SIZE;
 }
 
-bool BlockManager::UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex& index) const
+bool BlockManager::UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex& index, unsigned int* record_size) const
 {
     const FlatFilePos pos{WITH_LOCK(::cs_main, return index.GetUndoPos())};
+    return UndoReadFromDisk(blockundo, pos, index.pprev->GetBlockHash(), record_size);
+}
 
-    if (pos.IsNull()) {
+bool BlockManager::UndoReadFromDisk(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& prev_hash, unsigned int* record_size) const
+{
+    if (pos.IsNull() || (record_size && pos.nPos < BLOCK_SERIALIZATION_HEADER_SIZE)) {
         return error("%s: no undo data available", __func__);
     }
 
-    // Open history file to read
-    AutoFile filein{OpenUndoFile(pos, true)};
+    // Open history file to read, at the record header if its size is asked for
+    FlatFilePos hpos{pos};
+    if (record_size) hpos.nPos -= BLOCK_SERIALIZATION_HEADER_SIZE;
+    AutoFile filein{OpenUndoFile(hpos, true)};
     if (filein.IsNull()) {
         return error("%s: OpenUndoFile failed", __func__);
     }
@@ -714,7 +900,14 @@ bool BlockManager::UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex& in
     uint256 hashChecksum;
     HashVerifier verifier{filein}; // Use HashVerifier as reserializing may lose data, c.f. commit d342424301013ec47dc146a4beb49d5c9319d80a
     try {
-        verifier << index.pprev->GetBlockHash();
+        if (record_size) {
+            MessageStartChars magic;
+            filein >> magic >> *record_size;
+            if (magic != GetParams().MessageStart()) {
+                return error("%s: Undo magic mismatch at %s", __func__, pos.ToString());
+            }
+        }
+        verifier << prev_hash;
         verifier >> blockundo;
         filein >> hashChecksum;
     } catch (const std::exception& e) {
@@ -729,19 +922,14 @@ bool BlockManager::UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex& in
     return true;
 }
 
-bool BlockManager::FlushUndoFile(int block_file, bool finalize)
+void BlockManager::FlushUndoFile(int block_file, bool finalize)
 {
     FlatFilePos undo_pos_old(block_file, m_blockfile_info[block_file].nUndoSize);
-    if (!UndoFileSeq().Flush(undo_pos_old, finalize)) {
-        m_opts.notifications.flushError("Flushing undo file to disk failed. This is likely the result of an I/O error.");
-        return false;
-    }
-    return true;
+    m_block_writer.Flush(BlockFileWriter::FileType::UNDO, undo_pos_old, finalize);
 }
 
-bool BlockManager::FlushBlockFile(int blockfile_num, bool fFinalize, bool finalize_undo)
+void BlockManager::FlushBlockFile(int blockfile_num, bool fFinalize, bool finalize_undo)
 {
-    bool success = true;
     LOCK(cs_LastBlockFile);
 
     if (m_blockfile_info.size() < 1) {
@@ -749,23 +937,17 @@ bool BlockManager::FlushBlockFile(int blockfile_num, bool fFinalize, bool finali
         // chainstate init, when we call ChainstateManager::MaybeRebalanceCaches() (which
         // then calls FlushStateToDisk()), resulting in a call to this function before we
         // have populated `m_blockfile_info` via LoadBlockIndexDB().
-        return true;
+        return;
     }
     assert(static_cast<int>(m_blockfile_info.size()) > blockfile_num);
 
     FlatFilePos block_pos_old(blockfile_num, m_blockfile_info[blockfile_num].nSize);
-    if (!BlockFileSeq().Flush(block_pos_old, fFinalize)) {
-        m_opts.notifications.flushError("Flushing block file to disk failed. This is likely the result of an I/O error.");
-        success = false;
-    }
+    m_block_writer.Flush(BlockFileWriter::FileType::BLOCK, block_pos_old, fFinalize);
     // we do not always flush the undo file, as the chain tip may be lagging behind the incoming blocks,
     // e.g. during IBD or a sync after a node going offline
     if (!fFinalize || finalize_undo) {
-        if (!FlushUndoFile(blockfile_num, finalize_undo)) {
-            success = false;
-        }
+        FlushUndoFile(blockfile_num, finalize_undo);
     }
-    return success;
 }
 
 BlockfileType BlockManager::BlockfileTypeForHeight(int height)
@@ -778,16 +960,19 @@ BlockfileType BlockManager::BlockfileTypeForHeight(int height)
 
 bool BlockManager::FlushChainstateBlockFile(int tip_height)
 {
-    LOCK(cs_LastBlockFile);
-    auto& cursor = m_blockfile_cursors[BlockfileTypeForHeight(tip_height)];
-    // If the cursor does not exist, it means an assumeutxo snapshot is loaded,
-    // but no blocks past the snapshot height have been written yet, so there
-    // is no data associated with the chainstate, and it is safe not to flush.
-    if (cursor) {
-        return FlushBlockFile(cursor->file_num, /*fFinalize=*/false, /*finalize_undo=*/false);
-    }
-    // No need to log warnings in this case.
-    return true;
+    {
+        LOCK(cs_LastBlockFile);
+        auto& cursor = m_blockfile_cursors[BlockfileTypeForHeight(tip_height)];
+        // If the cursor does not exist, it means an assumeutxo snapshot is loaded,
+        // but no blocks past the snapshot height have been written yet, so there
+        // is no data associated with the chainstate, and it is safe not to flush.
+        if (cursor) {
+            FlushBlockFile(cursor->file_num, /*fFinalize=*/false, /*finalize_undo=*/false);
+        }
+    }
+    // Files left behind by the cursors were flushed when they were, so once
+    // the writer is done all queued data is on disk.
+    return m_block_writer.Sync();
 }
 
 uint64_t BlockManager::CalculateCurrentUsage()
@@ -814,6 +999,13 @@ void BlockManager::UnlinkPrunedFiles(const std::set<int>& setFilesToPrune) const
     }
 }
 
+void BlockManager::UnlinkPrunedFilesInBackground(const std::set<int>& setFilesToPrune)
+{
+    for (const int file : setFilesToPrune) {
+        m_block_writer.Remove(file);
+    }
+}
+
 FlatFileSeq BlockManager::BlockFileSeq() const
 {
     return FlatFileSeq(m_opts.blocks_dir, "blk", m_opts.fast_prune ? 0x4000 /* 16kb */ : BLOCKFILE_CHUNK_SIZE);
@@ -826,12 +1018,14 @@ FlatFileSeq BlockManager::UndoFileSeq() const
 
 AutoFile BlockManager::OpenBlockFile(const FlatFilePos& pos, bool fReadOnly) const
 {
+    if (fReadOnly) m_block_writer.WaitForWrites(BlockFileWriter::FileType::BLOCK, pos.nFile);
     return AutoFile{BlockFileSeq().Open(pos, fReadOnly)};
 }
 
 /** Open an undo file (rev?????.dat) */
 AutoFile BlockManager::OpenUndoFile(const FlatFilePos& pos, bool fReadOnly) const
 {
+    if (fReadOnly) m_block_writer.WaitForWrites(BlockFileWriter::FileType::UNDO, pos.nFile);
     return AutoFile{UndoFileSeq().Open(pos, fReadOnly)};
 }
 
@@ -900,23 +1094,19 @@ bool BlockManager::FindBlockPos(FlatFilePos& pos, unsigned int nAddSize, unsigne
                 last_blockfile, m_blockfile_info[last_blockfile].ToString(), nFile, nHeight);
         }
 
-        // Do not propagate the return code. The flush concerns a previous block
-        // and undo file that has already been written to. If a flush fails
-        // here, and we crash, there is no expected additional block data
-        // inconsistency arising from the flush failure here. However, the undo
-        // data may be inconsistent after a crash if the flush is called during
-        // a reindex. A flush error might also leave some of the data files
-        // untrimmed.
-        if (!FlushBlockFile(last_blockfile, !fKnown, finalize_undo)) {
-            LogPrintLevel(BCLog::BLOCKSTORAGE, BCLog::Level::Warning,
-                          "Failed to flush previous block file %05i (finalize=%i, finalize_undo=%i) before opening new block file %05i\n",
-                          last_blockfile, !fKnown, finalize_undo, nFile);
-        }
+        // The flush of the previous block and undo file is queued, and
+        // committed to disk by the block file writer together with other
+        // flushes. Its failure is reported by the writer, and makes the next
+        // FlushChainstateBlockFile() fail, so the block index is not written
+        // to refer to data that may not be on disk.
+        FlushBlockFile(last_blockfile, !fKnown, finalize_undo);
         // No undo data yet in the new file, so reset our undo-height tracking.
         m_blockfile_cursors[chain_type] = BlockfileCursor{nFile};
     }
 
+    const unsigned int old_height_last{m_blockfile_info[nFile].nHeightLast};
     m_blockfile_info[nFile].AddBlock(nHeight, nTime);
+    UpdatePruneCandidate(nFile, old_height_last);
     if (fKnown) {
         m_blockfile_info[nFile].nSize = std::max(pos.nPos + nAddSize, m_blockfile_info[nFile].nSize);
     } else {
@@ -961,29 +1151,57 @@ bool BlockManager::FindUndoPos(BlockValidationState& state, int nFile, FlatFileP
     return true;
 }
 
-bool BlockManager::WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const
+void BlockManager::WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, BlockFormat format)
 {
-    // Open history file to append
-    AutoFile fileout{OpenBlockFile(pos)};
-    if (fileout.IsNull()) {
-        return error("WriteBlockToDisk: OpenBlockFile failed");
+    // Serialize the index header and block
+    const unsigned int nSize = format == BlockFormat::COMPACT_V1 ? GetSerializeSize(Using<CompactBlockFormatter>(block)) :
+                                                                   GetSerializeSize(TX_WITH_WITNESS(block));
+    std::vector<uint8_t> record;
+    record.reserve(BLOCK_SERIALIZATION_HEADER_SIZE + nSize);
+    if (format == BlockFormat::COMPACT_V1) {
+        VectorWriter{record, 0, GetParams().MessageStart(), MakeBlockRecordSize(format, nSize), Using<CompactBlockFormatter>(block)};
+    } else {
+        VectorWriter{record, 0, GetParams().MessageStart(), MakeBlockRecordSize(format, nSize), TX_WITH_WITNESS(block)};
     }
 
-    // Write index header
-    unsigned int nSize = GetSerializeSize(TX_WITH_WITNESS(block));
-    fileout << GetParams().MessageStart() << nSize;
+    m_block_writer.Write(BlockFileWriter::FileType::BLOCK, pos, std::move(record));
+    pos.nPos += BLOCK_SERIALIZATION_HEADER_SIZE;
+}
 
-    // Write block
-    long fileOutPos = ftell(fileout.Get());
-    if (fileOutPos < 0) {
-        return error("WriteBlockToDisk: ftell failed");
-    }
-    pos.nPos = (unsigned int)fileOutPos;
-    fileout << TX_WITH_WITNESS(block);
+bool BlockManager::ReadBlockRecordHeader(AutoFile& filein, const FlatFilePos& pos, BlockFormat& format, unsigned int& size) const
+{
+    MessageStartChars blk_start;
+    uint32_t size_field;
+    filein >> blk_start >> size_field;
 
+    if (blk_start != GetParams().MessageStart()) {
+        return error("%s: Block magic mismatch for %s: %s versus expected %s", __func__, pos.ToString(),
+                     HexStr(blk_start),
+                     HexStr(GetParams().MessageStart()));
+    }
+    std::tie(format, size) = ParseBlockRecordSize(size_field);
+    if (!IsKnownBlockFormat(format)) {
+        return error("%s: Unknown block format %u for %s", __func__, static_cast<unsigned int>(format), pos.ToString());
+    }
     return true;
 }
 
+bool BlockManager::ReadBlockRecordSize(const FlatFilePos& pos, unsigned int& size) const
+{
+    FlatFilePos hpos{pos};
+    hpos.nPos -= BLOCK_SERIALIZATION_HEADER_SIZE;
+    AutoFile filein{OpenBlockFile(hpos, true)};
+    if (filein.IsNull()) {
+        return error("%s: OpenBlockFile failed for %s", __func__, pos.ToString());
+    }
+    try {
+        BlockFormat format;
+        return ReadBlockRecordHeader(filein, pos, format, size);
+    } catch (const std::exception& e) {
+        return error("%s: Read from block file failed: %s for %s", __func__, e.what(), pos.ToString());
+    }
+}
+
 bool BlockManager::WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValidationState& state, CBlockIndex& block)
 {
     AssertLockHeld(::cs_main);
@@ -996,23 +1214,14 @@ bool BlockManager::WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValid
         if (!FindUndoPos(state, block.nFile, _pos, ::GetSerializeSize(blockundo) + 40)) {
             return error("ConnectBlock(): FindUndoPos failed");
         }
-        if (!UndoWriteToDisk(blockundo, _pos, block.pprev->GetBlockHash())) {
-            return FatalError(m_opts.notifications, state, "Failed to write undo data");
-        }
+        UndoWriteToDisk(blockundo, _pos, block.pprev->GetBlockHash());
         // rev files are written in block height order, whereas blk files are written as blocks come in (often out of order)
         // we want to flush the rev (undo) file once we've written the last block, which is indicated by the last height
         // in the block file info as below; note that this does not catch the case where the undo writes are keeping up
         // with the block writes (usually when a synced up node is getting newly mined blocks) -- this case is caught in
         // the FindBlockPos function
         if (_pos.nFile < cursor.file_num && static_cast<uint32_t>(block.nHeight) == m_blockfile_info[_pos.nFile].nHeightLast) {
-            // Do not propagate the return code, a failed flush here should not
-            // be an indication for a failed write. If it were propagated here,
-            // the caller would assume the undo data not to be written, when in
-            // fact it is. Note though, that a failed flush might leave the data
-            // file untrimmed.
-            if (!FlushUndoFile(_pos.nFile, true)) {
-                LogPrintLevel(BCLog::BLOCKSTORAGE, BCLog::Level::Warning, "Failed to flush undo file %05i\n", _pos.nFile);
-            }
+            FlushUndoFile(_pos.nFile, true);
         } else if (_pos.nFile == cursor.file_num && block.nHeight > cursor.undo_height) {
             cursor.undo_height = block.nHeight;
         }
@@ -1025,19 +1234,34 @@ bool BlockManager::WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValid
     return true;
 }
 
-bool BlockManager::ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos) const
+bool BlockManager::ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, unsigned int* record_size) const
 {
     block.SetNull();
 
-    // Open history file to read
-    AutoFile filein{OpenBlockFile(pos, true)};
+    if (pos.nPos < BLOCK_SERIALIZATION_HEADER_SIZE) {
+        return error("ReadBlockFromDisk: No block record at %s", pos.ToString());
+    }
+    // Open history file to read, at the record header that tells the format of the block
+    FlatFilePos hpos{pos};
+    hpos.nPos -= BLOCK_SERIALIZATION_HEADER_SIZE;
+    AutoFile filein{OpenBlockFile(hpos, true)};
     if (filein.IsNull()) {
         return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
     }
 
     // Read block
     try {
-        filein >> TX_WITH_WITNESS(block);
+        BlockFormat format;
+        unsigned int size;
+        if (!ReadBlockRecordHeader(filein, pos, format, size)) {
+            return false;
+        }
+        if (record_size) *record_size = size;
+        if (format == BlockFormat::COMPACT_V1) {
+            filein >> Using<CompactBlockFormatter>(block);
+        } else {
+            filein >> TX_WITH_WITNESS(block);
+        }
     } catch (const std::exception& e) {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
     }
@@ -1050,11 +1274,74 @@ bool BlockManager::ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos) cons
     return true;
 }
 
-bool BlockManager::ReadBlockFromDisk(CBlock& block, const CBlockIndex& index) const
+bool BlockManager::ReadBlockHeaderColdData(const CBlockIndex& index, BlockHeaderColdData& cold) const
+{
+    {
+        LOCK(m_unwritten_headers_mutex);
+        const auto it{m_unwritten_headers.find(&index)};
+        if (it != m_unwritten_headers.end()) {
+            cold = it->second;
+            return true;
+        }
+        const auto unconnected{m_unconnected_headers.find(&index)};
+        if (unconnected != m_unconnected_headers.end()) {
+            cold = unconnected->second;
+            return true;
+        }
+    }
+    // Entries are only removed from m_unwritten_headers after they have been
+    // written, so the block tree database has them now.
+    CDiskBlockIndex diskindex;
+    if (!m_block_tree_db->ReadBlockIndex(index.GetBlockHash(), diskindex)) {
+        return false;
+    }
+    cold = diskindex;
+    return true;
+}
+
+bool BlockManager::ReadBlockHeader(CBlockHeader& header, const CBlockIndex& index) const
+{
+    BlockHeaderColdData cold;
+    if (!ReadBlockHeaderColdData(index, cold)) {
+        return error("%s: failed to read header of block %s", __func__, index.GetBlockHash().ToString());
+    }
+    header.nHeight = index.nHeight;
+    header.nVersion = index.nVersion;
+    header.hashPrevBlock = index.pprev ? index.pprev->GetBlockHash() : uint256{};
+    header.hashMix = cold.hashMix;
+    header.hashMerkleRoot = cold.hashMerkleRoot;
+    header.nTime = index.nTime;
+    header.nBits = index.nBits;
+    header.nNonce = cold.nNonce;
+    return true;
+}
+
+bool BlockManager::ReadBlockHeaders(Span<const CBlockIndex* const> blocks, std::vector<uint8_t>& out) const
+{
+    out.clear();
+    if (blocks.empty()) return true;
+    // Read the headers the store holds at once, and rebuild the rest
+    const int first_height{blocks.front()->nHeight};
+    size_t stored{std::min<size_t>(blocks.size(), std::max(m_header_store.Height() - first_height + 1, 0))};
+    if (stored > 0 && !m_header_store.Read(first_height, stored, blocks[stored - 1]->GetBlockHash(), out)) {
+        out.clear();
+        stored = 0;
+    }
+    out.reserve(blocks.size() * HeaderStore::HEADER_SIZE);
+    VectorWriter writer{out, out.size()};
+    for (const CBlockIndex* index : blocks.subspan(stored)) {
+        CBlockHeader header;
+        if (!ReadBlockHeader(header, *index)) return false;
+        writer << header;
+    }
+    return true;
+}
+
+bool BlockManager::ReadBlockFromDisk(CBlock& block, const CBlockIndex& index, unsigned int* record_size) const
 {
     const FlatFilePos block_pos{WITH_LOCK(cs_main, return index.GetBlockPos())};
 
-    if (!ReadBlockFromDisk(block, block_pos)) {
+    if (!ReadBlockFromDisk(block, block_pos, record_size)) {
         return false;
     }
     if (block.GetHash() != index.GetBlockHash()) {
@@ -1074,15 +1361,10 @@ bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatF
     }
 
     try {
-        MessageStartChars blk_start;
+        BlockFormat format;
         unsigned int blk_size;
-
-        filein >> blk_start >> blk_size;
-
-        if (blk_start != GetParams().MessageStart()) {
-            return error("%s: Block magic mismatch for %s: %s versus expected %s", __func__, pos.ToString(),
-                         HexStr(blk_start),
-                         HexStr(GetParams().MessageStart()));
+        if (!ReadBlockRecordHeader(filein, pos, format, blk_size)) {
+            return false;
         }
 
         if (blk_size > MAX_SIZE) {
@@ -1090,8 +1372,17 @@ bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatF
                          blk_size, MAX_SIZE);
         }
 
-        block.resize(blk_size); // Zeroing of memory is intentional here
-        filein.read(MakeWritableByteSpan(block));
+        if (format == BlockFormat::COMPACT_V1) {
+            // Blocks stored in compact form are served in network serialization
+            CBlock decoded;
+            filein >> Using<CompactBlockFormatter>(decoded);
+            block.clear();
+            block.reserve(GetSerializeSize(TX_WITH_WITNESS(decoded)));
+            VectorWriter{block, 0, TX_WITH_WITNESS(decoded)};
+        } else {
+            block.resize(blk_size); // Zeroing of memory is intentional here
+            filein.read(MakeWritableByteSpan(block));
+        }
     } catch (const std::exception& e) {
         return error("%s: Read from block file failed: %s for %s", __func__, e.what(), pos.ToString());
     }
@@ -1099,14 +1390,47 @@ bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatF
     return true;
 }
 
-FlatFilePos BlockManager::SaveBlockToDisk(const CBlock& block, int nHeight, const FlatFilePos* dbp)
+bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CBlockIndex& index) const
+{
+    const FlatFilePos block_pos{WITH_LOCK(cs_main, return index.GetBlockPos())};
+
+    if (!ReadRawBlockFromDisk(block, block_pos)) {
+        return false;
+    }
+    // The block hash is the hash of the header, which starts the serialization
+    CBlockHeader header;
+    try {
+        SpanReader{block} >> header;
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize header failed: %s for %s", __func__, e.what(), block_pos.ToString());
+    }
+    if (header.GetHash() != index.GetBlockHash()) {
+        return error("%s: GetHash() doesn't match index for %s at %s", __func__, index.ToString(), block_pos.ToString());
+    }
+    return true;
+}
+
+FlatFilePos BlockManager::SaveBlockToDisk(const CBlock& block, int nHeight, const FlatFilePos* dbp, unsigned int stored_size)
 {
-    unsigned int nBlockSize = ::GetSerializeSize(TX_WITH_WITNESS(block));
+    BlockFormat format{BlockFormat::NETWORK};
+    unsigned int nBlockSize = 0;
     FlatFilePos blockPos;
     const auto position_known {dbp != nullptr};
     if (position_known) {
         blockPos = *dbp;
+        // The block is stored already, in whichever format it was written
+        nBlockSize = stored_size;
+        if (nBlockSize == 0 && !ReadBlockRecordSize(blockPos, nBlockSize)) {
+            error("%s: failed to read the size of the block stored at %s", __func__, blockPos.ToString());
+            return FlatFilePos();
+        }
     } else {
+        if (m_opts.compact_block_files && CanStoreCompact(block)) {
+            format = BlockFormat::COMPACT_V1;
+            nBlockSize = ::GetSerializeSize(Using<CompactBlockFormatter>(block));
+        } else {
+            nBlockSize = ::GetSerializeSize(TX_WITH_WITNESS(block));
+        }
         // when known, blockPos.nPos points at the offset of the block data in the blk file. that already accounts for
         // the serialization header present in the file (the 4 magic message start bytes + the 4 length bytes = 8 bytes = BLOCK_SERIALIZATION_HEADER_SIZE).
         // we add BLOCK_SERIALIZATION_HEADER_SIZE only for new blocks since they will have the serialization header added when written to disk.
@@ -1117,10 +1441,7 @@ FlatFilePos BlockManager::SaveBlockToDisk(const CBlock& block, int nHeight, cons
         return FlatFilePos();
     }
     if (!position_known) {
-        if (!WriteBlockToDisk(block, blockPos)) {
-            m_opts.notifications.fatalError("Failed to write block");
-            return FlatFilePos();
-        }
+        WriteBlockToDisk(block, blockPos, format);
     }
     return blockPos;
 }
@@ -1207,6 +1528,17 @@ void ImportBlocks(ChainstateManager& chainman, std::vector<fs::path> vImportFile
             }
         }
     } // End scope of ImportingNow
+
+    // Check the header store against the active chain and fill it, a batch at
+    // a time so that cs_main is not held for long.
+    BlockManager& blockman{chainman.m_blockman};
+    const auto read_header{[&blockman](const CBlockIndex& index, CBlockHeader& header) {
+        return blockman.ReadBlockHeader(header, index);
+    }};
+    while (!WITH_LOCK(::cs_main, return blockman.m_header_store.Sync(chainman.ActiveChain(), HEADER_STORE_SYNC_BATCH, read_header))) {
+        if (chainman.m_interrupt) return;
+    }
+    LogPrintf("Header store synced at height %d\n", blockman.m_header_store.Height());
 }
 
 std::ostream& operator<<(std::ostream& os, const BlockfileType& type) {
@@ -14,7 +14,14 @@
 #include <kernel/chainparams.h>
 #include <kernel/cs_main.h>
 #include <kernel/messagestartchars.h>
+#include <node/blockformat.h>
+#include <node/blockmap.h>
+#include <node/blockwriter.h>
+#include <node/headerstore.h>
+#include <node/recentblocks.h>
+#include <node/sharedblockreader.h>
 #include <primitives/block.h>
+#include <span.h>
 #include <streams.h>
 #include <sync.h>
 #include <uint256.h>
@@ -52,7 +59,8 @@ class BlockTreeDB : public CDBWrapper
 {
 public:
     using CDBWrapper::CDBWrapper;
-    bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*>>& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo);
+    bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*>>& fileInfo, int nLastFile, const std::vector<std::pair<uint256, CDiskBlockIndex>>& blockinfo);
+    bool ReadBlockIndex(const uint256& hash, CDiskBlockIndex& diskindex) const;
     bool ReadBlockFileInfo(int nFile, CBlockFileInfo& info);
     bool ReadLastBlockFile(int& nFile);
     bool WriteReindexing(bool fReindexing);
@@ -74,17 +82,21 @@ static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
 /** The maximum size of a blk?????.dat file (since 0.8) */
 static const unsigned int MAX_BLOCKFILE_SIZE = 0x8000000; // 128 MiB
 
+/** The number of blocks to keep below the deepest prune lock.
+ *  There is nothing special about this number. It is higher than what we
+ *  expect to see in regular mainnet reorgs, but not so high that it would
+ *  noticeably interfere with the pruning mechanism.
+ * */
+static constexpr int PRUNE_LOCK_BUFFER{10};
+
+/** Maximum number of written block index entries whose cold header fields are kept in memory until their block is connected */
+static constexpr size_t MAX_UNCONNECTED_HEADERS{1 << 14};
+
 /** Size of header written by WriteBlockToDisk before a serialized CBlock */
 static constexpr size_t BLOCK_SERIALIZATION_HEADER_SIZE = std::tuple_size_v<MessageStartChars> + sizeof(unsigned int);
 
 extern std::atomic_bool fReindex;
 
-// Because validation code takes pointers to the map's CBlockIndex objects, if
-// we ever switch to another associative container, we need to either use a
-// container that has stable addressing (true of all std associative
-// containers), or make the key a `std::unique_ptr<CBlockIndex>`
-using BlockMap = std::unordered_map<uint256, CBlockIndex, BlockHasher>;
-
 struct CBlockIndexWorkComparator {
     bool operator()(const CBlockIndex* pa, const CBlockIndex* pb) const;
 };
@@ -98,6 +110,18 @@ struct PruneLockInfo {
     int height_first{std::numeric_limits<int>::max()}; //! Height of earliest block that should be kept and not pruned
 };
 
+/** Block files that pruning would remove, see BlockManager::PlanPruning(). */
+struct PrunePlan {
+    //! Block files to remove, in the order they are removed
+    std::vector<int> files;
+    //! Disk space used by block and undo files, before and after removing the files
+    uint64_t usage_before{0};
+    uint64_t usage_after{0};
+    //! Range of heights of the blocks that may be pruned
+    int min_height{0};
+    int max_height{0};
+};
+
 enum BlockfileType {
     // Values used as array indexes - do not change carelessly.
     NORMAL = 0,
@@ -150,13 +174,18 @@ private:
     bool LoadBlockIndex(const std::optional<uint256>& snapshot_blockhash)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
-    /** Return false if block file or undo file flushing fails. */
-    [[nodiscard]] bool FlushBlockFile(int blockfile_num, bool fFinalize, bool finalize_undo);
+    /** Queue a flush of a block file, and of its undo file unless it is finalized without finalize_undo. */
+    void FlushBlockFile(int blockfile_num, bool fFinalize, bool finalize_undo);
 
-    /** Return false if undo file flushing fails. */
-    [[nodiscard]] bool FlushUndoFile(int block_file, bool finalize = false);
+    /** Queue a flush of an undo file. */
+    void FlushUndoFile(int block_file, bool finalize = false);
 
     [[nodiscard]] bool FindBlockPos(FlatFilePos& pos, unsigned int nAddSize, unsigned int nHeight, uint64_t nTime, bool fKnown);
+    /**
+     * Flush the block and undo files the chainstate is writing to, and wait
+     * until all queued block and undo data is on disk. Return false if a
+     * write or flush failed.
+     */
     [[nodiscard]] bool FlushChainstateBlockFile(int tip_height);
     bool FindUndoPos(BlockValidationState& state, int nFile, FlatFilePos& pos, unsigned int nAddSize);
 
@@ -165,8 +194,10 @@ private:
 
     AutoFile OpenUndoFile(const FlatFilePos& pos, bool fReadOnly = false) const;
 
-    bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const;
-    bool UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const uint256& hashBlock) const;
+    /** Queue a block record for writing at pos, and point pos to its block data. */
+    void WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, BlockFormat format);
+    /** Queue an undo record for writing at pos, and point pos to its undo data. */
+    void UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const uint256& hashBlock);
 
     /* Calculate the block/rev files to delete based on height specified by user with RPC command pruneblockchain */
     void FindFilesToPruneManual(
@@ -200,6 +231,20 @@ private:
     RecursiveMutex cs_LastBlockFile;
     std::vector<CBlockFileInfo> m_blockfile_info;
 
+    /**
+     * Block files holding blocks, as (height of the last block, file number)
+     * pairs. Pruning removes files whose blocks are all deep enough, so it
+     * only visits the files with the lowest last heights instead of scanning
+     * all block files. Guarded by cs_LastBlockFile.
+     */
+    std::set<std::pair<unsigned int, int>> m_prune_candidates;
+
+    //! Update the pruning candidate entry of a block file whose last height was old_height_last
+    void UpdatePruneCandidate(int file, unsigned int old_height_last) EXCLUSIVE_LOCKS_REQUIRED(cs_LastBlockFile);
+
+    //! Mark block files as pruned (modify associated database entries)
+    void PruneBlockFiles(const std::vector<int>& files) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
     //! Since assumedvalid chainstates may be syncing a range of the chain that is very
     //! far away from the normal/background validation process, we should segment blockfiles
     //! for assumed chainstates. Otherwise, we might have wildly different height ranges
@@ -234,6 +279,26 @@ private:
     /** Dirty block index entries. */
     std::set<CBlockIndex*> m_dirty_blockindex;
 
+    mutable Mutex m_unwritten_headers_mutex;
+
+    /**
+     * Cold header fields of block index entries that have not been written to
+     * the block tree database yet. Entries are removed once written, after
+     * which the fields are read back from the database.
+     */
+    std::unordered_map<const CBlockIndex*, BlockHeaderColdData> m_unwritten_headers GUARDED_BY(m_unwritten_headers_mutex);
+
+    /**
+     * Cold header fields of written block index entries whose block is not
+     * connected yet. Those entries are written again once it is, which then
+     * does not need to read the fields back from the database. Holds at most
+     * MAX_UNCONNECTED_HEADERS entries.
+     */
+    std::unordered_map<const CBlockIndex*, BlockHeaderColdData> m_unconnected_headers GUARDED_BY(m_unwritten_headers_mutex);
+
+    bool ReadBlockHeaderColdData(const CBlockIndex& index, BlockHeaderColdData& cold) const
+        EXCLUSIVE_LOCKS_REQUIRED(!m_unwritten_headers_mutex);
+
     /** Dirty block file entries. */
     std::set<int> m_dirty_fileinfo;
 
@@ -249,12 +314,16 @@ private:
 
     const kernel::BlockManagerOpts m_opts;
 
+    //! Writes block and undo data off the validation thread
+    BlockFileWriter m_block_writer;
+
 public:
     using Options = kernel::BlockManagerOpts;
 
     explicit BlockManager(const util::SignalInterrupt& interrupt, Options opts)
         : m_prune_mode{opts.prune_target > 0},
           m_opts{std::move(opts)},
+          m_block_writer{BlockFileSeq(), UndoFileSeq(), m_opts.notifications},
           m_interrupt{interrupt} {};
 
     const util::SignalInterrupt& m_interrupt;
@@ -262,6 +331,15 @@ public:
 
     BlockMap m_block_index GUARDED_BY(cs_main);
 
+    //! Recently connected blocks, served to peers, REST and RPC from memory
+    RecentBlocks m_recent_blocks;
+
+    //! Headers of the active chain, read as ranges by REST and RPC
+    HeaderStore m_header_store{m_opts.blocks_dir / "headers.dat"};
+
+    //! Blocks and undo data read for the indexes, shared between them while they catch up
+    SharedBlockReader m_index_reader{*this, m_opts.index_reader_size.value_or(DEFAULT_SHARED_BLOCK_READER_SIZE)};
+
     /**
      * The height of the base block of an assumeutxo snapshot, if one is in use.
      *
@@ -278,6 +356,9 @@ public:
 
     std::vector<CBlockIndex*> GetAllBlockIndices() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
+    /** All block index entries ordered by height, sorted in linear time. */
+    std::vector<CBlockIndex*> GetAllBlockIndicesByHeight() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
     /**
      * All pairs A->B, where A (or one of its ancestors) misses transactions, but B has transactions.
      * Pruned nodes may have entries where B is missing data.
@@ -286,7 +367,7 @@ public:
 
     std::unique_ptr<BlockTreeDB> m_block_tree_db GUARDED_BY(::cs_main);
 
-    bool WriteBlockIndexDB() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    bool WriteBlockIndexDB() EXCLUSIVE_LOCKS_REQUIRED(::cs_main, !m_unwritten_headers_mutex);
     bool LoadBlockIndexDB(const std::optional<uint256>& snapshot_blockhash)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
@@ -297,13 +378,32 @@ public:
      */
     void ScanAndUnlinkAlreadyPrunedFiles() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
-    CBlockIndex* AddToBlockIndex(const CBlockHeader& block, CBlockIndex*& best_header) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    CBlockIndex* AddToBlockIndex(const CBlockHeader& block, CBlockIndex*& best_header) EXCLUSIVE_LOCKS_REQUIRED(cs_main, !m_unwritten_headers_mutex);
     /** Create a new block index entry for a given block hash */
     CBlockIndex* InsertBlockIndex(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     //! Mark one block file as pruned (modify associated database entries)
     void PruneOneBlockFile(const int fileNumber) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+     * Return the block files pruning would remove from chain, without
+     * removing them. With a target, files are removed until the block and
+     * undo files of each chainstate use less than its share of target bytes,
+     * as automatic pruning does. Without one, all files whose blocks are in
+     * the prunable range are, as manual pruning does.
+     *
+     * @param        last_prune        The last height we're able to prune, see GetLastPrunableHeight()
+     */
+    PrunePlan PlanPruning(std::optional<uint64_t> target, int last_prune, const Chainstate& chain, ChainstateManager& chainman)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /**
+     * Return the last height that can be pruned with a chain of chain_height,
+     * given the prune locks. limiting_lock is set to the name of the prune
+     * lock that limits it, if any.
+     */
+    int GetLastPrunableHeight(int chain_height, std::optional<std::string>& limiting_lock) const EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
     CBlockIndex* LookupBlockIndex(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     const CBlockIndex* LookupBlockIndex(const uint256& hash) const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
@@ -313,8 +413,13 @@ public:
     bool WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValidationState& state, CBlockIndex& block)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
-    /** Store block on disk. If dbp is not nullptr, then it provides the known position of the block within a block file on disk. */
-    FlatFilePos SaveBlockToDisk(const CBlock& block, int nHeight, const FlatFilePos* dbp);
+    /**
+     * Store block on disk. If dbp is not nullptr, then it provides the known
+     * position of the block within a block file on disk, and stored_size the
+     * size of its data there. A stored_size of 0 is read from the block
+     * record, and the block is not stored if that fails.
+     */
+    FlatFilePos SaveBlockToDisk(const CBlock& block, int nHeight, const FlatFilePos* dbp, unsigned int stored_size = 0);
 
     /** Whether running in -prune mode. */
     [[nodiscard]] bool IsPruneMode() const { return m_prune_mode; }
@@ -361,12 +466,41 @@ public:
      */
     void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune) const;
 
+    /** Unlink the specified files on the block file writer thread, after the data queued before. */
+    void UnlinkPrunedFilesInBackground(const std::set<int>& setFilesToPrune);
+
     /** Functions for disk access for blocks */
-    bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos) const;
-    bool ReadBlockFromDisk(CBlock& block, const CBlockIndex& index) const;
+    /** Read a block, and if record_size is set, the size of its data on disk */
+    bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, unsigned int* record_size = nullptr) const;
+    bool ReadBlockFromDisk(CBlock& block, const CBlockIndex& index, unsigned int* record_size = nullptr) const;
+    /** Rebuild the header of a block index entry, reading its cold fields from the block tree database if needed */
+    bool ReadBlockHeader(CBlockHeader& header, const CBlockIndex& index) const
+        EXCLUSIVE_LOCKS_REQUIRED(!m_unwritten_headers_mutex);
+    /**
+     * Read the serialized headers of consecutive blocks, with a single read
+     * from the header store for those it holds, and the others one at a time.
+     * Does not need cs_main, which callers should not hold when the blocks
+     * may be far from the tip.
+     */
+    bool ReadBlockHeaders(Span<const CBlockIndex* const> blocks, std::vector<uint8_t>& out) const
+        EXCLUSIVE_LOCKS_REQUIRED(!m_unwritten_headers_mutex);
+    /** Read a block in network serialization, re-encoding it if it is stored in another format */
     bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos) const;
-
-    bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex& index) const;
+    /** Read the block of index in network serialization, checking that it is the block of index */
+    bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CBlockIndex& index) const;
+    /**
+     * Read the header of the block record at pos, which is the position of the
+     * block data, from a file positioned BLOCK_SERIALIZATION_HEADER_SIZE bytes
+     * before it. Fails on a magic mismatch or an unknown block format.
+     */
+    bool ReadBlockRecordHeader(AutoFile& filein, const FlatFilePos& pos, BlockFormat& format, unsigned int& size) const;
+    /** Read the size of the block data at pos, in whichever format it is stored */
+    bool ReadBlockRecordSize(const FlatFilePos& pos, unsigned int& size) const;
+
+    /** Read undo data, and if record_size is set, the size of its data on disk */
+    bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex& index, unsigned int* record_size = nullptr) const;
+    /** Read undo data without cs_main, given its position and the hash of the block's parent */
+    bool UndoReadFromDisk(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& prev_hash, unsigned int* record_size = nullptr) const;
 
     void CleanupBlockRevFiles() const;
 };
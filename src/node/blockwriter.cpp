@@ -0,0 +1,205 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockwriter.h>
+
+#include <kernel/notifications_interface.h>
+#include <logging.h>
+#include <span.h>
+#include <streams.h>
+#include <util/fs.h>
+#include <util/thread.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <ios>
+#include <iterator>
+#include <set>
+#include <system_error>
+
+namespace node {
+BlockFileWriter::BlockFileWriter(FlatFileSeq block_files, FlatFileSeq undo_files, kernel::Notifications& notifications,
+                                 size_t max_queued_bytes)
+    : m_block_files{std::move(block_files)},
+      m_undo_files{std::move(undo_files)},
+      m_notifications{notifications},
+      m_max_queued_bytes{max_queued_bytes},
+      m_thread{&util::TraceThread, "blkwriter", [this] { ThreadWrite(); }}
+{
+}
+
+BlockFileWriter::~BlockFileWriter()
+{
+    WITH_LOCK(m_mutex, m_stop = true);
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+void BlockFileWriter::Write(FileType type, const FlatFilePos& pos, std::vector<uint8_t> data)
+{
+    const size_t size{data.size()};
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+            return m_queued_bytes == 0 || m_queued_bytes + size <= m_max_queued_bytes;
+        });
+        m_queued_bytes += size;
+        m_pending_writes[{type, pos.nFile}] = ++m_queued_count;
+        m_queue.push_back(Request{Action::WRITE, type, pos, std::move(data), /*finalize=*/false});
+    }
+    m_cv.notify_all();
+}
+
+void BlockFileWriter::Flush(FileType type, const FlatFilePos& pos, bool finalize)
+{
+    {
+        LOCK(m_mutex);
+        ++m_queued_count;
+        m_queue.push_back(Request{Action::FLUSH, type, pos, {}, finalize});
+    }
+    m_cv.notify_all();
+}
+
+void BlockFileWriter::Remove(int file)
+{
+    {
+        LOCK(m_mutex);
+        ++m_queued_count;
+        m_queue.push_back(Request{Action::REMOVE, FileType::BLOCK, FlatFilePos{file, 0}, {}, /*finalize=*/false});
+    }
+    m_cv.notify_all();
+}
+
+void BlockFileWriter::WaitForWrites(FileType type, int file) const
+{
+    WAIT_LOCK(m_mutex, lock);
+    const auto it{m_pending_writes.find({type, file})};
+    if (it == m_pending_writes.end()) return;
+    const uint64_t last_write{it->second};
+    m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_written_count >= last_write; });
+}
+
+bool BlockFileWriter::Sync()
+{
+    WAIT_LOCK(m_mutex, lock);
+    const uint64_t last_request{m_queued_count};
+    m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_done_count >= last_request; });
+    const bool success{!m_write_failed && !m_flush_failed};
+    m_flush_failed = false;
+    return success;
+}
+
+void BlockFileWriter::ThreadWrite()
+{
+    struct FileFlush {
+        FlatFilePos pos;
+        bool finalize{false};
+    };
+
+    for (;;) {
+        std::vector<Request> batch;
+        uint64_t last_request;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) return; // stopped and drained
+            batch.assign(std::make_move_iterator(m_queue.begin()), std::make_move_iterator(m_queue.end()));
+            m_queue.clear();
+            last_request = m_queued_count;
+        }
+
+        // Write the data in queue order, keeping each file open for the whole batch
+        size_t batch_bytes{0};
+        bool block_write_failed{false};
+        bool undo_write_failed{false};
+        std::map<FileKey, unsigned int> written_end;
+        std::map<FileKey, FileFlush> flushes;
+        std::set<int> removals;
+        {
+            std::map<FileKey, AutoFile> files;
+            for (const Request& request : batch) {
+                const FileKey key{request.type, request.pos.nFile};
+                if (request.action == Action::FLUSH) {
+                    FileFlush& flush{flushes[key]};
+                    flush.pos = request.pos;
+                    flush.finalize |= request.finalize;
+                    continue;
+                }
+                if (request.action == Action::REMOVE) {
+                    removals.insert(request.pos.nFile);
+                    continue;
+                }
+                batch_bytes += request.data.size();
+                auto it{files.find(key)};
+                if (it == files.end()) {
+                    it = files.try_emplace(key, FileSeq(request.type).Open(FlatFilePos{request.pos.nFile, 0})).first;
+                }
+                AutoFile& file{it->second};
+                try {
+                    if (file.IsNull()) throw std::ios_base::failure("cannot open file");
+                    if (std::fseek(file.Get(), request.pos.nPos, SEEK_SET)) throw std::ios_base::failure("fseek failed");
+                    file.write(MakeByteSpan(request.data));
+                    unsigned int& end{written_end[key]};
+                    end = std::max<unsigned int>(end, request.pos.nPos + request.data.size());
+                } catch (const std::exception& e) {
+                    LogPrintf("%s: failed to write %s: %s\n", __func__, request.pos.ToString(), e.what());
+                    (request.type == FileType::BLOCK ? block_write_failed : undo_write_failed) = true;
+                }
+            }
+            for (auto& [key, file] : files) {
+                if (file.fclose() != 0) {
+                    LogPrintf("%s: failed to close file %d\n", __func__, key.second);
+                    (key.first == FileType::BLOCK ? block_write_failed : undo_write_failed) = true;
+                }
+            }
+        }
+        {
+            LOCK(m_mutex);
+            m_written_count = last_request;
+            m_queued_bytes -= batch_bytes;
+            m_write_failed |= block_write_failed || undo_write_failed;
+            for (auto it{m_pending_writes.begin()}; it != m_pending_writes.end();) {
+                it = it->second <= last_request ? m_pending_writes.erase(it) : std::next(it);
+            }
+        }
+        m_cv.notify_all();
+        if (block_write_failed) m_notifications.fatalError("Failed to write block");
+        if (undo_write_failed) m_notifications.fatalError("Failed to write undo data");
+
+        // Commit each flushed file once. Data written after a flush request
+        // in the same batch is kept when the file is truncated. Files that
+        // are removed are not flushed, which would create them again.
+        bool flush_failed{false};
+        for (auto& [key, flush] : flushes) {
+            if (removals.count(key.second)) continue;
+            if (const auto it{written_end.find(key)}; it != written_end.end()) {
+                flush.pos.nPos = std::max(flush.pos.nPos, it->second);
+            }
+            if (!FileSeq(key.first).Flush(flush.pos, flush.finalize)) {
+                m_notifications.flushError(key.first == FileType::BLOCK ?
+                                               "Flushing block file to disk failed. This is likely the result of an I/O error." :
+                                               "Flushing undo file to disk failed. This is likely the result of an I/O error.");
+                flush_failed = true;
+            }
+        }
+        for (const int file : removals) {
+            std::error_code ec;
+            const FlatFilePos pos{file, 0};
+            const bool removed_blockfile{fs::remove(m_block_files.FileName(pos), ec)};
+            const bool removed_undofile{fs::remove(m_undo_files.FileName(pos), ec)};
+            if (removed_blockfile || removed_undofile) {
+                LogPrint(BCLog::BLOCKSTORAGE, "Prune: %s deleted blk/rev (%05u)\n", __func__, file);
+            }
+        }
+
+        {
+            LOCK(m_mutex);
+            m_done_count = last_request;
+            m_flush_failed |= flush_failed;
+        }
+        m_cv.notify_all();
+    }
+}
+} // namespace node
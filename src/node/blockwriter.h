@@ -0,0 +1,124 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_NODE_BLOCKWRITER_H
+#define BETGENIUS_NODE_BLOCKWRITER_H
+
+#include <flatfile.h>
+#include <sync.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace kernel {
+class Notifications;
+} // namespace kernel
+
+namespace node {
+//! Maximum amount of block and undo data queued for writing before writers wait
+static constexpr size_t MAX_QUEUED_BLOCK_WRITE_BYTES{64 << 20};
+
+/**
+ * Writes block and undo data to the block files on a dedicated thread.
+ *
+ * Data is queued already serialized, at a position reserved by the caller,
+ * so the caller only waits when the queue is full. The writer thread takes
+ * all queued requests at once, writes them, and then commits each file that
+ * was asked to be flushed with a single fsync. Flushes requested while a
+ * batch is being written are grouped into the next commit.
+ *
+ * Queued data is not in the files yet: readers call WaitForWrites() before
+ * opening a file. Sync() waits until all queued writes and flushes are done,
+ * so that data followed by a flush is on disk before the block index or the
+ * coins database are written to refer to it.
+ *
+ * Pruned files are removed by the writer too, after the writes and flushes
+ * queued before them.
+ *
+ * Write failures are reported as fatal errors, flush failures as flush
+ * errors, through the notifications interface.
+ */
+class BlockFileWriter
+{
+public:
+    enum class FileType : uint8_t {
+        BLOCK,
+        UNDO,
+    };
+
+    BlockFileWriter(FlatFileSeq block_files, FlatFileSeq undo_files, kernel::Notifications& notifications,
+                    size_t max_queued_bytes = MAX_QUEUED_BLOCK_WRITE_BYTES);
+    //! Write and commit the queued data, and stop the writer thread
+    ~BlockFileWriter();
+
+    BlockFileWriter(const BlockFileWriter&) = delete;
+    BlockFileWriter& operator=(const BlockFileWriter&) = delete;
+
+    /** Queue data to be written at pos, waiting while the queue is full. */
+    void Write(FileType type, const FlatFilePos& pos, std::vector<uint8_t> data) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Queue a commit of a file to disk, truncating it to pos.nPos if finalize is set. */
+    void Flush(FileType type, const FlatFilePos& pos, bool finalize) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Queue the removal of a block file and its undo file. */
+    void Remove(int file) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Wait until the data queued for a file has been written to it. */
+    void WaitForWrites(FileType type, int file) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Wait until all queued writes and flushes are done. Return false if a
+     * write ever failed, or if a flush failed since the previous call.
+     */
+    [[nodiscard]] bool Sync() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    using FileKey = std::pair<FileType, int>;
+
+    enum class Action : uint8_t {
+        WRITE,
+        FLUSH,
+        REMOVE,
+    };
+
+    struct Request {
+        Action action;
+        FileType type;
+        FlatFilePos pos;
+        std::vector<uint8_t> data;
+        bool finalize;
+    };
+
+    FlatFileSeq m_block_files;
+    FlatFileSeq m_undo_files;
+    kernel::Notifications& m_notifications;
+    const size_t m_max_queued_bytes;
+
+    mutable Mutex m_mutex;
+    mutable std::condition_variable m_cv;
+    std::deque<Request> m_queue GUARDED_BY(m_mutex);
+    size_t m_queued_bytes GUARDED_BY(m_mutex){0};
+    //! Number of requests queued, written and done (committed or removed) so far
+    uint64_t m_queued_count GUARDED_BY(m_mutex){0};
+    uint64_t m_written_count GUARDED_BY(m_mutex){0};
+    uint64_t m_done_count GUARDED_BY(m_mutex){0};
+    //! Number of the last queued write of each file with writes pending
+    std::map<FileKey, uint64_t> m_pending_writes GUARDED_BY(m_mutex);
+    bool m_write_failed GUARDED_BY(m_mutex){false};
+    bool m_flush_failed GUARDED_BY(m_mutex){false};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::thread m_thread;
+
+    FlatFileSeq& FileSeq(FileType type) { return type == FileType::BLOCK ? m_block_files : m_undo_files; }
+    void ThreadWrite() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+} // namespace node
+
+#endif // BETGENIUS_NODE_BLOCKWRITER_H
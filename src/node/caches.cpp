@@ -6,7 +6,12 @@
 #include <node/caches.h>
 
 #include <common/args.h>
+#include <index/addressindex.h>
+#include <index/blockstatsindex.h>
+#include <index/coinstatsindex.h>
+#include <index/spentindex.h>
 #include <index/txindex.h>
+#include <node/sharedblockreader.h>
 #include <txdb.h>
 
 namespace node {
@@ -20,16 +25,29 @@ CacheSizes CalculateCacheSizes(const ArgsManager& args, size_t n_indexes)
     nTotalCache -= sizes.block_tree_db;
     sizes.tx_index = std::min(nTotalCache / 8, args.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxTxIndexCache << 20 : 0);
     nTotalCache -= sizes.tx_index;
+    sizes.address_index = std::min(nTotalCache / 8, args.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX) ? nMaxTxIndexCache << 20 : 0);
+    nTotalCache -= sizes.address_index;
+    sizes.spent_index = std::min(nTotalCache / 8, args.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX) ? nMaxTxIndexCache << 20 : 0);
+    nTotalCache -= sizes.spent_index;
+    sizes.block_stats_index = std::min(nTotalCache / 8, args.GetBoolArg("-blockstatsindex", DEFAULT_BLOCKSTATSINDEX) ? max_filter_index_cache << 20 : 0);
+    nTotalCache -= sizes.block_stats_index;
     sizes.filter_index = 0;
     if (n_indexes > 0) {
         int64_t max_cache = std::min(nTotalCache / 8, max_filter_index_cache << 20);
         sizes.filter_index = max_cache / n_indexes;
         nTotalCache -= sizes.filter_index * n_indexes;
     }
+    sizes.index_reader = 0;
+    if (sizes.tx_index > 0 || sizes.address_index > 0 || sizes.spent_index > 0 || sizes.block_stats_index > 0 ||
+        sizes.filter_index > 0 || args.GetBoolArg("-coinstatsindex", DEFAULT_COINSTATSINDEX)) {
+        sizes.index_reader = std::min<int64_t>(nTotalCache / 8, DEFAULT_SHARED_BLOCK_READER_SIZE);
+        nTotalCache -= sizes.index_reader;
+    }
     sizes.coins_db = std::min(nTotalCache / 2, (nTotalCache / 4) + (1 << 23)); // use 25%-50% of the remainder for disk cache
     sizes.coins_db = std::min(sizes.coins_db, nMaxCoinsDBCache << 20); // cap total coins db cache
     nTotalCache -= sizes.coins_db;
     sizes.coins = nTotalCache; // the rest goes to in-memory cache
+    sizes.shared_block_cache = (sizes.block_tree_db + sizes.coins_db + sizes.tx_index + sizes.address_index + sizes.spent_index + sizes.block_stats_index + sizes.filter_index * n_indexes) / 2;
     return sizes;
 }
 } // namespace node
@@ -11,13 +11,24 @@
 
 class ArgsManager;
 
+//! -shareddbcache default
+static constexpr bool DEFAULT_SHARED_DB_CACHE{true};
+
 namespace node {
 struct CacheSizes {
     int64_t block_tree_db;
     int64_t coins_db;
     int64_t coins;
     int64_t tx_index;
+    int64_t address_index;
+    int64_t spent_index;
+    int64_t block_stats_index;
     int64_t filter_index;
+    //! Blocks and undo data shared by the indexes catching up
+    int64_t index_reader;
+    //! Budget of the block cache shared by all databases: the sum of their
+    //! private block caches (half of each database cache).
+    int64_t shared_block_cache;
 };
 CacheSizes CalculateCacheSizes(const ArgsManager& args, size_t n_indexes = 0);
 } // namespace node
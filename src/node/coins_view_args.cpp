@@ -7,6 +7,7 @@
 
 #include <common/args.h>
 #include <txdb.h>
+#include <util/fs.h>
 
 namespace node {
 void ReadCoinsViewArgs(const ArgsManager& args, CoinsViewOptions& options)
@@ -14,4 +15,14 @@ void ReadCoinsViewArgs(const ArgsManager& args, CoinsViewOptions& options)
     if (auto value = args.GetIntArg("-dbbatchsize")) options.batch_write_bytes = *value;
     if (auto value = args.GetIntArg("-dbcrashratio")) options.simulate_crash_ratio = *value;
 }
+
+bool ShouldPersistCoinsCache(const ArgsManager& args)
+{
+    return args.GetBoolArg("-persistcoinscache", DEFAULT_PERSIST_COINS_CACHE);
+}
+
+fs::path CoinsCachePath(const ArgsManager& args)
+{
+    return args.GetDataDirNet() / "coinscache.dat";
+}
 } // namespace node
@@ -6,11 +6,21 @@
 #ifndef BETGENIUS_NODE_COINS_VIEW_ARGS_H
 #define BETGENIUS_NODE_COINS_VIEW_ARGS_H
 
+#include <util/fs.h>
+
 class ArgsManager;
 struct CoinsViewOptions;
 
 namespace node {
+/**
+ * Default for -persistcoinscache, indicating whether the node should save the
+ * outpoints held in the coins cache on shutdown and reload them on start
+ */
+static constexpr bool DEFAULT_PERSIST_COINS_CACHE{false};
+
 void ReadCoinsViewArgs(const ArgsManager& args, CoinsViewOptions& options);
+bool ShouldPersistCoinsCache(const ArgsManager& args);
+fs::path CoinsCachePath(const ArgsManager& args);
 } // namespace node
 
 #endif // BETGENIUS_NODE_COINS_VIEW_ARGS_H
@@ -7,6 +7,7 @@
 
 #include <addrman.h>
 #include <banman.h>
+#include <dbwrapper.h>
 #include <interfaces/chain.h>
 #include <kernel/context.h>
 #include <net.h>
@@ -24,6 +24,7 @@ class CConnman;
 class CScheduler;
 class CTxMemPool;
 class ChainstateManager;
+class DBBlockCache;
 class NetGroupManager;
 class PeerManager;
 namespace interfaces {
@@ -61,6 +62,8 @@ struct NodeContext {
     std::unique_ptr<PeerManager> peerman;
     std::unique_ptr<ChainstateManager> chainman;
     std::unique_ptr<BanMan> banman;
+    //! LevelDB block cache shared by all databases, if enabled
+    std::shared_ptr<DBBlockCache> db_block_cache;
     ArgsManager* args{nullptr}; // Currently a raw pointer because the memory is not managed by this struct
     std::vector<BaseIndex*> indexes; // raw pointers because memory is not managed by this struct
     std::unique_ptr<interfaces::Chain> chain;
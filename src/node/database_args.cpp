@@ -6,8 +6,11 @@
 #include <node/database_args.h>
 
 #include <common/args.h>
+#include <common/system.h>
 #include <dbwrapper.h>
 
+#include <algorithm>
+
 namespace node {
 void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options)
 {
@@ -15,5 +18,9 @@ void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options)
     // databases), but it'd be easy to parse database-specific options by adding
     // a database_type string or enum parameter to this function.
     if (auto value = args.GetBoolArg("-forcecompactdb")) options.force_compact = *value;
+    if (auto value = args.GetIntArg("-dbcompactionthreads")) {
+        const int64_t threads{*value > 0 ? *value : GetNumCores()};
+        options.compaction_threads = std::clamp<int64_t>(threads, 1, MAX_DB_COMPACTION_THREADS);
+    }
 }
 } // namespace node
@@ -0,0 +1,177 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/headerstore.h>
+
+#include <chain.h>
+#include <logging.h>
+#include <primitives/block.h>
+#include <uint256.h>
+#include <util/fs_helpers.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+
+namespace node {
+int HeaderStore::Height() const
+{
+    LOCK(m_mutex);
+    return m_height;
+}
+
+void HeaderStore::Load()
+{
+    m_loaded = true;
+    FILE* file{fsbridge::fopen(m_path, "rb+")};
+    if (!file) file = fsbridge::fopen(m_path, "wb+");
+    m_file.emplace(file);
+    if (m_file->IsNull() || std::fseek(m_file->Get(), 0, SEEK_END)) {
+        Fail("open");
+        return;
+    }
+    const long size{std::ftell(m_file->Get())};
+    if (size < 0) {
+        Fail("open");
+        return;
+    }
+    m_file_height = static_cast<int>(size / HEADER_SIZE) - 1;
+    LogPrint(BCLog::BLOCKSTORAGE, "Header store: found %d headers in %s\n", m_file_height + 1, fs::PathToString(m_path));
+}
+
+void HeaderStore::Fail(const char* what)
+{
+    LogPrintf("Header store: %s failed, not using %s\n", what, fs::PathToString(m_path));
+    m_failed = true;
+    m_height = -1;
+    m_file_height = -1;
+    m_file.reset();
+}
+
+bool HeaderStore::Seek(int height) const
+{
+    return std::fseek(m_file->Get(), static_cast<long>(height) * HEADER_SIZE, SEEK_SET) == 0;
+}
+
+bool HeaderStore::WriteHeaders(int height, Span<const std::byte> data)
+{
+    try {
+        if (!Seek(height)) throw std::ios_base::failure("fseek failed");
+        m_file->write(data);
+    } catch (const std::exception& e) {
+        Fail("write");
+        return false;
+    }
+    m_height = m_file_height = height + static_cast<int>(data.size() / HEADER_SIZE) - 1;
+    return true;
+}
+
+bool HeaderStore::TruncateHeaders(int height)
+{
+    if (std::fflush(m_file->Get()) != 0 || !TruncateFile(m_file->Get(), static_cast<unsigned int>(height) * HEADER_SIZE)) {
+        Fail("truncate");
+        return false;
+    }
+    m_file_height = height - 1;
+    m_height = std::min(m_height, m_file_height);
+    return true;
+}
+
+bool HeaderStore::Sync(const CChain& chain, int max_count, const ReadHeaderFn& read_header)
+{
+    LOCK(m_mutex);
+    if (!m_loaded) Load();
+    if (m_failed) return true;
+
+    // Check the headers found in the file, up to the first one that is not in the chain
+    const int check_end{std::min(m_file_height, chain.Height())};
+    if (m_height < check_end) {
+        if (!Seek(m_height + 1)) {
+            Fail("read");
+            return true;
+        }
+        for (int count{0}; m_height < check_end; ++count) {
+            if (count == max_count) return false;
+            CBlockHeader header;
+            try {
+                *m_file >> header;
+            } catch (const std::exception& e) {
+                Fail("read");
+                return true;
+            }
+            if (header.GetHash() != chain[m_height + 1]->GetBlockHash()) break;
+            ++m_height;
+        }
+    }
+    if (m_file_height > m_height && !TruncateHeaders(m_height + 1)) return true;
+
+    // Append the missing headers
+    DataStream data;
+    const int append_end{std::min(chain.Height(), m_height + max_count)};
+    for (int height{m_height + 1}; height <= append_end; ++height) {
+        CBlockHeader header;
+        if (!read_header(*chain[height], header)) {
+            Fail("header lookup");
+            return true;
+        }
+        data << header;
+    }
+    if (!data.empty() && !WriteHeaders(m_height + 1, data)) return true;
+    return m_height == chain.Height();
+}
+
+void HeaderStore::Append(int height, const CBlockHeader& header)
+{
+    LOCK(m_mutex);
+    if (!m_loaded) Load();
+    if (m_failed || height > m_height + 1) return;
+    if (height > 0) {
+        // Read() only checks the last header of a range, so every header has
+        // to follow the stored one below it
+        CBlockHeader prev;
+        try {
+            if (!Seek(height - 1)) throw std::ios_base::failure("fseek failed");
+            *m_file >> prev;
+        } catch (const std::exception& e) {
+            Fail("read");
+            return;
+        }
+        if (prev.GetHash() != header.hashPrevBlock) {
+            LogPrintf("Header store: header at height %d does not follow the stored chain, emptying %s\n", height, fs::PathToString(m_path));
+            TruncateHeaders(0);
+            return;
+        }
+    }
+    if (m_file_height >= height && !TruncateHeaders(height)) return;
+    DataStream data;
+    data << header;
+    WriteHeaders(height, data);
+}
+
+void HeaderStore::Truncate(int height)
+{
+    LOCK(m_mutex);
+    if (!m_loaded) Load();
+    if (m_failed || m_file_height < height) return;
+    TruncateHeaders(height);
+}
+
+bool HeaderStore::Read(int height, size_t count, const uint256& last_hash, std::vector<uint8_t>& out) const
+{
+    LOCK(m_mutex);
+    if (height < 0 || count == 0 || height + static_cast<int64_t>(count) - 1 > m_height) return false;
+    out.resize(count * HEADER_SIZE);
+    try {
+        if (!Seek(height)) return false;
+        m_file->read(MakeWritableByteSpan(out));
+    } catch (const std::exception& e) {
+        LogPrintf("Header store: read failed: %s\n", e.what());
+        return false;
+    }
+    // Headers are only stored as a chain, so checking the last one checks them all
+    CBlockHeader last;
+    SpanReader{Span{out}.last(HEADER_SIZE)} >> last;
+    return last.GetHash() == last_hash;
+}
+} // namespace node
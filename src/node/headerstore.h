@@ -0,0 +1,103 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_NODE_HEADERSTORE_H
+#define BETGENIUS_NODE_HEADERSTORE_H
+
+#include <span.h>
+#include <streams.h>
+#include <sync.h>
+#include <util/fs.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+class CBlockHeader;
+class CBlockIndex;
+class CChain;
+class uint256;
+
+namespace node {
+//! Number of headers checked or appended per HeaderStore::Sync() call
+static constexpr int HEADER_STORE_SYNC_BATCH{2000};
+
+/**
+ * Headers of the active chain, serialized back to back in height order in a
+ * single file, so that a range of headers is read with a single read instead
+ * of being rebuilt one at a time from the block index and the block tree
+ * database.
+ *
+ * Connecting a block appends its header, and disconnecting one truncates the
+ * store, so a reorg only rewrites the affected tail. The file is not flushed:
+ * at startup, Sync() checks the headers found in the file against the active
+ * chain, drops the ones that do not match, and appends the missing ones.
+ * Until then, only the checked headers are served.
+ *
+ * The store is a cache. After an I/O error it is emptied and stops taking
+ * headers, and callers read headers the usual way.
+ */
+class HeaderStore
+{
+public:
+    //! Size of a serialized block header
+    static constexpr size_t HEADER_SIZE{120};
+
+    using ReadHeaderFn = std::function<bool(const CBlockIndex&, CBlockHeader&)>;
+
+    explicit HeaderStore(fs::path path) : m_path{std::move(path)} {}
+
+    //! Height of the last header that can be read, or -1 if there is none
+    int Height() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Check up to max_count stored headers against chain, or append up to
+     * max_count headers of chain read with read_header. Returns true once the
+     * store holds all of chain, or if the store failed.
+     */
+    bool Sync(const CChain& chain, int max_count, const ReadHeaderFn& read_header) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Store the header of the block at height, dropping the headers at and
+     * above it. Headers that do not follow the checked ones are ignored, and
+     * appended by Sync() instead. A header that does not link to the stored
+     * one below it empties the store, which Sync() refills at the next start.
+     */
+    void Append(int height, const CBlockHeader& header) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Drop the headers at height and above. */
+    void Truncate(int height) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Read count serialized headers starting at height into out. Fails if
+     * they cannot all be read, or if the last one is not the header of
+     * last_hash, so that a caller holding no lock never gets headers of
+     * another chain.
+     */
+    bool Read(int height, size_t count, const uint256& last_hash, std::vector<uint8_t>& out) const
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    const fs::path m_path;
+
+    mutable Mutex m_mutex;
+    mutable std::optional<AutoFile> m_file GUARDED_BY(m_mutex);
+    bool m_loaded GUARDED_BY(m_mutex){false};
+    bool m_failed GUARDED_BY(m_mutex){false};
+    //! Height of the last header that was checked against the active chain or appended
+    int m_height GUARDED_BY(m_mutex){-1};
+    //! Height of the last header in the file
+    int m_file_height GUARDED_BY(m_mutex){-1};
+
+    void Load() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void Fail(const char* what) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    bool Seek(int height) const EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    bool WriteHeaders(int height, Span<const std::byte> data) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    bool TruncateHeaders(int height) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
+} // namespace node
+
+#endif // BETGENIUS_NODE_HEADERSTORE_H
@@ -569,6 +569,46 @@ public:
         if (index == nullptr || !block_filter_index->LookupFilter(index, filter)) return std::nullopt;
         return filter.GetFilter().MatchAny(filter_set);
     }
+    std::vector<std::pair<uint256, std::optional<bool>>> blockFiltersMatchAny(BlockFilterType filter_type, const uint256& start_block, int max_count, const GCSFilter::ElementSet& filter_set) override
+    {
+        std::vector<std::pair<uint256, std::optional<bool>>> result;
+        const BlockFilterIndex* block_filter_index{GetBlockFilterIndex(filter_type)};
+        if (!block_filter_index) return result;
+
+        std::vector<const CBlockIndex*> blocks;
+        {
+            LOCK(::cs_main);
+            const CChain& active = chainman().ActiveChain();
+            const CBlockIndex* index{chainman().m_blockman.LookupBlockIndex(start_block)};
+            if (index == nullptr || !active.Contains(index)) return result;
+            for (; index && (int)blocks.size() < max_count; index = active.Next(index)) {
+                blocks.push_back(index);
+            }
+        }
+        if (blocks.empty()) return result;
+
+        // The range lookup fails as a whole if the index is missing any of
+        // the filters, as when it is behind the tip
+        std::vector<BlockFilter> filters;
+        std::vector<bool> found(blocks.size(), true);
+        if (!block_filter_index->LookupFilterRange(blocks.front()->nHeight, blocks.back(), filters)) {
+            filters.assign(blocks.size(), BlockFilter{});
+            for (size_t i = 0; i < blocks.size(); ++i) {
+                found[i] = block_filter_index->LookupFilter(blocks[i], filters[i]);
+            }
+        }
+        std::vector<const GCSFilter*> gcs_filters;
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            if (found[i]) gcs_filters.push_back(&filters[i].GetFilter());
+        }
+        const std::vector<bool> matches{GCSFilter::MatchAny(gcs_filters, filter_set)};
+
+        result.reserve(blocks.size());
+        for (size_t i = 0, match = 0; i < blocks.size(); ++i) {
+            result.emplace_back(blocks[i]->GetBlockHash(), found[i] ? std::make_optional<bool>(matches[match++]) : std::nullopt);
+        }
+        return result;
+    }
     bool findBlock(const uint256& hash, const FoundBlock& block) override
     {
         WAIT_LOCK(cs_main, lock);
@@ -0,0 +1,81 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/recentblocks.h>
+
+#include <primitives/block.h>
+#include <serialize.h>
+#include <streams.h>
+
+#include <utility>
+
+namespace node {
+RecentBlocks::Entry* RecentBlocks::Touch(const uint256& hash)
+{
+    AssertLockHeld(m_mutex);
+    for (auto it{m_entries.begin()}; it != m_entries.end(); ++it) {
+        if (it->hash == hash) {
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            return &m_entries.front();
+        }
+    }
+    return nullptr;
+}
+
+void RecentBlocks::Add(std::shared_ptr<const CBlock> block)
+{
+    const uint256 hash{block->GetHash()};
+    LOCK(m_mutex);
+    if (Touch(hash)) return;
+    if (m_max_blocks == 0) return;
+    if (m_entries.size() >= m_max_blocks) m_entries.pop_back();
+    m_entries.push_front(Entry{hash, std::move(block), nullptr, nullptr});
+}
+
+std::shared_ptr<const CBlock> RecentBlocks::GetBlock(const uint256& hash)
+{
+    LOCK(m_mutex);
+    const Entry* entry{Touch(hash)};
+    return entry ? entry->block : nullptr;
+}
+
+std::shared_ptr<const RecentBlocks::SerializedBlock> RecentBlocks::GetSerializedBlock(const uint256& hash, bool with_witness)
+{
+    std::shared_ptr<const CBlock> block;
+    {
+        LOCK(m_mutex);
+        const Entry* entry{Touch(hash)};
+        if (!entry) return nullptr;
+        const auto& serialized{with_witness ? entry->with_witness : entry->without_witness};
+        if (serialized) return serialized;
+        block = entry->block;
+    }
+
+    // Serialize without holding the lock. If another thread serialized the
+    // block in the meantime, the first serialization is kept.
+    auto serialized{std::make_shared<SerializedBlock>()};
+    if (with_witness) {
+        serialized->reserve(GetSerializeSize(TX_WITH_WITNESS(*block)));
+        VectorWriter{*serialized, 0, TX_WITH_WITNESS(*block)};
+    } else {
+        serialized->reserve(GetSerializeSize(TX_NO_WITNESS(*block)));
+        VectorWriter{*serialized, 0, TX_NO_WITNESS(*block)};
+    }
+
+    LOCK(m_mutex);
+    for (Entry& entry : m_entries) {
+        if (entry.hash != hash) continue;
+        auto& cached{with_witness ? entry.with_witness : entry.without_witness};
+        if (!cached) cached = serialized;
+        return cached;
+    }
+    // Evicted while serializing
+    return serialized;
+}
+
+size_t RecentBlocks::Size() const
+{
+    return WITH_LOCK(m_mutex, return m_entries.size());
+}
+} // namespace node
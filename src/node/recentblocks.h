@@ -0,0 +1,73 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_NODE_RECENTBLOCKS_H
+#define BETGENIUS_NODE_RECENTBLOCKS_H
+
+#include <sync.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+
+class CBlock;
+
+namespace node {
+//! Number of recently connected blocks kept in memory
+static constexpr size_t RECENT_BLOCKS_CACHE_SIZE{32};
+
+/**
+ * The most recently connected blocks, for serving them to peers, REST and
+ * RPC without reading them from disk.
+ *
+ * Blocks near the tip are requested far more often than older ones, by
+ * peers catching up and by explorers. Besides the block itself, its
+ * serialization with and without witness data is kept once it has been
+ * requested, so each form is serialized at most once. The least recently
+ * used block is evicted when the cache is full.
+ */
+class RecentBlocks
+{
+public:
+    using SerializedBlock = std::vector<uint8_t>;
+
+    explicit RecentBlocks(size_t max_blocks = RECENT_BLOCKS_CACHE_SIZE) : m_max_blocks{max_blocks} {}
+
+    /** Add a block, or mark it as recently used if it is in the cache already. */
+    void Add(std::shared_ptr<const CBlock> block) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Return the block with the given hash, or nullptr if it is not in the cache. */
+    std::shared_ptr<const CBlock> GetBlock(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Return the network serialization of the block with the given hash, or
+     * nullptr if it is not in the cache. The serialization is created on the
+     * first request and kept with the block.
+     */
+    std::shared_ptr<const SerializedBlock> GetSerializedBlock(const uint256& hash, bool with_witness) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Entry {
+        uint256 hash;
+        std::shared_ptr<const CBlock> block;
+        std::shared_ptr<const SerializedBlock> with_witness;
+        std::shared_ptr<const SerializedBlock> without_witness;
+    };
+
+    const size_t m_max_blocks;
+    mutable Mutex m_mutex;
+    //! Most recently used first. The cache is small enough to search linearly.
+    std::list<Entry> m_entries GUARDED_BY(m_mutex);
+
+    //! Find an entry and move it to the front
+    Entry* Touch(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
+} // namespace node
+
+#endif // BETGENIUS_NODE_RECENTBLOCKS_H
@@ -0,0 +1,104 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/sharedblockreader.h>
+
+#include <chain.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <undo.h>
+
+#include <cassert>
+#include <utility>
+
+namespace node {
+template <typename T, typename ReadFn>
+std::shared_ptr<const T> SharedBlockReader::Get(const uint256& hash, Read<T> Entry::*member, ReadFn read_fn)
+{
+    std::promise<std::shared_ptr<const T>> promise;
+    Read<T> shared;
+    unsigned int size{0};
+    bool keep{false};
+    {
+        LOCK(m_mutex);
+        // Unless an index is catching up, no other one is going to ask for it
+        if (m_syncing > 0) {
+            keep = true;
+            auto [it, inserted]{m_entries.try_emplace(hash)};
+            if (inserted) m_order.push_back(hash);
+            Read<T>& read{it->second.*member};
+            if (read.valid()) {
+                shared = read;
+            } else {
+                read = promise.get_future().share();
+            }
+        }
+    }
+    if (!keep) return read_fn(size);
+    // Read already, or being read by another thread
+    if (shared.valid()) return shared.get();
+
+    std::shared_ptr<const T> result{read_fn(size)};
+    promise.set_value(result);
+
+    LOCK(m_mutex);
+    const auto it{m_entries.find(hash)};
+    if (it == m_entries.end()) return result; // Evicted while reading
+    if (!result) {
+        // Let a later call try again
+        it->second.*member = {};
+        return result;
+    }
+    it->second.size += size;
+    m_size += size;
+    while (m_size > m_max_size && !m_order.empty()) {
+        const auto oldest{m_entries.find(m_order.front())};
+        if (oldest != m_entries.end()) {
+            m_size -= oldest->second.size;
+            m_entries.erase(oldest);
+        }
+        m_order.pop_front();
+    }
+    return result;
+}
+
+std::shared_ptr<const CBlock> SharedBlockReader::ReadBlock(const CBlockIndex& index)
+{
+    return Get<CBlock>(index.GetBlockHash(), &Entry::block, [&](unsigned int& size) -> std::shared_ptr<const CBlock> {
+        auto block{std::make_shared<CBlock>()};
+        if (!m_blockman.ReadBlockFromDisk(*block, index, &size)) return nullptr;
+        return block;
+    });
+}
+
+std::shared_ptr<const CBlockUndo> SharedBlockReader::ReadUndo(const CBlockIndex& index)
+{
+    return Get<CBlockUndo>(index.GetBlockHash(), &Entry::undo, [&](unsigned int& size) -> std::shared_ptr<const CBlockUndo> {
+        auto undo{std::make_shared<CBlockUndo>()};
+        if (!m_blockman.UndoReadFromDisk(*undo, index, &size)) return nullptr;
+        return undo;
+    });
+}
+
+size_t SharedBlockReader::Size() const
+{
+    return WITH_LOCK(m_mutex, return m_size);
+}
+
+void SharedBlockReader::BeginSync()
+{
+    LOCK(m_mutex);
+    ++m_syncing;
+}
+
+void SharedBlockReader::EndSync()
+{
+    LOCK(m_mutex);
+    assert(m_syncing > 0);
+    if (--m_syncing > 0) return;
+    m_entries.clear();
+    m_order.clear();
+    m_size = 0;
+}
+} // namespace node
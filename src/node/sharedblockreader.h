@@ -0,0 +1,87 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_NODE_SHAREDBLOCKREADER_H
+#define BETGENIUS_NODE_SHAREDBLOCKREADER_H
+
+#include <sync.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+
+class CBlock;
+class CBlockIndex;
+class CBlockUndo;
+
+namespace node {
+class BlockManager;
+
+//! On-disk size of the blocks and undo data kept for indexes catching up, at most
+static constexpr size_t DEFAULT_SHARED_BLOCK_READER_SIZE{64 << 20};
+
+/**
+ * Blocks and undo data read from disk for the indexes, shared between them.
+ *
+ * Indexes catching up at startup usually walk the same heights, each reading
+ * the block, and often the undo data, of every height. Reads going through
+ * this class are done once: an index asking for a block read by another one
+ * gets the same object, and one asking for a block being read waits for that
+ * read instead of starting its own. Reads are kept, oldest first out, up to a
+ * total size on disk, so that indexes at different heights each read the
+ * blocks the others are too far from to share.
+ *
+ * Reads are only kept while an index is catching up. Once the last one is
+ * synced, the reads kept are released and later reads go straight to disk.
+ */
+class SharedBlockReader
+{
+public:
+    explicit SharedBlockReader(const BlockManager& blockman, size_t max_size = DEFAULT_SHARED_BLOCK_READER_SIZE)
+        : m_blockman{blockman}, m_max_size{max_size} {}
+
+    /** Read a block, or return the one read already. Returns nullptr if it cannot be read. */
+    std::shared_ptr<const CBlock> ReadBlock(const CBlockIndex& index) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Read the undo data of a block, or return the one read already. Returns nullptr if it cannot be read. */
+    std::shared_ptr<const CBlockUndo> ReadUndo(const CBlockIndex& index) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    //! Size on disk of the reads kept
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Keep reads for an index starting to catch up. */
+    void BeginSync() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Stop keeping reads for an index done catching up, releasing them after the last one. */
+    void EndSync() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    template <typename T>
+    using Read = std::shared_future<std::shared_ptr<const T>>;
+
+    struct Entry {
+        Read<CBlock> block;
+        Read<CBlockUndo> undo;
+        size_t size{0};
+    };
+
+    const BlockManager& m_blockman;
+    const size_t m_max_size;
+    mutable Mutex m_mutex;
+    std::map<uint256, Entry> m_entries GUARDED_BY(m_mutex);
+    //! Hashes of the entries, oldest first
+    std::list<uint256> m_order GUARDED_BY(m_mutex);
+    size_t m_size GUARDED_BY(m_mutex){0};
+    //! Number of indexes catching up
+    int m_syncing GUARDED_BY(m_mutex){0};
+
+    template <typename T, typename ReadFn>
+    std::shared_ptr<const T> Get(const uint256& hash, Read<T> Entry::*member, ReadFn read_fn) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+} // namespace node
+
+#endif // BETGENIUS_NODE_SHAREDBLOCKREADER_H
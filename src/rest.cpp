@@ -15,10 +15,13 @@
 #include <chainparams.h>
 #include <core_io.h>
 #include <httpserver.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
 #include <index/txindex.h>
+#include <key_io.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
+#include <node/recentblocks.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
@@ -26,6 +29,7 @@
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
+#include <span.h>
 #include <streams.h>
 #include <sync.h>
 #include <txmempool.h>
@@ -35,7 +39,9 @@
 #include <validation.h>
 
 #include <any>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <univalue.h>
 
@@ -225,10 +231,10 @@ static bool rest_headers(const std::any& context,
     const CBlockIndex* tip = nullptr;
     std::vector<const CBlockIndex*> headers;
     headers.reserve(*parsed_count);
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    ChainstateManager& chainman = *maybe_chainman;
     {
-        ChainstateManager* maybe_chainman = GetChainman(context, req);
-        if (!maybe_chainman) return false;
-        ChainstateManager& chainman = *maybe_chainman;
         LOCK(cs_main);
         CChain& active_chain = chainman.ActiveChain();
         tip = active_chain.Tip();
@@ -242,34 +248,31 @@ static bool rest_headers(const std::any& context,
         }
     }
 
+    std::vector<uint8_t> raw_headers;
+    if (!chainman.m_blockman.ReadBlockHeaders(headers, raw_headers)) {
+        return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Failed to read block headers");
+    }
+
     switch (rf) {
     case RESTResponseFormat::BINARY: {
-        DataStream ssHeader{};
-        for (const CBlockIndex *pindex : headers) {
-            ssHeader << pindex->GetBlockHeader();
-        }
-
-        std::string binaryHeader = ssHeader.str();
         req->WriteHeader("Content-Type", "application/octet-stream");
-        req->WriteReply(HTTP_OK, binaryHeader);
+        req->WriteReply(HTTP_OK, MakeByteSpan(raw_headers));
         return true;
     }
 
     case RESTResponseFormat::HEX: {
-        DataStream ssHeader{};
-        for (const CBlockIndex *pindex : headers) {
-            ssHeader << pindex->GetBlockHeader();
-        }
-
-        std::string strHex = HexStr(ssHeader) + "\n";
+        std::string strHex = HexStr(raw_headers) + "\n";
         req->WriteHeader("Content-Type", "text/plain");
         req->WriteReply(HTTP_OK, strHex);
         return true;
     }
     case RESTResponseFormat::JSON: {
         UniValue jsonHeaders(UniValue::VARR);
-        for (const CBlockIndex *pindex : headers) {
-            jsonHeaders.push_back(blockheaderToJSON(*tip, *pindex));
+        SpanReader stream{raw_headers};
+        for (const CBlockIndex* pindex : headers) {
+            CBlockHeader header;
+            stream >> header;
+            jsonHeaders.push_back(blockheaderToJSON(*tip, *pindex, header));
         }
         std::string strJSON = jsonHeaders.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
@@ -296,7 +299,6 @@ static bool rest_block(const std::any& context,
     if (!ParseHashStr(hashStr, hash))
         return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
 
-    CBlock block;
     const CBlockIndex* pblockindex = nullptr;
     const CBlockIndex* tip = nullptr;
     ChainstateManager* maybe_chainman = GetChainman(context, req);
@@ -314,31 +316,49 @@ static bool rest_block(const std::any& context,
         }
     }
 
-    if (!chainman.m_blockman.ReadBlockFromDisk(block, *pblockindex)) {
-        return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+    // The block is stored in network serialization, so the binary and hex
+    // formats are served from the raw bytes without deserializing it. Recent
+    // blocks are served from memory.
+    std::shared_ptr<const CBlock> pblock;
+    std::shared_ptr<const node::RecentBlocks::SerializedBlock> serialized_block;
+    if (rf == RESTResponseFormat::JSON) {
+        pblock = chainman.m_blockman.m_recent_blocks.GetBlock(hash);
+    } else {
+        serialized_block = chainman.m_blockman.m_recent_blocks.GetSerializedBlock(hash, /*with_witness=*/true);
     }
+    std::vector<uint8_t> block_data;
+    if (!pblock && !serialized_block) {
+        if (!chainman.m_blockman.ReadRawBlockFromDisk(block_data, *pblockindex)) {
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        }
+    }
+    const Span<const uint8_t> block_bytes{serialized_block ? Span<const uint8_t>{*serialized_block} : Span<const uint8_t>{block_data}};
 
     switch (rf) {
     case RESTResponseFormat::BINARY: {
-        DataStream ssBlock;
-        ssBlock << TX_WITH_WITNESS(block);
-        std::string binaryBlock = ssBlock.str();
         req->WriteHeader("Content-Type", "application/octet-stream");
-        req->WriteReply(HTTP_OK, binaryBlock);
+        req->WriteReply(HTTP_OK, MakeByteSpan(block_bytes));
         return true;
     }
 
     case RESTResponseFormat::HEX: {
-        DataStream ssBlock;
-        ssBlock << TX_WITH_WITNESS(block);
-        std::string strHex = HexStr(ssBlock) + "\n";
+        std::string strHex = HexStr(block_bytes) + "\n";
         req->WriteHeader("Content-Type", "text/plain");
         req->WriteReply(HTTP_OK, strHex);
         return true;
     }
 
     case RESTResponseFormat::JSON: {
-        UniValue objBlock = blockToJSON(chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity);
+        if (!pblock) {
+            auto block{std::make_shared<CBlock>()};
+            try {
+                SpanReader{block_data} >> TX_WITH_WITNESS(*block);
+            } catch (const std::exception&) {
+                return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, hashStr + " could not be deserialized");
+            }
+            pblock = std::move(block);
+        }
+        UniValue objBlock = blockToJSON(chainman.m_blockman, *pblock, *tip, *pblockindex, tx_verbosity);
         std::string strJSON = objBlock.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
         req->WriteReply(HTTP_OK, strJSON);
@@ -645,6 +665,34 @@ static bool rest_deploymentinfo(const std::any& context, HTTPRequest* req, const
 
 }
 
+RPCHelpMan getindexinfo();
+
+static bool rest_indexinfo(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+
+    switch (rf) {
+    case RESTResponseFormat::JSON: {
+        JSONRPCRequest jsonRequest;
+        jsonRequest.context = context;
+        jsonRequest.params = UniValue(UniValue::VARR);
+        jsonRequest.params.push_back(UniValue{});
+        jsonRequest.params.push_back(true);
+        UniValue index_info = getindexinfo().HandleRequest(jsonRequest);
+        std::string str_json = index_info.write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, str_json);
+        return true;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+    }
+}
+
 static bool rest_mempool(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
 {
     if (!CheckWarmup(req))
@@ -1002,6 +1050,70 @@ static bool rest_blockhash_by_height(const std::any& context, HTTPRequest* req,
     }
 }
 
+static bool rest_address(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+    if (rf != RESTResponseFormat::JSON) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+
+    // Path is /rest/address/<history|utxos|balance>/<address>.json, and
+    // history and utxos take ?skip=<skip>&count=<count>
+    const std::vector<std::string> path = SplitString(param, '/');
+    if (path.size() != 2 || (path[0] != "history" && path[0] != "utxos" && path[0] != "balance")) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/address/<history|utxos|balance>/<address>.json");
+    }
+    std::string raw_skip, raw_count;
+    try {
+        raw_skip = req->GetQueryParameter("skip").value_or("0");
+        raw_count = req->GetQueryParameter("count").value_or(ToString(MAX_ADDRESS_OUTPUTS_RESULTS));
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    const auto skip{ToIntegral<size_t>(raw_skip)};
+    if (!skip.has_value()) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid skip: " + SanitizeString(raw_skip));
+    }
+    const auto count{ToIntegral<size_t>(raw_count)};
+    if (!count.has_value() || *count < 1 || *count > MAX_ADDRESS_OUTPUTS_RESULTS) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Output count is invalid or out of acceptable range (1-%u): %s", MAX_ADDRESS_OUTPUTS_RESULTS, SanitizeString(raw_count)));
+    }
+    const CTxDestination dest{DecodeDestination(path[1])};
+    if (!IsValidDestination(dest)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(path[1]));
+    }
+    if (!g_address_index) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Address index is not enabled");
+    }
+    if (!g_address_index->BlockUntilSyncedToCurrentChain()) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, "Address index is still syncing");
+    }
+    const uint256 script_hash{AddressIndex::ScriptHash(GetScriptForDestination(dest))};
+
+    UniValue result;
+    if (path[0] == "balance") {
+        AddressBalance balance;
+        if (!g_address_index->GetBalance(script_hash, balance)) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Failed to read address index");
+        }
+        result = AddressBalanceToJSON(balance);
+    } else {
+        std::vector<AddressOutput> outputs;
+        if (!g_address_index->FindOutputs(script_hash, outputs, /*unspent_only=*/path[0] == "utxos", *skip, *count)) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Failed to read address index");
+        }
+        result = UniValue{UniValue::VARR};
+        for (const AddressOutput& output : outputs) {
+            result.push_back(AddressOutputToJSON(output));
+        }
+    }
+    req->WriteHeader("Content-Type", "application/json");
+    req->WriteReply(HTTP_OK, result.write() + "\n");
+    return true;
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(const std::any& context, HTTPRequest* req, const std::string& strReq);
@@ -1017,7 +1129,9 @@ static const struct {
       {"/rest/getutxos", rest_getutxos},
       {"/rest/deploymentinfo/", rest_deploymentinfo},
       {"/rest/deploymentinfo", rest_deploymentinfo},
+      {"/rest/indexinfo", rest_indexinfo},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/address/", rest_address},
 };
 
 void StartREST(const std::any& context)
@@ -7,11 +7,13 @@
 #include <rpc/blockchain.h>
 
 #include <blockfilter.h>
+#include <blockstats.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <clientversion.h>
 #include <coins.h>
 #include <common/args.h>
+#include <common/system.h>
 #include <consensus/amount.h>
 #include <consensus/params.h>
 #include <consensus/validation.h>
@@ -19,9 +21,13 @@
 #include <deploymentinfo.h>
 #include <deploymentstatus.h>
 #include <hash.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
+#include <index/blockstatsindex.h>
 #include <index/coinstatsindex.h>
+#include <index/spentindex.h>
 #include <kernel/coinstats.h>
+#include <key_io.h>
 #include <logging/timer.h>
 #include <net.h>
 #include <net_processing.h>
@@ -42,7 +48,9 @@
 #include <univalue.h>
 #include <util/check.h>
 #include <util/fs.h>
+#include <util/hasher.h>
 #include <util/strencodings.h>
+#include <util/threadpool.h>
 #include <util/translation.h>
 #include <validation.h>
 #include <validationinterface.h>
@@ -51,15 +59,21 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <condition_variable>
+#include <exception>
+#include <future>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <unordered_set>
 
 using kernel::CCoinsStats;
 using kernel::CoinStatsHashType;
 
 using node::BlockManager;
 using node::NodeContext;
+using node::PrunePlan;
 using node::SnapshotMetadata;
 
 struct CUpdatedBlock
@@ -132,7 +146,7 @@ static const CBlockIndex* ParseHashOrHeight(const UniValue& param, ChainstateMan
     }
 }
 
-UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex)
+UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex, const CBlockHeader& header)
 {
     // Serialize passed information without accessing chain state of the active chain!
     AssertLockNotHeld(cs_main); // For performance reasons
@@ -145,11 +159,11 @@ UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex
     result.pushKV("height", blockindex.nHeight);
     result.pushKV("version", blockindex.nVersion);
     result.pushKV("versionHex", strprintf("%08x", blockindex.nVersion));
-    result.pushKV("hashMix", blockindex.hashMix.GetHex());
-    result.pushKV("merkleroot", blockindex.hashMerkleRoot.GetHex());
+    result.pushKV("hashMix", header.hashMix.GetHex());
+    result.pushKV("merkleroot", header.hashMerkleRoot.GetHex());
     result.pushKV("time", blockindex.nTime);
     result.pushKV("mediantime", blockindex.GetMedianTimePast());
-    result.pushKV("nonce", blockindex.nNonce);
+    result.pushKV("nonce", header.nNonce);
     result.pushKV("bits", strprintf("%08x", blockindex.nBits));
     result.pushKV("difficulty", GetDifficulty(blockindex));
     result.pushKV("chainwork", blockindex.nChainWork.GetHex());
@@ -164,7 +178,7 @@ UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex
 
 UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity)
 {
-    UniValue result = blockheaderToJSON(tip, blockindex);
+    UniValue result = blockheaderToJSON(tip, blockindex, block);
 
     result.pushKV("strippedsize", (int)::GetSerializeSize(TX_NO_WITNESS(block)));
     result.pushKV("size", (int)::GetSerializeSize(TX_WITH_WITNESS(block)));
@@ -552,8 +566,8 @@ static RPCHelpMan getblockheader()
 
     const CBlockIndex* pblockindex;
     const CBlockIndex* tip;
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
     {
-        ChainstateManager& chainman = EnsureAnyChainman(request.context);
         LOCK(cs_main);
         pblockindex = chainman.m_blockman.LookupBlockIndex(hash);
         tip = chainman.ActiveChain().Tip();
@@ -563,15 +577,19 @@ static RPCHelpMan getblockheader()
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
     }
 
+    std::vector<uint8_t> raw_header;
+    if (!chainman.m_blockman.ReadBlockHeaders(Span{&pblockindex, 1}, raw_header)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to read block header");
+    }
+
     if (!fVerbose)
     {
-        DataStream ssBlock{};
-        ssBlock << pblockindex->GetBlockHeader();
-        std::string strHex = HexStr(ssBlock);
-        return strHex;
+        return HexStr(raw_header);
     }
 
-    return blockheaderToJSON(*tip, *pblockindex);
+    CBlockHeader header;
+    SpanReader{raw_header} >> header;
+    return blockheaderToJSON(*tip, *pblockindex, header);
 },
     };
 }
@@ -586,6 +604,11 @@ static CBlock GetBlockChecked(BlockManager& blockman, const CBlockIndex& blockin
         }
     }
 
+    // Copying a recent block only copies references to its transactions
+    if (const auto recent_block{blockman.m_recent_blocks.GetBlock(blockindex.GetBlockHash())}) {
+        return *recent_block;
+    }
+
     if (!blockman.ReadBlockFromDisk(block, blockindex)) {
         // Block not found on disk. This could be because we have the block
         // header in our index but not yet have the block or did not accept the
@@ -736,6 +759,13 @@ static RPCHelpMan getblock()
         }
     }
 
+    if (verbosity <= 0) {
+        // Recent blocks are returned from their cached serialization
+        if (const auto serialized_block{chainman.m_blockman.m_recent_blocks.GetSerializedBlock(hash, /*with_witness=*/true)}) {
+            return HexStr(*serialized_block);
+        }
+    }
+
     const CBlock block{GetBlockChecked(chainman.m_blockman, *pblockindex)};
 
     if (verbosity <= 0) {
@@ -817,6 +847,87 @@ static RPCHelpMan pruneblockchain()
     };
 }
 
+static RPCHelpMan getpruneplan()
+{
+    return RPCHelpMan{"getpruneplan",
+                "\nReturn the block files that pruning to a target would remove, and the heights of their blocks, without removing anything.\n",
+                {
+                    {"target", RPCArg::Type::NUM, RPCArg::DefaultHint{"the -prune target"}, "The target size of the block and undo files in MiB"},
+                },
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::NUM, "target", "The target size in bytes"},
+                        {RPCResult::Type::NUM, "usage", "The current size of the block and undo files in bytes"},
+                        {RPCResult::Type::NUM, "usage_after", "The size of the block and undo files after pruning, in bytes"},
+                        {RPCResult::Type::NUM, "min_height", "The lowest height of the blocks that may be pruned"},
+                        {RPCResult::Type::NUM, "max_height", "The highest height of the blocks that may be pruned"},
+                        {RPCResult::Type::ARR, "files", "The block files that would be removed, in the order they are removed",
+                        {
+                            {RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::NUM, "file", "The number of the block file"},
+                                {RPCResult::Type::NUM, "blocks", "The number of blocks in the file"},
+                                {RPCResult::Type::NUM, "height_first", "The lowest height of a block in the file"},
+                                {RPCResult::Type::NUM, "height_last", "The highest height of a block in the file"},
+                                {RPCResult::Type::NUM, "size", "The size of the block file and its undo file in bytes"},
+                            }},
+                        }},
+                    }},
+                RPCExamples{
+                    HelpExampleCli("getpruneplan", "1000")
+            + HelpExampleRpc("getpruneplan", "1000")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    uint64_t target{chainman.m_blockman.GetPruneTarget()};
+    if (!request.params[0].isNull()) {
+        const int64_t target_mib{request.params[0].getInt<int64_t>()};
+        if (target_mib < 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative target.");
+        }
+        if (uint64_t(target_mib) > std::numeric_limits<uint64_t>::max() / 1024 / 1024) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Target is too large.");
+        }
+        target = uint64_t(target_mib) * 1024 * 1024;
+        if (target < MIN_DISK_SPACE_FOR_BLOCK_FILES) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Target is below the minimum of %d MiB.", MIN_DISK_SPACE_FOR_BLOCK_FILES / 1024 / 1024));
+        }
+    } else if (!chainman.m_blockman.IsPruneMode()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "A target is required when the node is not in prune mode.");
+    }
+
+    LOCK(cs_main);
+    Chainstate& active_chainstate = chainman.ActiveChainstate();
+    std::optional<std::string> limiting_lock;
+    const int last_prune{chainman.m_blockman.GetLastPrunableHeight(active_chainstate.m_chain.Height(), limiting_lock)};
+    const PrunePlan plan{chainman.m_blockman.PlanPruning(target, last_prune, active_chainstate, chainman)};
+
+    UniValue files{UniValue::VARR};
+    for (const int file : plan.files) {
+        const CBlockFileInfo& info{*chainman.m_blockman.GetBlockFileInfo(file)};
+        UniValue entry{UniValue::VOBJ};
+        entry.pushKV("file", file);
+        entry.pushKV("blocks", uint64_t{info.nBlocks});
+        entry.pushKV("height_first", uint64_t{info.nHeightFirst});
+        entry.pushKV("height_last", uint64_t{info.nHeightLast});
+        entry.pushKV("size", uint64_t{info.nSize} + info.nUndoSize);
+        files.push_back(std::move(entry));
+    }
+
+    UniValue result{UniValue::VOBJ};
+    result.pushKV("target", target);
+    result.pushKV("usage", plan.usage_before);
+    result.pushKV("usage_after", plan.usage_after);
+    result.pushKV("min_height", plan.min_height);
+    result.pushKV("max_height", plan.max_height);
+    result.pushKV("files", std::move(files));
+    return result;
+},
+    };
+}
+
 CoinStatsHashType ParseHashType(const std::string& hash_type_input)
 {
     if (hash_type_input == "hash_serialized_3") {
@@ -1678,62 +1789,117 @@ static RPCHelpMan getchaintxstats()
     };
 }
 
-template<typename T>
-static T CalculateTruncatedMedian(std::vector<T>& scores)
+static std::vector<RPCResult> BlockStatsDoc()
 {
-    size_t size = scores.size();
-    if (size == 0) {
-        return 0;
-    }
-
-    std::sort(scores.begin(), scores.end());
-    if (size % 2 == 0) {
-        return (scores[size / 2 - 1] + scores[size / 2]) / 2;
-    } else {
-        return scores[size / 2];
-    }
+    return {
+        {RPCResult::Type::NUM, "avgfee", /*optional=*/true, "Average fee in the block"},
+        {RPCResult::Type::NUM, "avgfeerate", /*optional=*/true, "Average feerate (in satoshis per virtual byte)"},
+        {RPCResult::Type::NUM, "avgtxsize", /*optional=*/true, "Average transaction size"},
+        {RPCResult::Type::STR_HEX, "blockhash", /*optional=*/true, "The block hash (to check for potential reorgs)"},
+        {RPCResult::Type::ARR_FIXED, "feerate_percentiles", /*optional=*/true, "Feerates at the 10th, 25th, 50th, 75th, and 90th percentile weight unit (in satoshis per virtual byte)",
+        {
+            {RPCResult::Type::NUM, "10th_percentile_feerate", "The 10th percentile feerate"},
+            {RPCResult::Type::NUM, "25th_percentile_feerate", "The 25th percentile feerate"},
+            {RPCResult::Type::NUM, "50th_percentile_feerate", "The 50th percentile feerate"},
+            {RPCResult::Type::NUM, "75th_percentile_feerate", "The 75th percentile feerate"},
+            {RPCResult::Type::NUM, "90th_percentile_feerate", "The 90th percentile feerate"},
+        }},
+        {RPCResult::Type::NUM, "height", /*optional=*/true, "The height of the block"},
+        {RPCResult::Type::NUM, "ins", /*optional=*/true, "The number of inputs (excluding coinbase)"},
+        {RPCResult::Type::NUM, "maxfee", /*optional=*/true, "Maximum fee in the block"},
+        {RPCResult::Type::NUM, "maxfeerate", /*optional=*/true, "Maximum feerate (in satoshis per virtual byte)"},
+        {RPCResult::Type::NUM, "maxtxsize", /*optional=*/true, "Maximum transaction size"},
+        {RPCResult::Type::NUM, "medianfee", /*optional=*/true, "Truncated median fee in the block"},
+        {RPCResult::Type::NUM, "mediantime", /*optional=*/true, "The block median time past"},
+        {RPCResult::Type::NUM, "mediantxsize", /*optional=*/true, "Truncated median transaction size"},
+        {RPCResult::Type::NUM, "minfee", /*optional=*/true, "Minimum fee in the block"},
+        {RPCResult::Type::NUM, "minfeerate", /*optional=*/true, "Minimum feerate (in satoshis per virtual byte)"},
+        {RPCResult::Type::NUM, "mintxsize", /*optional=*/true, "Minimum transaction size"},
+        {RPCResult::Type::NUM, "outs", /*optional=*/true, "The number of outputs"},
+        {RPCResult::Type::NUM, "subsidy", /*optional=*/true, "The block subsidy"},
+        {RPCResult::Type::NUM, "swtotal_size", /*optional=*/true, "Total size of all segwit transactions"},
+        {RPCResult::Type::NUM, "swtotal_weight", /*optional=*/true, "Total weight of all segwit transactions"},
+        {RPCResult::Type::NUM, "swtxs", /*optional=*/true, "The number of segwit transactions"},
+        {RPCResult::Type::NUM, "time", /*optional=*/true, "The block time"},
+        {RPCResult::Type::NUM, "total_out", /*optional=*/true, "Total amount in all outputs (excluding coinbase and thus reward [ie subsidy + totalfee])"},
+        {RPCResult::Type::NUM, "total_size", /*optional=*/true, "Total size of all non-coinbase transactions"},
+        {RPCResult::Type::NUM, "total_weight", /*optional=*/true, "Total weight of all non-coinbase transactions"},
+        {RPCResult::Type::NUM, "totalfee", /*optional=*/true, "The fee total"},
+        {RPCResult::Type::NUM, "txs", /*optional=*/true, "The number of transactions (including coinbase)"},
+        {RPCResult::Type::NUM, "utxo_increase", /*optional=*/true, "The increase/decrease in the number of unspent outputs (not discounting op_return and similar)"},
+        {RPCResult::Type::NUM, "utxo_size_inc", /*optional=*/true, "The increase/decrease in size for the utxo index (not discounting op_return and similar)"},
+        {RPCResult::Type::NUM, "utxo_increase_actual", /*optional=*/true, "The increase/decrease in the number of unspent outputs, not counting unspendables"},
+        {RPCResult::Type::NUM, "utxo_size_inc_actual", /*optional=*/true, "The increase/decrease in size for the utxo index, not counting unspendables"},
+    };
 }
 
-void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight)
+/** Block statistics to JSON, with the fields named in stats, or all of them if it is empty */
+static UniValue BlockStatsToJSON(const BlockStats& block_stats, const CBlockIndex& pindex, const Consensus::Params& consensus, const std::set<std::string>& stats)
 {
-    if (scores.empty()) {
-        return;
+    UniValue feerates_res(UniValue::VARR);
+    for (const CAmount feerate : block_stats.feerate_percentiles) {
+        feerates_res.push_back(feerate);
     }
 
-    std::sort(scores.begin(), scores.end());
-
-    // 10th, 25th, 50th, 75th, and 90th percentile weight units.
-    const double weights[NUM_GETBLOCKSTATS_PERCENTILES] = {
-        total_weight / 10.0, total_weight / 4.0, total_weight / 2.0, (total_weight * 3.0) / 4.0, (total_weight * 9.0) / 10.0
-    };
-
-    int64_t next_percentile_index = 0;
-    int64_t cumulative_weight = 0;
-    for (const auto& element : scores) {
-        cumulative_weight += element.second;
-        while (next_percentile_index < NUM_GETBLOCKSTATS_PERCENTILES && cumulative_weight >= weights[next_percentile_index]) {
-            result[next_percentile_index] = element.first;
-            ++next_percentile_index;
-        }
+    UniValue ret_all(UniValue::VOBJ);
+    ret_all.pushKV("avgfee", block_stats.AvgFee());
+    ret_all.pushKV("avgfeerate", block_stats.AvgFeeRate()); // Unit: sat/vbyte
+    ret_all.pushKV("avgtxsize", block_stats.AvgTxSize());
+    ret_all.pushKV("blockhash", pindex.GetBlockHash().GetHex());
+    ret_all.pushKV("feerate_percentiles", feerates_res);
+    ret_all.pushKV("height", (int64_t)pindex.nHeight);
+    ret_all.pushKV("ins", block_stats.ins);
+    ret_all.pushKV("maxfee", block_stats.maxfee);
+    ret_all.pushKV("maxfeerate", block_stats.maxfeerate);
+    ret_all.pushKV("maxtxsize", block_stats.maxtxsize);
+    ret_all.pushKV("medianfee", block_stats.medianfee);
+    ret_all.pushKV("mediantime", pindex.GetMedianTimePast());
+    ret_all.pushKV("mediantxsize", block_stats.mediantxsize);
+    ret_all.pushKV("minfee", block_stats.minfee);
+    ret_all.pushKV("minfeerate", block_stats.minfeerate);
+    ret_all.pushKV("mintxsize", block_stats.mintxsize);
+    ret_all.pushKV("outs", block_stats.outs);
+    ret_all.pushKV("subsidy", GetBlockSubsidy(pindex.nHeight, consensus));
+    ret_all.pushKV("swtotal_size", block_stats.swtotal_size);
+    ret_all.pushKV("swtotal_weight", block_stats.swtotal_weight);
+    ret_all.pushKV("swtxs", block_stats.swtxs);
+    ret_all.pushKV("time", pindex.GetBlockTime());
+    ret_all.pushKV("total_out", block_stats.total_out);
+    ret_all.pushKV("total_size", block_stats.total_size);
+    ret_all.pushKV("total_weight", block_stats.total_weight);
+    ret_all.pushKV("totalfee", block_stats.totalfee);
+    ret_all.pushKV("txs", block_stats.txs);
+    ret_all.pushKV("utxo_increase", block_stats.outs - block_stats.ins);
+    ret_all.pushKV("utxo_size_inc", block_stats.utxo_size_inc);
+    ret_all.pushKV("utxo_increase_actual", block_stats.utxos - block_stats.ins);
+    ret_all.pushKV("utxo_size_inc_actual", block_stats.utxo_size_inc_actual);
+
+    if (stats.empty()) {
+        return ret_all;
     }
 
-    // Fill any remaining percentiles with the last value.
-    for (int64_t i = next_percentile_index; i < NUM_GETBLOCKSTATS_PERCENTILES; i++) {
-        result[i] = scores.back().first;
+    UniValue ret(UniValue::VOBJ);
+    for (const std::string& stat : stats) {
+        const UniValue& value = ret_all[stat];
+        if (value.isNull()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid selected statistic '%s'", stat));
+        }
+        ret.pushKV(stat, value);
     }
+    return ret;
 }
 
-template<typename T>
-static inline bool SetHasKeys(const std::set<T>& set) {return false;}
-template<typename T, typename Tk, typename... Args>
-static inline bool SetHasKeys(const std::set<T>& set, const Tk& key, const Args&... args)
+static std::set<std::string> ParseSelectedStats(const UniValue& param)
 {
-    return (set.count(key) != 0) || SetHasKeys(set, args...);
+    std::set<std::string> stats;
+    if (!param.isNull()) {
+        for (const UniValue& stat : param.get_array().getValues()) {
+            stats.insert(stat.get_str());
+        }
+    }
+    return stats;
 }
 
-// outpoint (needed for the utxo index) + nHeight + fCoinBase
-static constexpr size_t PER_UTXO_OVERHEAD = sizeof(COutPoint) + sizeof(uint32_t) + sizeof(bool);
-
 static RPCHelpMan getblockstats()
 {
     return RPCHelpMan{"getblockstats",
@@ -1752,48 +1918,7 @@ static RPCHelpMan getblockstats()
                         },
                         RPCArgOptions{.oneline_description="stats"}},
                 },
-                RPCResult{
-            RPCResult::Type::OBJ, "", "",
-            {
-                {RPCResult::Type::NUM, "avgfee", /*optional=*/true, "Average fee in the block"},
-                {RPCResult::Type::NUM, "avgfeerate", /*optional=*/true, "Average feerate (in satoshis per virtual byte)"},
-                {RPCResult::Type::NUM, "avgtxsize", /*optional=*/true, "Average transaction size"},
-                {RPCResult::Type::STR_HEX, "blockhash", /*optional=*/true, "The block hash (to check for potential reorgs)"},
-                {RPCResult::Type::ARR_FIXED, "feerate_percentiles", /*optional=*/true, "Feerates at the 10th, 25th, 50th, 75th, and 90th percentile weight unit (in satoshis per virtual byte)",
-                {
-                    {RPCResult::Type::NUM, "10th_percentile_feerate", "The 10th percentile feerate"},
-                    {RPCResult::Type::NUM, "25th_percentile_feerate", "The 25th percentile feerate"},
-                    {RPCResult::Type::NUM, "50th_percentile_feerate", "The 50th percentile feerate"},
-                    {RPCResult::Type::NUM, "75th_percentile_feerate", "The 75th percentile feerate"},
-                    {RPCResult::Type::NUM, "90th_percentile_feerate", "The 90th percentile feerate"},
-                }},
-                {RPCResult::Type::NUM, "height", /*optional=*/true, "The height of the block"},
-                {RPCResult::Type::NUM, "ins", /*optional=*/true, "The number of inputs (excluding coinbase)"},
-                {RPCResult::Type::NUM, "maxfee", /*optional=*/true, "Maximum fee in the block"},
-                {RPCResult::Type::NUM, "maxfeerate", /*optional=*/true, "Maximum feerate (in satoshis per virtual byte)"},
-                {RPCResult::Type::NUM, "maxtxsize", /*optional=*/true, "Maximum transaction size"},
-                {RPCResult::Type::NUM, "medianfee", /*optional=*/true, "Truncated median fee in the block"},
-                {RPCResult::Type::NUM, "mediantime", /*optional=*/true, "The block median time past"},
-                {RPCResult::Type::NUM, "mediantxsize", /*optional=*/true, "Truncated median transaction size"},
-                {RPCResult::Type::NUM, "minfee", /*optional=*/true, "Minimum fee in the block"},
-                {RPCResult::Type::NUM, "minfeerate", /*optional=*/true, "Minimum feerate (in satoshis per virtual byte)"},
-                {RPCResult::Type::NUM, "mintxsize", /*optional=*/true, "Minimum transaction size"},
-                {RPCResult::Type::NUM, "outs", /*optional=*/true, "The number of outputs"},
-                {RPCResult::Type::NUM, "subsidy", /*optional=*/true, "The block subsidy"},
-                {RPCResult::Type::NUM, "swtotal_size", /*optional=*/true, "Total size of all segwit transactions"},
-                {RPCResult::Type::NUM, "swtotal_weight", /*optional=*/true, "Total weight of all segwit transactions"},
-                {RPCResult::Type::NUM, "swtxs", /*optional=*/true, "The number of segwit transactions"},
-                {RPCResult::Type::NUM, "time", /*optional=*/true, "The block time"},
-                {RPCResult::Type::NUM, "total_out", /*optional=*/true, "Total amount in all outputs (excluding coinbase and thus reward [ie subsidy + totalfee])"},
-                {RPCResult::Type::NUM, "total_size", /*optional=*/true, "Total size of all non-coinbase transactions"},
-                {RPCResult::Type::NUM, "total_weight", /*optional=*/true, "Total weight of all non-coinbase transactions"},
-                {RPCResult::Type::NUM, "totalfee", /*optional=*/true, "The fee total"},
-                {RPCResult::Type::NUM, "txs", /*optional=*/true, "The number of transactions (including coinbase)"},
-                {RPCResult::Type::NUM, "utxo_increase", /*optional=*/true, "The increase/decrease in the number of unspent outputs (not discounting op_return and similar)"},
-                {RPCResult::Type::NUM, "utxo_size_inc", /*optional=*/true, "The increase/decrease in size for the utxo index (not discounting op_return and similar)"},
-                {RPCResult::Type::NUM, "utxo_increase_actual", /*optional=*/true, "The increase/decrease in the number of unspent outputs, not counting unspendables"},
-                {RPCResult::Type::NUM, "utxo_size_inc_actual", /*optional=*/true, "The increase/decrease in size for the utxo index, not counting unspendables"},
-            }},
+                RPCResult{RPCResult::Type::OBJ, "", "", BlockStatsDoc()},
                 RPCExamples{
                     HelpExampleCli("getblockstats", R"('"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09"' '["minfeerate","avgfeerate"]')") +
                     HelpExampleCli("getblockstats", R"(1000 '["minfeerate","avgfeerate"]')") +
@@ -1804,187 +1929,84 @@ static RPCHelpMan getblockstats()
 {
     ChainstateManager& chainman = EnsureAnyChainman(request.context);
     const CBlockIndex& pindex{*CHECK_NONFATAL(ParseHashOrHeight(request.params[0], chainman))};
+    const std::set<std::string> stats{ParseSelectedStats(request.params[1])};
 
-    std::set<std::string> stats;
-    if (!request.params[1].isNull()) {
-        const UniValue stats_univalue = request.params[1].get_array();
-        for (unsigned int i = 0; i < stats_univalue.size(); i++) {
-            const std::string stat = stats_univalue[i].get_str();
-            stats.insert(stat);
-        }
-    }
-
-    const CBlock& block = GetBlockChecked(chainman.m_blockman, pindex);
-    const CBlockUndo& blockUndo = GetUndoChecked(chainman.m_blockman, pindex);
-
-    const bool do_all = stats.size() == 0; // Calculate everything if nothing selected (default)
-    const bool do_mediantxsize = do_all || stats.count("mediantxsize") != 0;
-    const bool do_medianfee = do_all || stats.count("medianfee") != 0;
-    const bool do_feerate_percentiles = do_all || stats.count("feerate_percentiles") != 0;
-    const bool loop_inputs = do_all || do_medianfee || do_feerate_percentiles ||
-        SetHasKeys(stats, "utxo_increase", "utxo_increase_actual", "utxo_size_inc", "utxo_size_inc_actual", "totalfee", "avgfee", "avgfeerate", "minfee", "maxfee", "minfeerate", "maxfeerate");
-    const bool loop_outputs = do_all || loop_inputs || stats.count("total_out");
-    const bool do_calculate_size = do_mediantxsize ||
-        SetHasKeys(stats, "total_size", "avgtxsize", "mintxsize", "maxtxsize", "swtotal_size");
-    const bool do_calculate_weight = do_all || SetHasKeys(stats, "total_weight", "avgfeerate", "swtotal_weight", "avgfeerate", "feerate_percentiles", "minfeerate", "maxfeerate");
-    const bool do_calculate_sw = do_all || SetHasKeys(stats, "swtxs", "swtotal_size", "swtotal_weight");
-
-    CAmount maxfee = 0;
-    CAmount maxfeerate = 0;
-    CAmount minfee = MAX_MONEY;
-    CAmount minfeerate = MAX_MONEY;
-    CAmount total_out = 0;
-    CAmount totalfee = 0;
-    int64_t inputs = 0;
-    int64_t maxtxsize = 0;
-    int64_t mintxsize = MAX_BLOCK_SERIALIZED_SIZE;
-    int64_t outputs = 0;
-    int64_t swtotal_size = 0;
-    int64_t swtotal_weight = 0;
-    int64_t swtxs = 0;
-    int64_t total_size = 0;
-    int64_t total_weight = 0;
-    int64_t utxos = 0;
-    int64_t utxo_size_inc = 0;
-    int64_t utxo_size_inc_actual = 0;
-    std::vector<CAmount> fee_array;
-    std::vector<std::pair<CAmount, int64_t>> feerate_array;
-    std::vector<int64_t> txsize_array;
-
-    for (size_t i = 0; i < block.vtx.size(); ++i) {
-        const auto& tx = block.vtx.at(i);
-        outputs += tx->vout.size();
-
-        CAmount tx_total_out = 0;
-        if (loop_outputs) {
-            for (const CTxOut& out : tx->vout) {
-                tx_total_out += out.nValue;
-
-                size_t out_size = GetSerializeSize(out) + PER_UTXO_OVERHEAD;
-                utxo_size_inc += out_size;
-
-                // Skip unspendable outputs since they are not included in the UTXO set
-                if (out.scriptPubKey.IsUnspendable()) continue;
-
-                ++utxos;
-                utxo_size_inc_actual += out_size;
-            }
-        }
-
-        if (tx->IsCoinBase()) {
-            continue;
-        }
-
-        inputs += tx->vin.size(); // Don't count coinbase's fake input
-        total_out += tx_total_out; // Don't count coinbase reward
-
-        int64_t tx_size = 0;
-        if (do_calculate_size) {
+    // Served from the index when it has the block, else computed from disk
+    BlockStats block_stats;
+    if (!g_block_stats_index || !g_block_stats_index->LookupStats(pindex, block_stats)) {
+        const CBlock block{GetBlockChecked(chainman.m_blockman, pindex)};
+        const CBlockUndo block_undo{GetUndoChecked(chainman.m_blockman, pindex)};
+        block_stats = ComputeBlockStats(block, &block_undo);
+    }
+    return BlockStatsToJSON(block_stats, pindex, chainman.GetParams().GetConsensus(), stats);
+},
+    };
+}
 
-            tx_size = tx->GetTotalSize();
-            if (do_mediantxsize) {
-                txsize_array.push_back(tx_size);
-            }
-            maxtxsize = std::max(maxtxsize, tx_size);
-            mintxsize = std::min(mintxsize, tx_size);
-            total_size += tx_size;
-        }
+static RPCHelpMan getblockstatsrange()
+{
+    return RPCHelpMan{"getblockstatsrange",
+                "\nReturn the statistics reported by getblockstats for a range of blocks of the active chain, in one call.\n"
+                "The range is of at most " + ToString(MAX_BLOCK_STATS_RANGE) + " blocks; longer ones are queried a range at a time.\n"
+                "Requires -blockstatsindex, synced up to the end of the range. All amounts are in satoshis.\n",
+                {
+                    {"start_height", RPCArg::Type::NUM, RPCArg::Optional::NO, "The height of the first block"},
+                    {"stop_height", RPCArg::Type::NUM, RPCArg::Optional::NO, "The height of the last block"},
+                    {"stats", RPCArg::Type::ARR, RPCArg::DefaultHint{"all values"}, "Values to return for each block (see getblockstats)",
+                        {
+                            {"height", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Selected statistic"},
+                            {"time", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Selected statistic"},
+                        },
+                        RPCArgOptions{.oneline_description="stats"}},
+                },
+                RPCResult{RPCResult::Type::ARR, "", "The statistics of each block, in height order",
+                {
+                    {RPCResult::Type::OBJ, "", "", BlockStatsDoc()},
+                }},
+                RPCExamples{
+                    HelpExampleCli("getblockstatsrange", R"(1000 1999 '["height","totalfee","txs"]')") +
+                    HelpExampleRpc("getblockstatsrange", R"(1000, 1999, ["height","totalfee","txs"])")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    if (!g_block_stats_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Block stats index is not enabled (-blockstatsindex)");
+    }
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    const int start_height{request.params[0].getInt<int>()};
+    const int stop_height{request.params[1].getInt<int>()};
+    const std::set<std::string> stats{ParseSelectedStats(request.params[2])};
 
-        int64_t weight = 0;
-        if (do_calculate_weight) {
-            weight = GetTransactionWeight(*tx);
-            total_weight += weight;
+    const CBlockIndex* stop_index;
+    {
+        LOCK(cs_main);
+        const CChain& active_chain{chainman.ActiveChain()};
+        if (start_height < 0 || start_height > active_chain.Height()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid start_height");
         }
-
-        if (do_calculate_sw && tx->HasWitness()) {
-            ++swtxs;
-            swtotal_size += tx_size;
-            swtotal_weight += weight;
+        if (stop_height < start_height || stop_height > active_chain.Height()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid stop_height");
         }
-
-        if (loop_inputs) {
-            CAmount tx_total_in = 0;
-            const auto& txundo = blockUndo.vtxundo.at(i - 1);
-            for (const Coin& coin: txundo.vprevout) {
-                const CTxOut& prevoutput = coin.out;
-
-                tx_total_in += prevoutput.nValue;
-                size_t prevout_size = GetSerializeSize(prevoutput) + PER_UTXO_OVERHEAD;
-                utxo_size_inc -= prevout_size;
-                utxo_size_inc_actual -= prevout_size;
-            }
-
-            CAmount txfee = tx_total_in - tx_total_out;
-            CHECK_NONFATAL(MoneyRange(txfee));
-            if (do_medianfee) {
-                fee_array.push_back(txfee);
-            }
-            maxfee = std::max(maxfee, txfee);
-            minfee = std::min(minfee, txfee);
-            totalfee += txfee;
-
-            // New feerate uses satoshis per virtual byte instead of per serialized byte
-            CAmount feerate = weight ? (txfee * WITNESS_SCALE_FACTOR) / weight : 0;
-            if (do_feerate_percentiles) {
-                feerate_array.emplace_back(feerate, weight);
-            }
-            maxfeerate = std::max(maxfeerate, feerate);
-            minfeerate = std::min(minfeerate, feerate);
+        if (stop_height - start_height >= MAX_BLOCK_STATS_RANGE) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Range of more than %d blocks", MAX_BLOCK_STATS_RANGE));
         }
+        stop_index = active_chain[stop_height];
     }
 
-    CAmount feerate_percentiles[NUM_GETBLOCKSTATS_PERCENTILES] = { 0 };
-    CalculatePercentilesByWeight(feerate_percentiles, feerate_array, total_weight);
-
-    UniValue feerates_res(UniValue::VARR);
-    for (int64_t i = 0; i < NUM_GETBLOCKSTATS_PERCENTILES; i++) {
-        feerates_res.push_back(feerate_percentiles[i]);
+    std::vector<BlockStats> block_stats;
+    if (!g_block_stats_index->LookupStatsRange(start_height, *stop_index, block_stats)) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Block stats index is not synced up to stop_height");
     }
 
-    UniValue ret_all(UniValue::VOBJ);
-    ret_all.pushKV("avgfee", (block.vtx.size() > 1) ? totalfee / (block.vtx.size() - 1) : 0);
-    ret_all.pushKV("avgfeerate", total_weight ? (totalfee * WITNESS_SCALE_FACTOR) / total_weight : 0); // Unit: sat/vbyte
-    ret_all.pushKV("avgtxsize", (block.vtx.size() > 1) ? total_size / (block.vtx.size() - 1) : 0);
-    ret_all.pushKV("blockhash", pindex.GetBlockHash().GetHex());
-    ret_all.pushKV("feerate_percentiles", feerates_res);
-    ret_all.pushKV("height", (int64_t)pindex.nHeight);
-    ret_all.pushKV("ins", inputs);
-    ret_all.pushKV("maxfee", maxfee);
-    ret_all.pushKV("maxfeerate", maxfeerate);
-    ret_all.pushKV("maxtxsize", maxtxsize);
-    ret_all.pushKV("medianfee", CalculateTruncatedMedian(fee_array));
-    ret_all.pushKV("mediantime", pindex.GetMedianTimePast());
-    ret_all.pushKV("mediantxsize", CalculateTruncatedMedian(txsize_array));
-    ret_all.pushKV("minfee", (minfee == MAX_MONEY) ? 0 : minfee);
-    ret_all.pushKV("minfeerate", (minfeerate == MAX_MONEY) ? 0 : minfeerate);
-    ret_all.pushKV("mintxsize", mintxsize == MAX_BLOCK_SERIALIZED_SIZE ? 0 : mintxsize);
-    ret_all.pushKV("outs", outputs);
-    ret_all.pushKV("subsidy", GetBlockSubsidy(pindex.nHeight, chainman.GetParams().GetConsensus()));
-    ret_all.pushKV("swtotal_size", swtotal_size);
-    ret_all.pushKV("swtotal_weight", swtotal_weight);
-    ret_all.pushKV("swtxs", swtxs);
-    ret_all.pushKV("time", pindex.GetBlockTime());
-    ret_all.pushKV("total_out", total_out);
-    ret_all.pushKV("total_size", total_size);
-    ret_all.pushKV("total_weight", total_weight);
-    ret_all.pushKV("totalfee", totalfee);
-    ret_all.pushKV("txs", (int64_t)block.vtx.size());
-    ret_all.pushKV("utxo_increase", outputs - inputs);
-    ret_all.pushKV("utxo_size_inc", utxo_size_inc);
-    ret_all.pushKV("utxo_increase_actual", utxos - inputs);
-    ret_all.pushKV("utxo_size_inc_actual", utxo_size_inc_actual);
-
-    if (do_all) {
-        return ret_all;
+    std::vector<const CBlockIndex*> blocks(block_stats.size());
+    for (const CBlockIndex* pindex = stop_index; pindex && pindex->nHeight >= start_height; pindex = pindex->pprev) {
+        blocks[pindex->nHeight - start_height] = pindex;
     }
 
-    UniValue ret(UniValue::VOBJ);
-    for (const std::string& stat : stats) {
-        const UniValue& value = ret_all[stat];
-        if (value.isNull()) {
-            throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid selected statistic '%s'", stat));
-        }
-        ret.pushKV(stat, value);
+    const Consensus::Params& consensus{chainman.GetParams().GetConsensus()};
+    UniValue ret(UniValue::VARR);
+    for (size_t i = 0; i < block_stats.size(); ++i) {
+        ret.push_back(BlockStatsToJSON(block_stats[i], *blocks[i], consensus, stats));
     }
     return ret;
 },
@@ -1992,35 +2014,116 @@ static RPCHelpMan getblockstats()
 }
 
 namespace {
-//! Search for a given set of pubkey scripts
-bool FindScriptPubKey(std::atomic<int>& scan_progress, const std::atomic<bool>& should_abort, int64_t& count, CCoinsViewCursor* cursor, const std::set<CScript>& needles, std::map<COutPoint, Coin>& out_results, std::function<void()>& interruption_point)
+//! Maximum number of threads (and key ranges) used by scantxoutset
+static constexpr int MAX_SCAN_THREADS{16};
+
+using ScanNeedles = std::unordered_set<CScript, SaltedSipHasher>;
+
+/**
+ * One range of the coins key space, covering the txids whose two leading
+ * bytes lie in [begin, end).
+ */
+struct ScanShard {
+    uint32_t begin;
+    uint32_t end;
+    std::unique_ptr<CCoinsViewCursor> cursor;
+    std::atomic<int> progress{0};
+    int64_t count{0};
+    std::map<COutPoint, Coin> results;
+};
+
+//! Smallest txid whose two leading bytes equal prefix
+uint256 TxidFromPrefix(uint32_t prefix)
 {
-    scan_progress = 0;
-    count = 0;
+    uint256 txid;
+    txid.begin()[0] = prefix >> 8;
+    txid.begin()[1] = prefix & 0xff;
+    return txid;
+}
+
+//! Search a key range of the coins database for a given set of pubkey scripts
+bool FindScriptPubKey(ScanShard& shard, const std::function<void()>& update_progress, const std::function<bool()>& should_abort, const ScanNeedles& needles, const std::function<void()>& interruption_point)
+{
+    CCoinsViewCursor* cursor{shard.cursor.get()};
     while (cursor->Valid()) {
         COutPoint key;
         Coin coin;
         if (!cursor->GetKey(key) || !cursor->GetValue(coin)) return false;
-        if (++count % 8192 == 0) {
+        if (++shard.count % 8192 == 0) {
             interruption_point();
-            if (should_abort) {
+            if (should_abort()) {
                 // allow to abort the scan via the abort reference
                 return false;
             }
         }
-        if (count % 256 == 0) {
+        if (shard.count % 256 == 0) {
             // update progress reference every 256 item
             uint32_t high = 0x100 * *UCharCast(key.hash.begin()) + *(UCharCast(key.hash.begin()) + 1);
-            scan_progress = (int)(high * 100.0 / 65536.0 + 0.5);
+            shard.progress = (int)((high - shard.begin) * 100.0 / (shard.end - shard.begin) + 0.5);
+            update_progress();
         }
         if (needles.count(coin.out.scriptPubKey)) {
-            out_results.emplace(key, coin);
+            shard.results.emplace(key, coin);
         }
         cursor->Next();
     }
-    scan_progress = 100;
+    shard.progress = 100;
+    update_progress();
     return true;
 }
+
+/**
+ * Search the coins database for a given set of pubkey scripts, scanning every
+ * shard on its own thread. The shard cursors must have been created from the
+ * same database state. Results are identical to a single sequential scan.
+ */
+bool FindScriptPubKey(std::atomic<int>& scan_progress, const std::atomic<bool>& should_abort, int64_t& count, std::vector<ScanShard>& shards, const ScanNeedles& needles, std::map<COutPoint, Coin>& out_results, const std::function<void()>& interruption_point)
+{
+    scan_progress = 0;
+    count = 0;
+    // Set once any shard fails, so that the remaining ones stop early
+    std::atomic<bool> interrupted{false};
+    const auto update_progress{[&] {
+        int total{0};
+        for (const ScanShard& shard : shards) total += shard.progress;
+        scan_progress = total / (int)shards.size();
+    }};
+    const auto abort_requested{[&] { return should_abort || interrupted; }};
+
+    ThreadPool pool{"scantxoutset"};
+    pool.Start(static_cast<int>(shards.size()));
+    std::vector<std::future<bool>> futures;
+    for (ScanShard& shard : shards) {
+        futures.emplace_back(pool.Submit([&]() {
+            try {
+                const bool ok{FindScriptPubKey(shard, update_progress, abort_requested, needles, interruption_point)};
+                if (!ok) interrupted = true;
+                return ok;
+            } catch (...) {
+                interrupted = true;
+                throw;
+            }
+        }));
+    }
+
+    bool res{true};
+    std::exception_ptr error;
+    for (auto& future : futures) {
+        try {
+            res &= future.get();
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+
+    for (ScanShard& shard : shards) {
+        count += shard.count;
+        out_results.merge(shard.results);
+    }
+    if (res) scan_progress = 100;
+    return res;
+}
 } // namespace
 
 /** RAII object to prevent concurrency issue when scanning the txout set */
@@ -2175,7 +2278,7 @@ static RPCHelpMan scantxoutset()
             throw JSONRPCError(RPC_MISC_ERROR, "scanobjects argument is required for the start action");
         }
 
-        std::set<CScript> needles;
+        ScanNeedles needles;
         std::map<CScript, std::string> descriptors;
         CAmount total_in = 0;
 
@@ -2196,7 +2299,13 @@ static RPCHelpMan scantxoutset()
         std::map<COutPoint, Coin> coins;
         g_should_abort_scan = false;
         int64_t count = 0;
-        std::unique_ptr<CCoinsViewCursor> pcursor;
+        // Split the txid space into equally sized ranges, one per scan thread
+        const int num_shards{std::clamp(GetNumCores(), 1, MAX_SCAN_THREADS)};
+        std::vector<ScanShard> shards(num_shards);
+        for (int i = 0; i < num_shards; ++i) {
+            shards[i].begin = 0x10000 * i / num_shards;
+            shards[i].end = 0x10000 * (i + 1) / num_shards;
+        }
         const CBlockIndex* tip;
         NodeContext& node = EnsureAnyNodeContext(request.context);
         {
@@ -2204,10 +2313,14 @@ static RPCHelpMan scantxoutset()
             LOCK(cs_main);
             Chainstate& active_chainstate = chainman.ActiveChainstate();
             active_chainstate.ForceFlushStateToDisk();
-            pcursor = CHECK_NONFATAL(active_chainstate.CoinsDB().Cursor());
+            // All cursors are created under the same lock, so that they see the same coins database state
+            for (ScanShard& shard : shards) {
+                const std::optional<uint256> end{shard.end < 0x10000 ? std::make_optional(TxidFromPrefix(shard.end)) : std::nullopt};
+                shard.cursor = CHECK_NONFATAL(active_chainstate.CoinsDB().Cursor(TxidFromPrefix(shard.begin), end));
+            }
             tip = CHECK_NONFATAL(active_chainstate.m_chain.Tip());
         }
-        bool res = FindScriptPubKey(g_scan_progress, g_should_abort_scan, count, pcursor.get(), needles, coins, node.rpc_interruption_point);
+        bool res = FindScriptPubKey(g_scan_progress, g_should_abort_scan, count, shards, needles, coins, node.rpc_interruption_point);
         result.pushKV("success", res);
         result.pushKV("txouts", count);
         result.pushKV("height", tip->nHeight);
@@ -2439,9 +2552,14 @@ static RPCHelpMan scanblocks()
                     stop_block;
 
             if (index->LookupFilterRange(start_block, end_range, filters)) {
-                for (const BlockFilter& filter : filters) {
-                    // compare the elements-set with each filter
-                    if (filter.GetFilter().MatchAny(needle_set)) {
+                // compare the elements-set with the filters of the chunk at once
+                std::vector<const GCSFilter*> gcs_filters;
+                gcs_filters.reserve(filters.size());
+                for (const BlockFilter& filter : filters) gcs_filters.push_back(&filter.GetFilter());
+                const std::vector<bool> matches{GCSFilter::MatchAny(gcs_filters, needle_set)};
+                for (size_t i = 0; i < filters.size(); ++i) {
+                    const BlockFilter& filter{filters[i]};
+                    if (matches[i]) {
                         if (filter_false_positives) {
                             // Double check the filter matches by scanning the block
                             const CBlockIndex& blockindex = *CHECK_NONFATAL(WITH_LOCK(cs_main, return chainman.m_blockman.LookupBlockIndex(filter.GetBlockHash())));
@@ -2561,6 +2679,252 @@ static RPCHelpMan getblockfilter()
     };
 }
 
+UniValue AddressOutputToJSON(const AddressOutput& output)
+{
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("txid", output.txid.GetHex());
+    result.pushKV("vout", output.vout);
+    result.pushKV("height", output.height);
+    result.pushKV("amount", ValueFromAmount(output.value));
+    if (output.IsSpent()) {
+        result.pushKV("spent_txid", output.spent_txid.GetHex());
+        result.pushKV("spent_vin", output.spent_vin);
+        result.pushKV("spent_height", output.spent_height);
+    }
+    return result;
+}
+
+UniValue AddressBalanceToJSON(const AddressBalance& balance)
+{
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("balance", ValueFromAmount(balance.balance));
+    result.pushKV("received", ValueFromAmount(balance.received));
+    result.pushKV("outputs", balance.outputs);
+    result.pushKV("unspent_outputs", balance.unspent_outputs);
+    return result;
+}
+
+/** Check that the address index can be queried and return the ScriptHash() of address */
+static uint256 GetAddressScriptHash(const UniValue& address)
+{
+    const CTxDestination dest{DecodeDestination(address.get_str())};
+    if (!IsValidDestination(dest)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address: " + address.get_str());
+    }
+    if (!g_address_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled (start with -addressindex)");
+    }
+    if (!g_address_index->BlockUntilSyncedToCurrentChain()) {
+        const IndexSummary summary{g_address_index->GetSummary()};
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("Unable to get data because addressindex is still syncing. Current height: %d", summary.best_block_height));
+    }
+    return AddressIndex::ScriptHash(GetScriptForDestination(dest));
+}
+
+static std::vector<AddressOutput> GetAddressOutputs(const JSONRPCRequest& request, bool unspent_only)
+{
+    const uint256 script_hash{GetAddressScriptHash(request.params[0])};
+    const int skip{request.params[1].isNull() ? 0 : request.params[1].getInt<int>()};
+    const int count{request.params[2].isNull() ? MAX_ADDRESS_OUTPUTS_RESULTS : request.params[2].getInt<int>()};
+    if (skip < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative skip");
+    }
+    if (count < 1 || count > MAX_ADDRESS_OUTPUTS_RESULTS) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Count must be between 1 and %d", MAX_ADDRESS_OUTPUTS_RESULTS));
+    }
+    std::vector<AddressOutput> outputs;
+    if (!g_address_index->FindOutputs(script_hash, outputs, unspent_only, skip, count)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to read address index");
+    }
+    return outputs;
+}
+
+static const std::vector<RPCArg> ADDRESS_OUTPUTS_ARGS{
+    {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The address"},
+    {"skip", RPCArg::Type::NUM, RPCArg::Default{0}, "The number of outputs to leave out before the first one returned"},
+    {"count", RPCArg::Type::NUM, RPCArg::Default{MAX_ADDRESS_OUTPUTS_RESULTS}, strprintf("The maximum number of outputs to return (1-%d)", MAX_ADDRESS_OUTPUTS_RESULTS)},
+};
+
+static const RPCResult ADDRESS_OUTPUT_RESULT{RPCResult::Type::OBJ, "", "", {
+    {RPCResult::Type::STR_HEX, "txid", "The transaction id of the output"},
+    {RPCResult::Type::NUM, "vout", "The output number"},
+    {RPCResult::Type::NUM, "height", "The height of the block containing the transaction"},
+    {RPCResult::Type::STR_AMOUNT, "amount", "The amount of the output in " + CURRENCY_UNIT},
+    {RPCResult::Type::STR_HEX, "spent_txid", /*optional=*/true, "The transaction id spending the output, if it is spent"},
+    {RPCResult::Type::NUM, "spent_vin", /*optional=*/true, "The input number spending the output, if it is spent"},
+    {RPCResult::Type::NUM, "spent_height", /*optional=*/true, "The height of the block spending the output, if it is spent"},
+}};
+
+static RPCHelpMan getaddresshistory()
+{
+    return RPCHelpMan{"getaddresshistory",
+                "\nReturns the outputs paying to an address in the active chain, spent or not, in block order.\n"
+                "Use skip and count to page through addresses with many outputs.\n"
+                "Requires -addressindex.\n",
+                ADDRESS_OUTPUTS_ARGS,
+                RPCResult{
+                    RPCResult::Type::ARR, "", "", {ADDRESS_OUTPUT_RESULT}},
+                RPCExamples{
+                    HelpExampleCli("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\"")
+            + HelpExampleCli("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\" 1000 1000")
+            + HelpExampleRpc("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\"")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    UniValue result(UniValue::VARR);
+    for (const AddressOutput& output : GetAddressOutputs(request, /*unspent_only=*/false)) {
+        result.push_back(AddressOutputToJSON(output));
+    }
+    return result;
+},
+    };
+}
+
+static RPCHelpMan getaddressutxos()
+{
+    return RPCHelpMan{"getaddressutxos",
+                "\nReturns the unspent outputs paying to an address in the active chain, in block order.\n"
+                "Use skip and count to page through addresses with many unspent outputs.\n"
+                "Requires -addressindex.\n",
+                ADDRESS_OUTPUTS_ARGS,
+                RPCResult{
+                    RPCResult::Type::ARR, "", "", {ADDRESS_OUTPUT_RESULT}},
+                RPCExamples{
+                    HelpExampleCli("getaddressutxos", "\"" + EXAMPLE_ADDRESS[0] + "\"")
+            + HelpExampleCli("getaddressutxos", "\"" + EXAMPLE_ADDRESS[0] + "\" 1000 1000")
+            + HelpExampleRpc("getaddressutxos", "\"" + EXAMPLE_ADDRESS[0] + "\"")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    UniValue result(UniValue::VARR);
+    for (const AddressOutput& output : GetAddressOutputs(request, /*unspent_only=*/true)) {
+        result.push_back(AddressOutputToJSON(output));
+    }
+    return result;
+},
+    };
+}
+
+static RPCHelpMan getaddressbalance()
+{
+    return RPCHelpMan{"getaddressbalance",
+                "\nReturns the balance of an address in the active chain.\n"
+                "Requires -addressindex.\n",
+                {
+                    {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The address"},
+                },
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::STR_AMOUNT, "balance", "The total amount of the unspent outputs in " + CURRENCY_UNIT},
+                        {RPCResult::Type::STR_AMOUNT, "received", "The total amount of all outputs in " + CURRENCY_UNIT},
+                        {RPCResult::Type::NUM, "outputs", "The number of outputs"},
+                        {RPCResult::Type::NUM, "unspent_outputs", "The number of unspent outputs"},
+                    }},
+                RPCExamples{
+                    HelpExampleCli("getaddressbalance", "\"" + EXAMPLE_ADDRESS[0] + "\"")
+            + HelpExampleRpc("getaddressbalance", "\"" + EXAMPLE_ADDRESS[0] + "\"")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const uint256 script_hash{GetAddressScriptHash(request.params[0])};
+    AddressBalance balance;
+    if (!g_address_index->GetBalance(script_hash, balance)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to read address index");
+    }
+    return AddressBalanceToJSON(balance);
+},
+    };
+}
+
+static RPCHelpMan getspendinginfo()
+{
+    return RPCHelpMan{"getspendinginfo",
+                "\nReturns the inputs of the active chain spending the given outputs.\n"
+                "Requires -spentindex. Use gettxspendingprevout for spends in the mempool.\n",
+                {
+                    {"outputs", RPCArg::Type::ARR, RPCArg::Optional::NO, "The transaction outputs to look up",
+                        {
+                            {"", RPCArg::Type::OBJ, RPCArg::Optional::OMITTED, "",
+                                {
+                                    {"txid", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The transaction id"},
+                                    {"vout", RPCArg::Type::NUM, RPCArg::Optional::NO, "The output number"},
+                                },
+                            },
+                        },
+                    },
+                },
+                RPCResult{
+                    RPCResult::Type::ARR, "", "",
+                    {
+                        {RPCResult::Type::OBJ, "", "",
+                        {
+                            {RPCResult::Type::STR_HEX, "txid", "The transaction id of the output"},
+                            {RPCResult::Type::NUM, "vout", "The output number"},
+                            {RPCResult::Type::STR_HEX, "spendingtxid", /*optional=*/true, "The transaction id spending the output (omitted if unspent)"},
+                            {RPCResult::Type::NUM, "spendingvin", /*optional=*/true, "The input number spending the output (omitted if unspent)"},
+                            {RPCResult::Type::NUM, "spendingheight", /*optional=*/true, "The height of the block spending the output (omitted if unspent)"},
+                        }},
+                    }},
+                RPCExamples{
+                    HelpExampleCli("getspendinginfo", "\"[{\\\"txid\\\":\\\"a08e6907dbbd3d809776dbfc5d82e371b764ed838b5655e72f463568df1aadf0\\\",\\\"vout\\\":3}]\"")
+            + HelpExampleRpc("getspendinginfo", "\"[{\\\"txid\\\":\\\"a08e6907dbbd3d809776dbfc5d82e371b764ed838b5655e72f463568df1aadf0\\\",\\\"vout\\\":3}]\"")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const UniValue& output_params = request.params[0].get_array();
+    if (output_params.empty()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, outputs are missing");
+    }
+
+    std::vector<COutPoint> outpoints;
+    outpoints.reserve(output_params.size());
+    for (unsigned int idx = 0; idx < output_params.size(); idx++) {
+        const UniValue& o = output_params[idx].get_obj();
+
+        RPCTypeCheckObj(o,
+                        {
+                            {"txid", UniValueType(UniValue::VSTR)},
+                            {"vout", UniValueType(UniValue::VNUM)},
+                        }, /*fAllowNull=*/false, /*fStrict=*/true);
+
+        const Txid txid = Txid::FromUint256(ParseHashO(o, "txid"));
+        const int nOutput{o.find_value("vout").getInt<int>()};
+        if (nOutput < 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, vout cannot be negative");
+        }
+        outpoints.emplace_back(txid, nOutput);
+    }
+
+    if (!g_spent_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Spent index is not enabled (start with -spentindex)");
+    }
+    if (!g_spent_index->BlockUntilSyncedToCurrentChain()) {
+        const IndexSummary summary{g_spent_index->GetSummary()};
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("Unable to get data because spentindex is still syncing. Current height: %d", summary.best_block_height));
+    }
+    std::vector<std::optional<SpentInfo>> spends;
+    if (!g_spent_index->FindSpends(outpoints, spends)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to read spent index");
+    }
+
+    UniValue result{UniValue::VARR};
+    for (size_t i = 0; i < outpoints.size(); ++i) {
+        UniValue o(UniValue::VOBJ);
+        o.pushKV("txid", outpoints[i].hash.ToString());
+        o.pushKV("vout", (uint64_t)outpoints[i].n);
+        if (spends[i]) {
+            o.pushKV("spendingtxid", spends[i]->txid.GetHex());
+            o.pushKV("spendingvin", (uint64_t)spends[i]->vin);
+            o.pushKV("spendingheight", spends[i]->height);
+        }
+        result.push_back(o);
+    }
+    return result;
+},
+    };
+}
+
 /**
  * Serialize the UTXO set to a file for loading elsewhere.
  *
@@ -2851,6 +3215,7 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
         {"blockchain", &getblockchaininfo},
         {"blockchain", &getchaintxstats},
         {"blockchain", &getblockstats},
+        {"blockchain", &getblockstatsrange},
         {"blockchain", &getbestblockhash},
         {"blockchain", &getblockcount},
         {"blockchain", &getblock},
@@ -2863,11 +3228,16 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
         {"blockchain", &gettxout},
         {"blockchain", &gettxoutsetinfo},
         {"blockchain", &pruneblockchain},
+        {"blockchain", &getpruneplan},
         {"blockchain", &verifychain},
         {"blockchain", &preciousblock},
         {"blockchain", &scantxoutset},
         {"blockchain", &scanblocks},
         {"blockchain", &getblockfilter},
+        {"blockchain", &getaddresshistory},
+        {"blockchain", &getaddressutxos},
+        {"blockchain", &getaddressbalance},
+        {"blockchain", &getspendinginfo},
         {"blockchain", &dumptxoutset},
         {"blockchain", &loadtxoutset},
         {"blockchain", &getchainstates},
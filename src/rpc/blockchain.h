@@ -6,6 +6,7 @@
 #ifndef BETGENIUS_RPC_BLOCKCHAIN_H
 #define BETGENIUS_RPC_BLOCKCHAIN_H
 
+#include <blockstats.h>
 #include <consensus/amount.h>
 #include <core_io.h>
 #include <streams.h>
@@ -17,6 +18,8 @@
 #include <stdint.h>
 #include <vector>
 
+struct AddressBalance;
+struct AddressOutput;
 class CBlock;
 class CBlockIndex;
 class Chainstate;
@@ -25,7 +28,8 @@ namespace node {
 struct NodeContext;
 } // namespace node
 
-static constexpr int NUM_GETBLOCKSTATS_PERCENTILES = 5;
+/** Maximum number of outputs returned by one address history or unspent outputs request */
+static constexpr int MAX_ADDRESS_OUTPUTS_RESULTS{10000};
 
 /**
  * Get the difficulty of the net wrt to the given block index.
@@ -41,11 +45,14 @@ void RPCNotifyBlockChange(const CBlockIndex*);
 /** Block description to JSON */
 UniValue blockToJSON(node::BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity) LOCKS_EXCLUDED(cs_main);
 
-/** Block header to JSON */
-UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex) LOCKS_EXCLUDED(cs_main);
+/** Block header to JSON. The header provides the fields not kept in the block index. */
+UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex, const CBlockHeader& header) LOCKS_EXCLUDED(cs_main);
 
-/** Used by getblockstats to get feerates at different percentiles by weight  */
-void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight);
+/** Address index output to JSON */
+UniValue AddressOutputToJSON(const AddressOutput& output);
+
+/** Totals of the outputs paying to an address to JSON */
+UniValue AddressBalanceToJSON(const AddressBalance& balance);
 
 /**
  * Helper to create UTXO snapshots given a chainstate and a file handle.
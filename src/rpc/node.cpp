@@ -9,9 +9,13 @@
 #endif
 
 #include <chainparams.h>
+#include <dbwrapper.h>
 #include <httpserver.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
+#include <index/blockstatsindex.h>
 #include <index/coinstatsindex.h>
+#include <index/spentindex.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
 #include <interfaces/echo.h>
@@ -195,6 +199,58 @@ static RPCHelpMan getmemoryinfo()
     };
 }
 
+static RPCHelpMan getdbcacheinfo()
+{
+    return RPCHelpMan{"getdbcacheinfo",
+                "Returns information about the block cache shared by the node's databases (see -shareddbcache).\n",
+                {},
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::NUM, "capacity", "Memory budget of the cache in bytes"},
+                        {RPCResult::Type::NUM, "usage", "Total charge of the cached blocks in bytes"},
+                        {RPCResult::Type::ARR, "databases", "Databases using the cache",
+                        {
+                            {RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::STR, "path", "Location of the database"},
+                                {RPCResult::Type::NUM, "priority", "Cache priority of the database; its blocks are charged their size divided by this"},
+                                {RPCResult::Type::NUM, "usage", "Bytes of cached blocks of the database"},
+                                {RPCResult::Type::NUM, "hits", "Number of block reads served from the cache"},
+                                {RPCResult::Type::NUM, "misses", "Number of block reads that were not cached"},
+                            }},
+                        }},
+                    }
+                },
+                RPCExamples{
+                    HelpExampleCli("getdbcacheinfo", "")
+            + HelpExampleRpc("getdbcacheinfo", "")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const NodeContext& node = EnsureAnyNodeContext(request.context);
+    if (!node.db_block_cache) {
+        throw JSONRPCError(RPC_MISC_ERROR, "The shared database cache is disabled (-shareddbcache=0)");
+    }
+    UniValue databases(UniValue::VARR);
+    for (const DBBlockCache::DatabaseStats& stats : node.db_block_cache->GetStats()) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("path", stats.name);
+        entry.pushKV("priority", stats.priority);
+        entry.pushKV("usage", (uint64_t)stats.usage);
+        entry.pushKV("hits", stats.hits);
+        entry.pushKV("misses", stats.misses);
+        databases.push_back(entry);
+    }
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("capacity", (uint64_t)node.db_block_cache->Capacity());
+    obj.pushKV("usage", (uint64_t)node.db_block_cache->TotalCharge());
+    obj.pushKV("databases", databases);
+    return obj;
+},
+    };
+}
+
 static void EnableOrDisableLogCategories(UniValue cats, bool enable) {
     cats = cats.get_array();
     for (unsigned int i = 0; i < cats.size(); ++i) {
@@ -346,24 +402,70 @@ static RPCHelpMan echoipc()
     };
 }
 
-static UniValue SummaryToJSON(const IndexSummary&& summary, std::string index_name)
+static UniValue LatencyToJSON(const IndexLatency& latency)
+{
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("count", latency.count);
+    ret.pushKV("total_ms", Ticks<MillisecondsDouble>(latency.total));
+    UniValue buckets(UniValue::VARR);
+    for (size_t i = 0; i < IndexLatency::NUM_BUCKETS; ++i) {
+        UniValue bucket(UniValue::VOBJ);
+        if (i + 1 < IndexLatency::NUM_BUCKETS) {
+            bucket.pushKV("below_ms", Ticks<MillisecondsDouble>(IndexLatency::BucketLimit(i)));
+        }
+        bucket.pushKV("count", latency.buckets[i]);
+        buckets.push_back(std::move(bucket));
+    }
+    ret.pushKV("histogram", std::move(buckets));
+    return ret;
+}
+
+static UniValue SummaryToJSON(const BaseIndex& index, const std::string& index_name, bool verbose)
 {
     UniValue ret_summary(UniValue::VOBJ);
+    const IndexSummary summary{index.GetSummary()};
     if (!index_name.empty() && index_name != summary.name) return ret_summary;
 
     UniValue entry(UniValue::VOBJ);
     entry.pushKV("synced", summary.synced);
     entry.pushKV("best_block_height", summary.best_block_height);
+    if (verbose) {
+        const IndexStats stats{index.GetStats()};
+        entry.pushKV("blocks", stats.blocks);
+        entry.pushKV("blocks_per_second", stats.blocks_per_second);
+        entry.pushKV("read", LatencyToJSON(stats.read));
+        entry.pushKV("compute", LatencyToJSON(stats.compute));
+        entry.pushKV("commit", LatencyToJSON(stats.commit));
+        entry.pushKV("bytes_written", stats.bytes_written);
+        entry.pushKV("notifications_pending", uint64_t(stats.notifications_pending));
+    }
     ret_summary.pushKV(summary.name, entry);
     return ret_summary;
 }
 
-static RPCHelpMan getindexinfo()
+static std::vector<RPCResult> LatencyDoc()
+{
+    return {
+        {RPCResult::Type::NUM, "count", "Number of operations"},
+        {RPCResult::Type::NUM, "total_ms", "Total time of the operations, in milliseconds"},
+        {RPCResult::Type::ARR, "histogram", "Number of operations by duration, in buckets doubling from 0.1 ms",
+        {
+            {RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::NUM, "below_ms", /*optional=*/true, "Upper bound of the bucket, in milliseconds. Not set for the last bucket"},
+                {RPCResult::Type::NUM, "count", "Number of operations in the bucket"},
+            }},
+        }},
+    };
+}
+
+RPCHelpMan getindexinfo()
 {
     return RPCHelpMan{"getindexinfo",
                 "\nReturns the status of one or all available indices currently running in the node.\n",
                 {
                     {"index_name", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Filter results for an index with a specific name."},
+                    {"verbose", RPCArg::Type::BOOL, RPCArg::Default{false}, "Also return counters and latencies of the work of the indices since they were started."},
                 },
                 RPCResult{
                     RPCResult::Type::OBJ_DYN, "", "", {
@@ -372,6 +474,13 @@ static RPCHelpMan getindexinfo()
                             {
                                 {RPCResult::Type::BOOL, "synced", "Whether the index is synced or not"},
                                 {RPCResult::Type::NUM, "best_block_height", "The block height to which the index is synced"},
+                                {RPCResult::Type::NUM, "blocks", /*optional=*/true, "Blocks indexed (only if verbose)"},
+                                {RPCResult::Type::NUM, "blocks_per_second", /*optional=*/true, "Blocks indexed per second since the index was started (only if verbose)"},
+                                {RPCResult::Type::OBJ, "read", /*optional=*/true, "Reading blocks from disk (only if verbose)", LatencyDoc()},
+                                {RPCResult::Type::OBJ, "compute", /*optional=*/true, "Indexing blocks, not counting database writes (only if verbose)", LatencyDoc()},
+                                {RPCResult::Type::OBJ, "commit", /*optional=*/true, "Writing to the index database (only if verbose)", LatencyDoc()},
+                                {RPCResult::Type::NUM, "bytes_written", /*optional=*/true, "Bytes written to the index database (only if verbose)"},
+                                {RPCResult::Type::NUM, "notifications_pending", /*optional=*/true, "Validation notifications waiting to be handled by all indices (only if verbose)"},
                             }
                         },
                     },
@@ -381,22 +490,36 @@ static RPCHelpMan getindexinfo()
                   + HelpExampleRpc("getindexinfo", "")
                   + HelpExampleCli("getindexinfo", "txindex")
                   + HelpExampleRpc("getindexinfo", "txindex")
+                  + HelpExampleCli("getindexinfo", "\"\" true")
                 },
                 [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
     UniValue result(UniValue::VOBJ);
     const std::string index_name = request.params[0].isNull() ? "" : request.params[0].get_str();
+    const bool verbose{self.Arg<bool>(1)};
 
     if (g_txindex) {
-        result.pushKVs(SummaryToJSON(g_txindex->GetSummary(), index_name));
+        result.pushKVs(SummaryToJSON(*g_txindex, index_name, verbose));
     }
 
     if (g_coin_stats_index) {
-        result.pushKVs(SummaryToJSON(g_coin_stats_index->GetSummary(), index_name));
+        result.pushKVs(SummaryToJSON(*g_coin_stats_index, index_name, verbose));
+    }
+
+    if (g_address_index) {
+        result.pushKVs(SummaryToJSON(*g_address_index, index_name, verbose));
+    }
+
+    if (g_spent_index) {
+        result.pushKVs(SummaryToJSON(*g_spent_index, index_name, verbose));
+    }
+
+    if (g_block_stats_index) {
+        result.pushKVs(SummaryToJSON(*g_block_stats_index, index_name, verbose));
     }
 
-    ForEachBlockFilterIndex([&result, &index_name](const BlockFilterIndex& index) {
-        result.pushKVs(SummaryToJSON(index.GetSummary(), index_name));
+    ForEachBlockFilterIndex([&result, &index_name, verbose](const BlockFilterIndex& index) {
+        result.pushKVs(SummaryToJSON(index, index_name, verbose));
     });
 
     return result;
@@ -408,6 +531,7 @@ void RegisterNodeRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
         {"control", &getmemoryinfo},
+        {"control", &getdbcacheinfo},
         {"control", &logging},
         {"util", &getindexinfo},
         {"hidden", &setmocktime},
@@ -0,0 +1,116 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <consensus/validation.h>
+#include <index/addressindex.h>
+#include <interfaces/chain.h>
+#include <key.h>
+#include <test/util/index.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(addressindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(addressindex_initial_sync, TestChain100Setup)
+{
+    AddressIndex address_index{interfaces::MakeChain(m_node), 1 << 20, true};
+    BOOST_REQUIRE(address_index.Init());
+
+    const CScript coinbase_script{CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG};
+    const uint256 coinbase_hash{AddressIndex::ScriptHash(coinbase_script)};
+    std::vector<AddressOutput> outputs;
+
+    // Outputs are not found before the index is started.
+    BOOST_REQUIRE(address_index.FindOutputs(coinbase_hash, outputs));
+    BOOST_CHECK(outputs.empty());
+
+    // The initial sync prepares the blocks in parallel, and writes them in order.
+    BOOST_REQUIRE(address_index.StartBackgroundSync());
+    IndexWaitSynced(address_index, *Assert(m_node.shutdown));
+
+    BOOST_REQUIRE(address_index.FindOutputs(coinbase_hash, outputs));
+    BOOST_REQUIRE_EQUAL(outputs.size(), m_coinbase_txns.size());
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        BOOST_CHECK_EQUAL(outputs[i].height, static_cast<int>(i) + 1);
+        BOOST_CHECK(outputs[i].txid == m_coinbase_txns[i]->GetHash());
+        BOOST_CHECK_EQUAL(outputs[i].vout, 0U);
+        BOOST_CHECK_EQUAL(outputs[i].value, m_coinbase_txns[i]->vout[0].nValue);
+        BOOST_CHECK(!outputs[i].IsSpent());
+    }
+
+    // Spending an output marks it spent, and indexes the new output.
+    CKey key;
+    key.MakeNewKey(true);
+    const CScript dest_script{GetScriptForDestination(PKHash(key.GetPubKey()))};
+    const uint256 dest_hash{AddressIndex::ScriptHash(dest_script)};
+    const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 1, coinbaseKey, dest_script, 10 * COIN, /*submit=*/false)};
+    const CBlock block{CreateAndProcessBlock({spend}, coinbase_script)};
+    BOOST_REQUIRE(address_index.BlockUntilSyncedToCurrentChain());
+
+    BOOST_REQUIRE(address_index.FindOutputs(coinbase_hash, outputs));
+    BOOST_REQUIRE_EQUAL(outputs.size(), m_coinbase_txns.size() + 1);
+    BOOST_CHECK(outputs[0].IsSpent());
+    BOOST_CHECK(outputs[0].spent_txid == spend.GetHash());
+    BOOST_CHECK_EQUAL(outputs[0].spent_vin, 0U);
+    BOOST_CHECK_EQUAL(outputs[0].spent_height, 101);
+    BOOST_CHECK(outputs.back().txid == block.vtx[0]->GetHash());
+    BOOST_REQUIRE(address_index.FindOutputs(dest_hash, outputs));
+    BOOST_REQUIRE_EQUAL(outputs.size(), 1U);
+    BOOST_CHECK(outputs[0].txid == spend.GetHash());
+    BOOST_CHECK_EQUAL(outputs[0].value, 10 * COIN);
+    BOOST_CHECK(!outputs[0].IsSpent());
+
+    // Outputs are returned a page at a time, and unspent_only skips the spent
+    // output before paging.
+    BOOST_REQUIRE(address_index.FindOutputs(coinbase_hash, outputs, /*unspent_only=*/false, /*skip=*/1, /*count=*/2));
+    BOOST_REQUIRE_EQUAL(outputs.size(), 2U);
+    BOOST_CHECK(outputs[0].txid == m_coinbase_txns[1]->GetHash());
+    BOOST_CHECK(outputs[1].txid == m_coinbase_txns[2]->GetHash());
+    BOOST_REQUIRE(address_index.FindOutputs(coinbase_hash, outputs, /*unspent_only=*/true, /*skip=*/0, /*count=*/1));
+    BOOST_REQUIRE_EQUAL(outputs.size(), 1U);
+    BOOST_CHECK(outputs[0].txid == m_coinbase_txns[1]->GetHash());
+    BOOST_REQUIRE(address_index.FindOutputs(coinbase_hash, outputs, /*unspent_only=*/false, /*skip=*/m_coinbase_txns.size() + 1));
+    BOOST_CHECK(outputs.empty());
+
+    // The balance sums the outputs without the spent one.
+    AddressBalance balance;
+    BOOST_REQUIRE(address_index.GetBalance(coinbase_hash, balance));
+    BOOST_CHECK_EQUAL(balance.outputs, static_cast<int64_t>(m_coinbase_txns.size() + 1));
+    BOOST_CHECK_EQUAL(balance.unspent_outputs, static_cast<int64_t>(m_coinbase_txns.size()));
+    BOOST_CHECK_EQUAL(balance.received - balance.balance, m_coinbase_txns[0]->vout[0].nValue);
+
+    // A reorg rewinds the index: the output is unspent again, and the outputs
+    // of the disconnected block are gone.
+    {
+        BlockValidationState state;
+        CBlockIndex* tip{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip())};
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, tip));
+    }
+    CreateAndProcessBlock({}, CScript() << OP_TRUE);
+    BOOST_REQUIRE(address_index.BlockUntilSyncedToCurrentChain());
+
+    BOOST_REQUIRE(address_index.FindOutputs(coinbase_hash, outputs));
+    BOOST_REQUIRE_EQUAL(outputs.size(), m_coinbase_txns.size());
+    BOOST_CHECK(!outputs[0].IsSpent());
+    BOOST_REQUIRE(address_index.FindOutputs(dest_hash, outputs));
+    BOOST_CHECK(outputs.empty());
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification. The BlockUntilSyncedToCurrentChain()
+    // call above is sufficient to ensure this, but the
+    // SyncWithValidationInterfaceQueue() call below is also needed to ensure
+    // TSAN always sees the test thread waiting for the notification thread, and
+    // avoid potential false positive reports.
+    SyncWithValidationInterfaceQueue();
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    address_index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <test/data/blockfilters.json.h>
+#include <test/util/random.h>
 #include <test/util/setup_common.h>
 
 #include <blockfilter.h>
@@ -13,6 +14,7 @@
 #include <streams.h>
 #include <undo.h>
 #include <univalue.h>
+#include <util/golombrice.h>
 #include <util/strencodings.h>
 
 #include <boost/test/unit_test.hpp>
@@ -42,6 +44,62 @@ BOOST_AUTO_TEST_CASE(gcsfilter_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(gcsfilter_match_any_filters)
+{
+    GCSFilter::ElementSet elements;
+    std::vector<GCSFilter> filters;
+    for (int i = 0; i < 20; ++i) {
+        GCSFilter::ElementSet filter_elements;
+        for (int j = 0; j < 50; ++j) {
+            GCSFilter::Element element(1 + InsecureRandRange(40));
+            for (auto& byte : element) byte = InsecureRandBits(8);
+            if (j == 0 && i % 3 == 0) elements.insert(element);
+            filter_elements.insert(std::move(element));
+        }
+        filters.emplace_back(GCSFilter::Params{InsecureRand256().GetUint64(0), InsecureRand256().GetUint64(1), 10, 1 << 10}, filter_elements);
+    }
+    filters.emplace_back(GCSFilter::Params{0, 0, 10, 1 << 10});
+
+    std::vector<const GCSFilter*> filter_ptrs;
+    for (const GCSFilter& filter : filters) filter_ptrs.push_back(&filter);
+    const std::vector<bool> matches{GCSFilter::MatchAny(filter_ptrs, elements)};
+    BOOST_REQUIRE_EQUAL(matches.size(), filters.size());
+    for (size_t i = 0; i < filters.size(); ++i) {
+        BOOST_CHECK_EQUAL(matches[i], filters[i].MatchAny(elements));
+        if (i < 20 && i % 3 == 0) BOOST_CHECK(matches[i]);
+    }
+    BOOST_CHECK(!matches.back());
+}
+
+BOOST_AUTO_TEST_CASE(golomb_rice_word_coders)
+{
+    for (const uint8_t P : {0, 1, 19, 63}) {
+        std::vector<uint64_t> values;
+        for (int i = 0; i < 200; ++i) {
+            // Mostly small quotients, with some spanning several words
+            const uint64_t q{InsecureRandRange(10) == 0 ? InsecureRandRange(200) : InsecureRandRange(4)};
+            values.push_back((q << P) + (P ? InsecureRandBits(P) : 0));
+        }
+
+        std::vector<unsigned char> expected;
+        {
+            VectorWriter stream{expected, 0};
+            BitStreamWriter bitwriter{stream};
+            for (const uint64_t value : values) GolombRiceEncode(bitwriter, P, value);
+        }
+        std::vector<unsigned char> encoded;
+        GolombRiceWriter writer{encoded};
+        for (const uint64_t value : values) writer.Encode(P, value);
+        writer.Flush();
+        BOOST_CHECK_EQUAL(HexStr(encoded), HexStr(expected));
+
+        GolombRiceReader reader{encoded};
+        for (const uint64_t value : values) BOOST_CHECK_EQUAL(reader.Decode(P), value);
+        BOOST_CHECK_EQUAL(reader.BytesRead(), encoded.size());
+        BOOST_CHECK_THROW(while (true) reader.Decode(P), std::ios_base::failure);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(gcsfilter_default_constructor)
 {
     GCSFilter filter;
@@ -5,22 +5,49 @@
 
 #include <chainparams.h>
 #include <clientversion.h>
+#include <node/blockformat.h>
+#include <node/blockmap.h>
+#include <node/blockprefetch.h>
 #include <node/blockstorage.h>
+#include <node/blockwriter.h>
 #include <node/context.h>
+#include <node/headerstore.h>
 #include <node/kernel_notifications.h>
+#include <node/recentblocks.h>
 #include <script/solver.h>
 #include <primitives/block.h>
+#include <streams.h>
+#include <undo.h>
+#include <util/fs.h>
+#include <util/strencodings.h>
 #include <util/chaintype.h>
 #include <validation.h>
 
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include <boost/test/unit_test.hpp>
 #include <test/util/logging.h>
+#include <test/util/mining.h>
+#include <test/util/random.h>
 #include <test/util/setup_common.h>
 
 using node::BLOCK_SERIALIZATION_HEADER_SIZE;
+using node::BlockFileWriter;
+using node::BlockFormat;
 using node::BlockManager;
+using node::BlockMap;
+using node::BlockPrefetcher;
+using node::CanStoreCompact;
+using node::HeaderStore;
 using node::KernelNotifications;
+using node::MAX_BLOCK_PREFETCH;
 using node::MAX_BLOCKFILE_SIZE;
+using node::PrunePlan;
+using node::RecentBlocks;
+using node::SharedBlockReader;
 
 // use BasicTestingSetup here for the data directory configuration, setup, and cleanup
 BOOST_FIXTURE_TEST_SUITE(blockmanager_tests, BasicTestingSetup)
@@ -200,6 +227,552 @@ BOOST_AUTO_TEST_CASE(blockmanager_flush_block_file)
     //   SaveBlockToDisk() did not call WriteBlockToDisk() because `FlatFilePos* dbp` was non-null
     blockman.ReadBlockFromDisk(read_block, pos2);
     BOOST_CHECK_EQUAL(read_block.nVersion, 2);
+
+    // A known position that does not hold a block record is not stored
+    const FlatFilePos bad_pos{0, static_cast<unsigned int>(BLOCK_SERIALIZATION_HEADER_SIZE) + 1};
+    {
+        ASSERT_DEBUG_LOG("failed to read the size of the block stored");
+        BOOST_CHECK(blockman.SaveBlockToDisk(block3, /*nHeight=*/3, /*dbp=*/&bad_pos).IsNull());
+    }
+    BOOST_CHECK_EQUAL(block_data->nBlocks, 3);
+    // A size read by the caller is used as is
+    BOOST_CHECK(blockman.SaveBlockToDisk(block3, /*nHeight=*/3, /*dbp=*/&pos2, /*stored_size=*/TEST_BLOCK_SIZE) == pos2);
+    BOOST_CHECK_EQUAL(block_data->nBlocks, 4);
+}
+
+BOOST_AUTO_TEST_CASE(blockmanager_block_map)
+{
+    BlockMap block_map;
+    BOOST_CHECK(block_map.empty());
+    BOOST_CHECK(block_map.find(InsecureRand256()) == block_map.end());
+
+    // Insert enough entries to fill several chunks and grow the slot table a few times
+    std::vector<std::pair<uint256, const CBlockIndex*>> inserted;
+    for (int i = 0; i < 5000; ++i) {
+        const uint256 hash{InsecureRand256()};
+        const auto [it, is_new]{block_map.try_emplace(hash)};
+        BOOST_CHECK(is_new);
+        it->second.nHeight = i;
+        inserted.emplace_back(hash, &it->second);
+    }
+    BOOST_CHECK_EQUAL(block_map.size(), inserted.size());
+
+    // Entries keep their address, and are iterated in insertion order
+    size_t pos{0};
+    for (const auto& [hash, block_index] : block_map) {
+        BOOST_CHECK(hash == inserted[pos].first);
+        BOOST_CHECK_EQUAL(&block_index, inserted[pos].second);
+        ++pos;
+    }
+    BOOST_CHECK_EQUAL(pos, inserted.size());
+    for (const auto& [hash, block_index] : inserted) {
+        const auto it{block_map.find(hash)};
+        BOOST_REQUIRE(it != block_map.end());
+        BOOST_CHECK_EQUAL(&it->second, block_index);
+        BOOST_CHECK_EQUAL(block_map.count(hash), 1U);
+        const auto [existing, is_new]{block_map.try_emplace(hash)};
+        BOOST_CHECK(!is_new);
+        BOOST_CHECK_EQUAL(&existing->second, block_index);
+    }
+    BOOST_CHECK_EQUAL(block_map.count(InsecureRand256()), 0U);
+    BOOST_CHECK_EQUAL(block_map.size(), inserted.size());
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_read_block_header, TestChain100Setup)
+{
+    auto& chainman{*Assert(m_node.chainman)};
+    const CBlockIndex* tip{WITH_LOCK(::cs_main, return chainman.ActiveTip())};
+    const CBlockIndex* genesis{WITH_LOCK(::cs_main, return chainman.ActiveChain().Genesis())};
+
+    // The header of a block is rebuilt with the same hash whether or not its
+    // block index entry has been written to the block tree database.
+    for (int flushed = 0; flushed < 2; ++flushed) {
+        for (const CBlockIndex* pindex : {tip, static_cast<const CBlockIndex*>(tip->pprev), genesis}) {
+            CBlockHeader header;
+            BOOST_REQUIRE(chainman.m_blockman.ReadBlockHeader(header, *pindex));
+            BOOST_CHECK(header.GetHash() == pindex->GetBlockHash());
+            BOOST_CHECK(header.hashPrevBlock == (pindex->pprev ? pindex->pprev->GetBlockHash() : uint256{}));
+        }
+        LOCK(::cs_main);
+        chainman.ActiveChainstate().ForceFlushStateToDisk();
+    }
+
+    // Blocks that are not in the block index cannot be read
+    CBlockIndex unknown;
+    const uint256 unknown_hash{InsecureRand256()};
+    unknown.phashBlock = &unknown_hash;
+    CBlockHeader header;
+    BOOST_CHECK(!chainman.m_blockman.ReadBlockHeader(header, unknown));
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_plan_pruning_below_prune_height, TestChain100Setup)
+{
+    auto& chainman{*Assert(m_node.chainman)};
+    LOCK(::cs_main);
+    Chainstate& chainstate{chainman.ActiveChainstate()};
+    BOOST_REQUIRE_LE(uint64_t(chainstate.m_chain.Height()), chainman.GetParams().PruneAfterHeight());
+
+    // Nothing is pruned below PruneAfterHeight, but the usage is reported
+    const PrunePlan plan{chainman.m_blockman.PlanPruning(MIN_DISK_SPACE_FOR_BLOCK_FILES, chainstate.m_chain.Height(), chainstate, chainman)};
+    BOOST_CHECK(plan.files.empty());
+    BOOST_CHECK_GT(plan.usage_before, 0U);
+    BOOST_CHECK_EQUAL(plan.usage_before, chainman.m_blockman.CalculateCurrentUsage());
+    BOOST_CHECK_EQUAL(plan.usage_after, plan.usage_before);
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_read_raw_block, TestChain100Setup)
+{
+    auto& blockman{Assert(m_node.chainman)->m_blockman};
+    const CBlockIndex* tip{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip())};
+
+    // The raw block of an index is its network serialization
+    CBlock block;
+    BOOST_REQUIRE(blockman.ReadBlockFromDisk(block, *tip));
+    std::vector<uint8_t> raw_block;
+    BOOST_REQUIRE(blockman.ReadRawBlockFromDisk(raw_block, *tip));
+    DataStream expected;
+    expected << TX_WITH_WITNESS(block);
+    BOOST_CHECK_EQUAL(HexStr(raw_block), HexStr(expected));
+
+    // A block stored at the position of an index that is not its own is rejected
+    CBlockIndex wrong_pos{block};
+    wrong_pos.phashBlock = tip->phashBlock;
+    {
+        LOCK(::cs_main);
+        wrong_pos.nStatus = tip->nStatus;
+        wrong_pos.nFile = tip->pprev->nFile;
+        wrong_pos.nDataPos = tip->pprev->nDataPos;
+    }
+    BOOST_CHECK(!blockman.ReadRawBlockFromDisk(raw_block, wrong_pos));
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_header_store, TestChain100Setup)
+{
+    auto& blockman{Assert(m_node.chainman)->m_blockman};
+    LOCK(::cs_main);
+    const CChain& chain{m_node.chainman->ActiveChain()};
+    const HeaderStore::ReadHeaderFn read_header{[&](const CBlockIndex& index, CBlockHeader& header) {
+        return blockman.ReadBlockHeader(header, index);
+    }};
+    const auto header_at{[&](int height) {
+        CBlockHeader header;
+        BOOST_REQUIRE(blockman.ReadBlockHeader(header, *chain[height]));
+        return header;
+    }};
+    const fs::path path{m_args.GetDataDirNet() / "headers_test.dat"};
+    std::vector<uint8_t> raw;
+    {
+        HeaderStore store{path};
+        BOOST_CHECK(!store.Read(0, 1, chain.Genesis()->GetBlockHash(), raw));
+        int batches{1};
+        while (!store.Sync(chain, /*max_count=*/30, read_header)) ++batches;
+        BOOST_CHECK_EQUAL(batches, 4);
+        BOOST_CHECK_EQUAL(store.Height(), chain.Height());
+
+        // A range is read as the serialized headers of its blocks
+        std::vector<uint8_t> expected;
+        VectorWriter writer{expected, 0};
+        for (int height{10}; height < 20; ++height) writer << header_at(height);
+        BOOST_CHECK(store.Read(10, 10, chain[19]->GetBlockHash(), raw));
+        BOOST_CHECK(raw == expected);
+        BOOST_CHECK(!store.Read(10, 10, chain[18]->GetBlockHash(), raw));
+        BOOST_CHECK(!store.Read(chain.Height(), 2, chain.Tip()->GetBlockHash(), raw));
+
+        // Only headers following the stored ones are appended
+        store.Truncate(50);
+        BOOST_CHECK_EQUAL(store.Height(), 49);
+        store.Append(60, header_at(60));
+        BOOST_CHECK_EQUAL(store.Height(), 49);
+        // A header that does not link to the stored tip empties the store
+        store.Append(50, header_at(51));
+        BOOST_CHECK_EQUAL(store.Height(), -1);
+        BOOST_CHECK(!store.Read(0, 1, chain.Genesis()->GetBlockHash(), raw));
+        while (!store.Sync(chain, /*max_count=*/30, read_header)) {}
+        // Store a header that is not in the chain
+        store.Truncate(50);
+        CBlockHeader fork{header_at(50)};
+        ++fork.nNonce;
+        store.Append(50, fork);
+        BOOST_CHECK_EQUAL(store.Height(), 50);
+    }
+
+    // Reopening the file drops the headers that are not in the chain and
+    // appends the missing ones
+    HeaderStore store{path};
+    BOOST_CHECK_EQUAL(store.Height(), -1);
+    BOOST_CHECK(store.Sync(chain, /*max_count=*/1000, read_header));
+    BOOST_CHECK_EQUAL(store.Height(), chain.Height());
+    BOOST_CHECK(store.Read(0, chain.Height() + 1, chain.Tip()->GetBlockHash(), raw));
+    SpanReader stream{raw};
+    for (int height{0}; height <= chain.Height(); ++height) {
+        CBlockHeader header;
+        stream >> header;
+        BOOST_CHECK(header.GetHash() == chain[height]->GetBlockHash());
+    }
+
+    // Headers of the active chain are read from the node's store once it is
+    // synced, and others one at a time, with the same result
+    BOOST_CHECK(blockman.m_header_store.Sync(chain, /*max_count=*/1000, read_header));
+    std::vector<uint8_t> expected;
+    VectorWriter writer{expected, 0};
+    for (int height{98}; height <= 100; ++height) writer << header_at(height);
+    const std::vector<const CBlockIndex*> blocks{chain[98], chain[99], chain[100]};
+    BOOST_CHECK(blockman.ReadBlockHeaders(blocks, raw));
+    BOOST_CHECK(raw == expected);
+    // A store that holds only some of them serves those, and the rest are
+    // rebuilt
+    blockman.m_header_store.Truncate(99);
+    BOOST_CHECK(blockman.ReadBlockHeaders(blocks, raw));
+    BOOST_CHECK(raw == expected);
+    blockman.m_header_store.Truncate(0);
+    BOOST_CHECK(blockman.ReadBlockHeaders(blocks, raw));
+    BOOST_CHECK(raw == expected);
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_load_block_index_guts, TestChain100Setup)
+{
+    auto& chainman{*Assert(m_node.chainman)};
+    auto& blockman{chainman.m_blockman};
+    LOCK(::cs_main);
+    chainman.ActiveChainstate().ForceFlushStateToDisk();
+
+    // Reloading the block tree database, which is read in hash ranges on
+    // worker threads, gives back the same block index.
+    BlockMap block_index;
+    BOOST_REQUIRE(blockman.m_block_tree_db->LoadBlockIndexGuts(
+        chainman.GetConsensus(), [&](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) -> CBlockIndex* {
+            if (hash.IsNull()) return nullptr;
+            const auto [it, inserted]{block_index.try_emplace(hash)};
+            if (inserted) it->second.phashBlock = &it->first;
+            return &it->second;
+        },
+        chainman.m_interrupt));
+    BOOST_CHECK_EQUAL(block_index.size(), blockman.m_block_index.size());
+    for (const auto& [hash, loaded] : block_index) {
+        const CBlockIndex* pindex{blockman.LookupBlockIndex(hash)};
+        BOOST_REQUIRE(pindex);
+        BOOST_CHECK_EQUAL(loaded.nHeight, pindex->nHeight);
+        BOOST_CHECK_EQUAL(loaded.nStatus, pindex->nStatus);
+        BOOST_CHECK_EQUAL(loaded.nTx, pindex->nTx);
+        BOOST_CHECK_EQUAL(loaded.nTime, pindex->nTime);
+        BOOST_CHECK_EQUAL(loaded.nDataPos, pindex->nDataPos);
+        BOOST_CHECK((loaded.pprev ? loaded.pprev->GetBlockHash() : uint256{}) ==
+                    (pindex->pprev ? pindex->pprev->GetBlockHash() : uint256{}));
+    }
+
+    // Entries come back sorted by height
+    const std::vector<CBlockIndex*> by_height{blockman.GetAllBlockIndicesByHeight()};
+    BOOST_CHECK_EQUAL(by_height.size(), blockman.m_block_index.size());
+    for (size_t i = 1; i < by_height.size(); ++i) {
+        BOOST_CHECK_LE(by_height[i - 1]->nHeight, by_height[i]->nHeight);
+    }
+    BOOST_CHECK_EQUAL(by_height.back(), chainman.ActiveTip());
+
+    // A height out of range of the index, as read from a corrupt database,
+    // falls back to a comparison sort instead of indexing out of bounds.
+    CBlockIndex& corrupt{*chainman.ActiveTip()};
+    const int height{corrupt.nHeight};
+    corrupt.nHeight = -1;
+    BOOST_CHECK_EQUAL(blockman.GetAllBlockIndicesByHeight().front(), &corrupt);
+    corrupt.nHeight = std::numeric_limits<int>::max();
+    BOOST_CHECK_EQUAL(blockman.GetAllBlockIndicesByHeight().back(), &corrupt);
+    corrupt.nHeight = height;
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_load_external_block_file_out_of_order, RegTestingSetup)
+{
+    auto& chainman{*Assert(m_node.chainman)};
+    const auto blocks{CreateBlockChain(20, Params())};
+
+    // Write the blocks in reverse order, so that the parent of each block is
+    // read after it. Such children are kept in memory, even without tracking
+    // of unknown parents across files.
+    const fs::path block_file{m_path_root / "import.dat"};
+    {
+        AutoFile file{fsbridge::fopen(block_file, "wb")};
+        for (auto it{blocks.rbegin()}; it != blocks.rend(); ++it) {
+            const unsigned int size{static_cast<unsigned int>(GetSerializeSize(TX_WITH_WITNESS(**it)))};
+            file << Params().MessageStart() << size << TX_WITH_WITNESS(**it);
+        }
+    }
+    AutoFile file{fsbridge::fopen(block_file, "rb")};
+    chainman.LoadExternalBlockFile(file);
+
+    LOCK(::cs_main);
+    for (const auto& block : blocks) {
+        const CBlockIndex* pindex{chainman.m_blockman.LookupBlockIndex(block->GetHash())};
+        BOOST_REQUIRE(pindex);
+        BOOST_CHECK(pindex->nStatus & BLOCK_HAVE_DATA);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_block_prefetcher, TestChain100Setup)
+{
+    auto& chainman{*Assert(m_node.chainman)};
+    const CBlockIndex* tip{WITH_LOCK(::cs_main, return chainman.ActiveTip())};
+    std::vector<const CBlockIndex*> blocks;
+    for (const CBlockIndex* pindex{tip}; blocks.size() < 10; pindex = pindex->pprev) {
+        blocks.push_back(pindex);
+    }
+
+    {
+        BlockPrefetcher prefetcher{chainman.m_blockman};
+        LOCK(::cs_main);
+
+        // Prefetched blocks and undo data match what is read from disk
+        prefetcher.PrefetchDisconnect(blocks, std::numeric_limits<size_t>::max());
+        for (const CBlockIndex* pindex : blocks) {
+            const std::shared_ptr<const CBlock> block{prefetcher.TakeBlock(*pindex)};
+            BOOST_REQUIRE(block);
+            BOOST_CHECK(block->GetHash() == pindex->GetBlockHash());
+            CBlockUndo undo, undo_read;
+            BOOST_REQUIRE(prefetcher.TakeUndo(*pindex, undo));
+            BOOST_REQUIRE(chainman.m_blockman.UndoReadFromDisk(undo_read, *pindex));
+            BOOST_CHECK_EQUAL(GetSerializeSize(undo), GetSerializeSize(undo_read));
+            // Data is handed out once
+            BOOST_CHECK(!prefetcher.TakeBlock(*pindex));
+            BOOST_CHECK(!prefetcher.TakeUndo(*pindex, undo));
+        }
+
+        // Reads stop at the block count and memory limits
+        prefetcher.PrefetchConnect(blocks, /*max_bytes=*/0);
+        BOOST_CHECK(!prefetcher.TakeBlock(*tip));
+        std::vector<const CBlockIndex*> many_blocks;
+        for (const CBlockIndex* pindex{tip}; pindex; pindex = pindex->pprev) {
+            many_blocks.push_back(pindex);
+        }
+        prefetcher.PrefetchConnect(many_blocks, std::numeric_limits<size_t>::max());
+        BOOST_CHECK(prefetcher.TakeBlock(*many_blocks[MAX_BLOCK_PREFETCH - 1]));
+        BOOST_CHECK(!prefetcher.TakeBlock(*many_blocks[MAX_BLOCK_PREFETCH]));
+
+        // Blocks no longer in the list are dropped
+        prefetcher.PrefetchConnect({tip}, std::numeric_limits<size_t>::max());
+        BOOST_CHECK(!prefetcher.TakeBlock(*tip->pprev));
+        BOOST_CHECK(prefetcher.TakeBlock(*tip));
+    }
+
+    // Reorganizing away from and back to the tip connects and disconnects
+    // prefetched blocks
+    Chainstate& chainstate{chainman.ActiveChainstate()};
+    CBlockIndex* fork{WITH_LOCK(::cs_main, return chainman.ActiveChain()[tip->nHeight - 10])};
+    BlockValidationState state;
+    BOOST_REQUIRE(chainstate.InvalidateBlock(state, fork));
+    BOOST_CHECK_EQUAL(WITH_LOCK(::cs_main, return chainman.ActiveHeight()), fork->nHeight - 1);
+    WITH_LOCK(::cs_main, chainstate.ResetBlockFailureFlags(fork));
+    BOOST_REQUIRE(chainstate.ActivateBestChain(state));
+    BOOST_CHECK_EQUAL(WITH_LOCK(::cs_main, return chainman.ActiveTip()), tip);
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_recent_blocks, TestChain100Setup)
+{
+    auto& chainman{*Assert(m_node.chainman)};
+    const CBlockIndex* tip{WITH_LOCK(::cs_main, return chainman.ActiveTip())};
+
+    // Connected blocks are cached, the tip being the most recent one
+    BOOST_CHECK_EQUAL(chainman.m_blockman.m_recent_blocks.Size(), node::RECENT_BLOCKS_CACHE_SIZE);
+    const std::shared_ptr<const CBlock> tip_block{chainman.m_blockman.m_recent_blocks.GetBlock(tip->GetBlockHash())};
+    BOOST_REQUIRE(tip_block);
+    BOOST_CHECK(tip_block->GetHash() == tip->GetBlockHash());
+
+    std::vector<std::shared_ptr<const CBlock>> blocks;
+    for (const CBlockIndex* pindex{tip}; blocks.size() < 3; pindex = pindex->pprev) {
+        auto block{std::make_shared<CBlock>()};
+        BOOST_REQUIRE(chainman.m_blockman.ReadBlockFromDisk(*block, *pindex));
+        blocks.push_back(std::move(block));
+    }
+
+    RecentBlocks recent_blocks{/*max_blocks=*/2};
+    recent_blocks.Add(blocks[0]);
+    recent_blocks.Add(blocks[1]);
+    BOOST_CHECK(!recent_blocks.GetBlock(blocks[2]->GetHash()));
+    BOOST_CHECK(!recent_blocks.GetSerializedBlock(blocks[2]->GetHash(), /*with_witness=*/true));
+
+    // Serializations match the block, with and without witness data, and are kept
+    for (const bool with_witness : {true, false}) {
+        const auto serialized{recent_blocks.GetSerializedBlock(blocks[0]->GetHash(), with_witness)};
+        BOOST_REQUIRE(serialized);
+        DataStream expected;
+        if (with_witness) {
+            expected << TX_WITH_WITNESS(*blocks[0]);
+        } else {
+            expected << TX_NO_WITNESS(*blocks[0]);
+        }
+        BOOST_CHECK_EQUAL(HexStr(*serialized), HexStr(expected));
+        BOOST_CHECK_EQUAL(recent_blocks.GetSerializedBlock(blocks[0]->GetHash(), with_witness), serialized);
+    }
+
+    // The least recently used block is evicted
+    recent_blocks.Add(blocks[2]);
+    BOOST_CHECK_EQUAL(recent_blocks.Size(), 2U);
+    BOOST_CHECK(recent_blocks.GetBlock(blocks[0]->GetHash()));
+    BOOST_CHECK(!recent_blocks.GetBlock(blocks[1]->GetHash()));
+    BOOST_CHECK(recent_blocks.GetBlock(blocks[2]->GetHash()));
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_shared_block_reader, TestChain100Setup)
+{
+    auto& chainman{*Assert(m_node.chainman)};
+    const CBlockIndex* tip{WITH_LOCK(::cs_main, return chainman.ActiveTip())};
+    const CBlockIndex* prev{tip->pprev};
+
+    SharedBlockReader reader{chainman.m_blockman};
+    reader.BeginSync();
+    const auto block{reader.ReadBlock(*tip)};
+    const auto undo{reader.ReadUndo(*tip)};
+    BOOST_REQUIRE(block && undo);
+    BOOST_CHECK(block->GetHash() == tip->GetBlockHash());
+    BOOST_CHECK_EQUAL(undo->vtxundo.size() + 1, block->vtx.size());
+
+    // Reads are sized by their records on disk
+    unsigned int block_size{0}, undo_size{0};
+    CBlock disk_block;
+    CBlockUndo disk_undo;
+    BOOST_REQUIRE(chainman.m_blockman.ReadBlockFromDisk(disk_block, *tip, &block_size));
+    BOOST_REQUIRE(chainman.m_blockman.UndoReadFromDisk(disk_undo, *tip, &undo_size));
+    BOOST_CHECK_EQUAL(block_size, GetSerializeSize(TX_WITH_WITNESS(*block)));
+    BOOST_CHECK_EQUAL(undo_size, GetSerializeSize(*undo));
+    const size_t tip_size{reader.Size()};
+    BOOST_CHECK_EQUAL(tip_size, block_size + undo_size);
+
+    // Reads are shared
+    BOOST_CHECK_EQUAL(reader.ReadBlock(*tip), block);
+    BOOST_CHECK_EQUAL(reader.ReadUndo(*tip), undo);
+    BOOST_CHECK_EQUAL(reader.Size(), tip_size);
+
+    // They are released once the last index catching up is done
+    reader.BeginSync();
+    reader.EndSync();
+    BOOST_CHECK_EQUAL(reader.Size(), tip_size);
+    reader.EndSync();
+    BOOST_CHECK_EQUAL(reader.Size(), 0U);
+    BOOST_CHECK(reader.ReadBlock(*tip) != block);
+    BOOST_CHECK_EQUAL(reader.Size(), 0U);
+
+    // The oldest reads are dropped beyond the maximum size
+    SharedBlockReader small_reader{chainman.m_blockman, /*max_size=*/tip_size};
+    small_reader.BeginSync();
+    BOOST_REQUIRE(small_reader.ReadBlock(*tip));
+    BOOST_REQUIRE(small_reader.ReadUndo(*tip));
+    const auto prev_block{small_reader.ReadBlock(*prev)};
+    BOOST_REQUIRE(prev_block);
+    BOOST_CHECK(prev_block->GetHash() == prev->GetBlockHash());
+    BOOST_CHECK_EQUAL(small_reader.Size(), GetSerializeSize(TX_WITH_WITNESS(*prev_block)));
+    BOOST_CHECK(small_reader.ReadBlock(*tip) != block);
+    small_reader.EndSync();
+}
+
+BOOST_AUTO_TEST_CASE(blockmanager_block_file_writer)
+{
+    KernelNotifications notifications{*Assert(m_node.shutdown), m_node.exit_status};
+    const fs::path blocks_dir{m_path_root / "writer"};
+    FlatFileSeq block_files{blocks_dir, "blk", 0x1000};
+    // A queue smaller than the data makes writers wait for each other
+    BlockFileWriter writer{block_files, FlatFileSeq{blocks_dir, "rev", 0x1000}, notifications, /*max_queued_bytes=*/100};
+
+    std::vector<uint8_t> expected;
+    for (int i{0}; i < 10; ++i) {
+        const std::vector<uint8_t> data(64, uint8_t(i));
+        writer.Write(BlockFileWriter::FileType::BLOCK, FlatFilePos{0, static_cast<unsigned int>(expected.size())}, data);
+        expected.insert(expected.end(), data.begin(), data.end());
+    }
+
+    // Queued data is in the file once its writes are waited for
+    writer.WaitForWrites(BlockFileWriter::FileType::BLOCK, 0);
+    {
+        AutoFile file{block_files.Open(FlatFilePos{0, 0}, /*read_only=*/true)};
+        BOOST_REQUIRE(!file.IsNull());
+        std::vector<uint8_t> read(expected.size());
+        file.read(MakeWritableByteSpan(read));
+        BOOST_CHECK(read == expected);
+    }
+
+    // Finalizing the file trims its preallocated space
+    bool out_of_space;
+    block_files.Allocate(FlatFilePos{0, 0}, expected.size(), out_of_space);
+    BOOST_CHECK_GT(fs::file_size(block_files.FileName(FlatFilePos{0, 0})), expected.size());
+    writer.Flush(BlockFileWriter::FileType::BLOCK, FlatFilePos{0, static_cast<unsigned int>(expected.size())}, /*finalize=*/true);
+    BOOST_CHECK(writer.Sync());
+    BOOST_CHECK_EQUAL(fs::file_size(block_files.FileName(FlatFilePos{0, 0})), expected.size());
+
+    // Removed files are not created again by flushes queued before
+    writer.Flush(BlockFileWriter::FileType::BLOCK, FlatFilePos{0, static_cast<unsigned int>(expected.size())}, /*finalize=*/false);
+    writer.Remove(0);
+    BOOST_CHECK(writer.Sync());
+    BOOST_CHECK(!fs::exists(block_files.FileName(FlatFilePos{0, 0})));
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_compact_block_files, TestChain100Setup)
+{
+    const fs::path blocks_dir{m_path_root / "compact_blocks"};
+    fs::create_directories(blocks_dir);
+    KernelNotifications notifications{*Assert(m_node.shutdown), m_node.exit_status};
+    const BlockManager::Options blockman_opts{
+        .chainparams = Params(),
+        .compact_block_files = true,
+        .blocks_dir = blocks_dir,
+        .notifications = notifications,
+    };
+    BlockManager blockman{*Assert(m_node.shutdown), blockman_opts};
+    auto& chainman{*Assert(m_node.chainman)};
+
+    const auto network_serialization{[](const CBlock& block) {
+        DataStream stream;
+        stream << TX_WITH_WITNESS(block);
+        return HexStr(stream);
+    }};
+
+    // Blocks read back and are served in network serialization
+    uint64_t network_size{0};
+    for (int height{1}; height <= 100; ++height) {
+        const CBlockIndex* pindex{WITH_LOCK(::cs_main, return chainman.ActiveChain()[height])};
+        CBlock block;
+        BOOST_REQUIRE(chainman.m_blockman.ReadBlockFromDisk(block, *pindex));
+        BOOST_REQUIRE(CanStoreCompact(block));
+        network_size += GetSerializeSize(TX_WITH_WITNESS(block)) + BLOCK_SERIALIZATION_HEADER_SIZE;
+
+        const FlatFilePos pos{blockman.SaveBlockToDisk(block, height, /*dbp=*/nullptr)};
+        BOOST_REQUIRE(!pos.IsNull());
+        CBlock read_block;
+        BOOST_REQUIRE(blockman.ReadBlockFromDisk(read_block, pos));
+        BOOST_CHECK(read_block.GetHash() == block.GetHash());
+        BOOST_CHECK_EQUAL(network_serialization(read_block), network_serialization(block));
+        std::vector<uint8_t> raw_block;
+        BOOST_REQUIRE(blockman.ReadRawBlockFromDisk(raw_block, pos));
+        BOOST_CHECK_EQUAL(HexStr(raw_block), network_serialization(block));
+    }
+    BOOST_CHECK_LT(blockman.CalculateCurrentUsage(), network_size);
+
+    // Transactions spending earlier transactions of the same block, with
+    // witness data. The block is not valid, so only its raw form is read.
+    CBlock block;
+    CMutableTransaction tx1;
+    tx1.vin.emplace_back(COutPoint{Txid::FromUint256(InsecureRand256()), 3});
+    tx1.vin[0].nSequence = 0xfffffffd;
+    tx1.vout.emplace_back(50 * COIN, CScript() << OP_0 << std::vector<unsigned char>(20, 0x42));
+    tx1.vout.emplace_back(12345, CScript() << OP_RETURN << std::vector<unsigned char>(10, 0x01));
+    CMutableTransaction tx2;
+    tx2.vin.emplace_back(COutPoint{tx1.GetHash(), 0});
+    tx2.vin[0].scriptWitness.stack = {std::vector<unsigned char>(72, 0x30), std::vector<unsigned char>(33, 0x02)};
+    tx2.vout.emplace_back(49 * COIN, CScript() << OP_TRUE);
+    tx2.nLockTime = 100;
+    block.vtx = {MakeTransactionRef(tx1), MakeTransactionRef(tx2)};
+    BOOST_REQUIRE(CanStoreCompact(block));
+    const auto usage_before{blockman.CalculateCurrentUsage()};
+    FlatFilePos pos{blockman.SaveBlockToDisk(block, 101, /*dbp=*/nullptr)};
+    BOOST_CHECK_LT(blockman.CalculateCurrentUsage() - usage_before, GetSerializeSize(TX_WITH_WITNESS(block)) + BLOCK_SERIALIZATION_HEADER_SIZE);
+    std::vector<uint8_t> raw_block;
+    BOOST_REQUIRE(blockman.ReadRawBlockFromDisk(raw_block, pos));
+    BOOST_CHECK_EQUAL(HexStr(raw_block), network_serialization(block));
+
+    // Blocks that do not survive compression are stored in network serialization
+    tx2.vout[0].nValue = -1;
+    block.vtx[1] = MakeTransactionRef(tx2);
+    BOOST_CHECK(!CanStoreCompact(block));
+    const auto usage_network{blockman.CalculateCurrentUsage()};
+    pos = blockman.SaveBlockToDisk(block, 102, /*dbp=*/nullptr);
+    BOOST_CHECK_EQUAL(blockman.CalculateCurrentUsage() - usage_network, GetSerializeSize(TX_WITH_WITNESS(block)) + BLOCK_SERIALIZATION_HEADER_SIZE);
+    BOOST_REQUIRE(blockman.ReadRawBlockFromDisk(raw_block, pos));
+    BOOST_CHECK_EQUAL(HexStr(raw_block), network_serialization(block));
 }
 
 BOOST_AUTO_TEST_SUITE_END()
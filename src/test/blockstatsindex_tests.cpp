@@ -0,0 +1,90 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockstats.h>
+#include <chain.h>
+#include <consensus/validation.h>
+#include <index/blockstatsindex.h>
+#include <interfaces/chain.h>
+#include <streams.h>
+#include <test/util/index.h>
+#include <test/util/setup_common.h>
+#include <undo.h>
+#include <validation.h>
+
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(blockstatsindex_tests)
+
+static bool StatsEqual(const BlockStats& a, const BlockStats& b)
+{
+    DataStream ser_a{}, ser_b{};
+    ser_a << a;
+    ser_b << b;
+    return ser_a.str() == ser_b.str();
+}
+
+BOOST_FIXTURE_TEST_CASE(blockstatsindex_initial_sync, TestChain100Setup)
+{
+    BlockStatsIndex stats_index{interfaces::MakeChain(m_node), 1 << 20, true};
+    BOOST_REQUIRE(stats_index.Init());
+
+    // Spend a coinbase output so that the statistics include fees
+    const CScript coinbase_script{CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG};
+    const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 1, coinbaseKey, coinbase_script, 10 * COIN, /*submit=*/false)};
+    const CBlock spend_block{CreateAndProcessBlock({spend}, coinbase_script)};
+
+    const CBlockIndex* tip{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip())};
+    BlockStats stats;
+    BOOST_CHECK(!stats_index.LookupStats(*tip, stats));
+
+    BOOST_REQUIRE(stats_index.StartBackgroundSync());
+    IndexWaitSynced(stats_index, *Assert(m_node.shutdown));
+
+    // Indexed statistics match those computed from the block and its undo data
+    CBlockUndo block_undo;
+    BOOST_REQUIRE(m_node.chainman->m_blockman.UndoReadFromDisk(block_undo, *tip));
+    const BlockStats expected{ComputeBlockStats(spend_block, &block_undo)};
+    BOOST_REQUIRE(stats_index.LookupStats(*tip, stats));
+    BOOST_CHECK(StatsEqual(stats, expected));
+    BOOST_CHECK_EQUAL(stats.txs, 2);
+    BOOST_CHECK_EQUAL(stats.ins, 1);
+    BOOST_CHECK(stats.totalfee > 0);
+
+    // A range lookup returns the statistics in height order
+    std::vector<BlockStats> range;
+    BOOST_REQUIRE(stats_index.LookupStatsRange(0, *tip, range));
+    BOOST_REQUIRE_EQUAL(range.size(), size_t(tip->nHeight + 1));
+    BOOST_CHECK(StatsEqual(range.back(), expected));
+    BOOST_CHECK_EQUAL(range.front().txs, 1);
+
+    // Statistics of a disconnected block are no longer returned
+    {
+        BlockValidationState state;
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, const_cast<CBlockIndex*>(tip)));
+    }
+    CreateAndProcessBlock({}, CScript() << OP_TRUE);
+    BOOST_REQUIRE(stats_index.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(!stats_index.LookupStats(*tip, stats));
+    const CBlockIndex* new_tip{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip())};
+    BOOST_REQUIRE(stats_index.LookupStats(*new_tip, stats));
+    BOOST_CHECK_EQUAL(stats.txs, 1);
+    BOOST_CHECK(!stats_index.LookupStatsRange(0, *tip, range));
+    BOOST_CHECK(stats_index.LookupStatsRange(0, *new_tip, range));
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification. The BlockUntilSyncedToCurrentChain()
+    // call above is sufficient to ensure this, but the
+    // SyncWithValidationInterfaceQueue() call below is also needed to ensure
+    // TSAN always sees the test thread waiting for the notification thread, and
+    // avoid potential false positive reports.
+    SyncWithValidationInterfaceQueue();
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    stats_index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
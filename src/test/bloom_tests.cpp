@@ -539,4 +539,39 @@ BOOST_AUTO_TEST_CASE(rolling_bloom)
     g_mock_deterministic_tests = false;
 }
 
+BOOST_AUTO_TEST_CASE(blocked_bloom)
+{
+    CBlockedBloomFilter filter(1000);
+    std::vector<uint64_t> keys(1000);
+    for (auto& key : keys) {
+        key = InsecureRandBits(64);
+        filter.insert(key);
+    }
+    // No false negatives, also past the number of elements it is sized for
+    for (const uint64_t key : keys) {
+        BOOST_CHECK(filter.contains(key));
+    }
+
+    // About 1% false positives
+    unsigned int nHits = 0;
+    for (int i = 0; i < 10000; i++) {
+        if (filter.contains(InsecureRandBits(64))) ++nHits;
+    }
+    BOOST_CHECK_LT(nHits, 200U);
+
+    for (int i = 0; i < 3000; i++) {
+        const uint64_t key{InsecureRandBits(64)};
+        filter.insert(key);
+        BOOST_CHECK(filter.contains(key));
+    }
+    for (const uint64_t key : keys) {
+        BOOST_CHECK(filter.contains(key));
+    }
+
+    // A filter sized for MaxElements stays within the memory given
+    for (const size_t max_memory : {size_t{64}, size_t{1000}, size_t{1 << 20}}) {
+        BOOST_CHECK_LE(CBlockedBloomFilter(CBlockedBloomFilter::MaxElements(max_memory)).GetMemoryUsage(), max_memory);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
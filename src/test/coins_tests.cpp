@@ -15,7 +15,9 @@
 #include <undo.h>
 #include <util/strencodings.h>
 
+#include <algorithm>
 #include <map>
+#include <optional>
 #include <vector>
 
 #include <boost/test/unit_test.hpp>
@@ -1085,6 +1087,53 @@ BOOST_AUTO_TEST_CASE(ccoins_flush_behavior)
     }
 }
 
+BOOST_AUTO_TEST_CASE(coins_db_range_cursor)
+{
+    CCoinsViewDB base{{.path = "test", .cache_bytes = 1 << 23, .memory_only = true}, {}};
+    {
+        CCoinsViewCache cache{&base};
+        for (int i = 0; i < 1000; ++i) {
+            Coin coin;
+            coin.out.nValue = InsecureRandMoneyAmount();
+            coin.nHeight = 1;
+            cache.AddCoin(COutPoint{Txid::FromUint256(InsecureRand256()), uint32_t(InsecureRandRange(4))}, std::move(coin), /*possible_overwrite=*/false);
+        }
+        cache.SetBestBlock(InsecureRand256());
+        BOOST_CHECK(cache.Flush());
+    }
+
+    const auto collect{[](CCoinsViewCursor& cursor) {
+        std::vector<COutPoint> outpoints;
+        for (; cursor.Valid(); cursor.Next()) {
+            COutPoint key;
+            BOOST_CHECK(cursor.GetKey(key));
+            outpoints.push_back(key);
+        }
+        return outpoints;
+    }};
+    const std::vector<COutPoint> all{collect(*base.Cursor())};
+    BOOST_CHECK(std::is_sorted(all.begin(), all.end()));
+
+    // Split the txid space at random points; the concatenation of the ranges must
+    // match a full scan.
+    std::vector<uint256> splits{uint256::ZERO};
+    for (int i = 0; i < 7; ++i) splits.push_back(InsecureRand256());
+    std::sort(splits.begin(), splits.end());
+    std::vector<COutPoint> ranged;
+    for (size_t i = 0; i < splits.size(); ++i) {
+        const std::optional<uint256> end{i + 1 < splits.size() ? std::make_optional(splits[i + 1]) : std::nullopt};
+        for (const COutPoint& outpoint : collect(*base.Cursor(splits[i], end))) {
+            BOOST_CHECK(!(outpoint.hash.ToUint256() < splits[i]));
+            if (end) BOOST_CHECK(outpoint.hash.ToUint256() < *end);
+            ranged.push_back(outpoint);
+        }
+    }
+    BOOST_CHECK(ranged == all);
+
+    // Empty range
+    BOOST_CHECK(!base.Cursor(splits[1], splits[1])->Valid());
+}
+
 BOOST_AUTO_TEST_CASE(coins_resource_is_used)
 {
     CCoinsMapMemoryResource resource;
@@ -10,8 +10,11 @@
 #include <test/util/index.h>
 #include <test/util/setup_common.h>
 #include <test/util/validation.h>
+#include <txdb.h>
 #include <validation.h>
 
+#include <optional>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_SUITE(coinstatsindex_tests)
@@ -77,6 +80,34 @@ BOOST_FIXTURE_TEST_CASE(coinstatsindex_initial_sync, TestChain100Setup)
     coin_stats_index.Stop();
 }
 
+BOOST_FIXTURE_TEST_CASE(coinstatsindex_matches_utxo_set, TestChain100Setup)
+{
+    // Spend a coinbase output, so that blocks remove coins from the hash too
+    const CScript script_pub_key{CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG};
+    const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 1, coinbaseKey, script_pub_key, 10 * COIN, /*submit=*/false)};
+    CreateAndProcessBlock({spend}, script_pub_key);
+
+    CoinStatsIndex coin_stats_index{interfaces::MakeChain(m_node), 1 << 20, true};
+    BOOST_REQUIRE(coin_stats_index.Init());
+    BOOST_REQUIRE(coin_stats_index.StartBackgroundSync());
+    IndexWaitSynced(coin_stats_index, *Assert(m_node.shutdown));
+
+    // The blocks prepared in parallel add up to the hash of the UTXO set
+    Chainstate& chainstate{m_node.chainman->ActiveChainstate()};
+    WITH_LOCK(cs_main, chainstate.ForceFlushStateToDisk());
+    CCoinsViewDB& coins_db{WITH_LOCK(cs_main, return chainstate.CoinsDB())};
+    const auto utxo_stats{kernel::ComputeUTXOStats(kernel::CoinStatsHashType::MUHASH, &coins_db, m_node.chainman->m_blockman)};
+    const CBlockIndex* tip{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip())};
+    const auto index_stats{coin_stats_index.LookUpStats(*tip)};
+    BOOST_REQUIRE(utxo_stats && index_stats);
+    BOOST_CHECK_EQUAL(index_stats->hashSerialized, utxo_stats->hashSerialized);
+    BOOST_CHECK_EQUAL(index_stats->nTransactionOutputs, utxo_stats->nTransactionOutputs);
+    BOOST_CHECK(index_stats->total_amount == utxo_stats->total_amount);
+
+    SyncWithValidationInterfaceQueue();
+    coin_stats_index.Stop();
+}
+
 // Test shutdown between BlockConnected and ChainStateFlushed notifications,
 // make sure index is not corrupted and is able to reload.
 BOOST_FIXTURE_TEST_CASE(coinstatsindex_unclean_shutdown, TestChain100Setup)
@@ -119,4 +150,34 @@ BOOST_FIXTURE_TEST_CASE(coinstatsindex_unclean_shutdown, TestChain100Setup)
     }
 }
 
+//! Coins view without range cursors, forcing a sequential walk of the UTXO set
+class SequentialCoinsView : public CCoinsViewBacked
+{
+public:
+    using CCoinsViewBacked::CCoinsViewBacked;
+    using CCoinsViewBacked::Cursor;
+    std::unique_ptr<CCoinsViewCursor> Cursor(const uint256&, const std::optional<uint256>&) const override { return nullptr; }
+};
+
+BOOST_FIXTURE_TEST_CASE(coinstats_parallel_matches_sequential, TestChain100Setup)
+{
+    Chainstate& chainstate{m_node.chainman->ActiveChainstate()};
+    WITH_LOCK(cs_main, chainstate.ForceFlushStateToDisk());
+    CCoinsViewDB& coins_db{WITH_LOCK(cs_main, return chainstate.CoinsDB())};
+    SequentialCoinsView sequential{&coins_db};
+
+    for (const auto hash_type : {kernel::CoinStatsHashType::HASH_SERIALIZED, kernel::CoinStatsHashType::MUHASH, kernel::CoinStatsHashType::NONE}) {
+        const auto parallel_stats{kernel::ComputeUTXOStats(hash_type, &coins_db, m_node.chainman->m_blockman)};
+        const auto sequential_stats{kernel::ComputeUTXOStats(hash_type, &sequential, m_node.chainman->m_blockman)};
+        BOOST_REQUIRE(parallel_stats && sequential_stats);
+        BOOST_CHECK_EQUAL(parallel_stats->hashSerialized, sequential_stats->hashSerialized);
+        BOOST_CHECK_EQUAL(parallel_stats->nTransactions, sequential_stats->nTransactions);
+        BOOST_CHECK_EQUAL(parallel_stats->nTransactionOutputs, sequential_stats->nTransactionOutputs);
+        BOOST_CHECK_EQUAL(parallel_stats->nBogoSize, sequential_stats->nBogoSize);
+        BOOST_CHECK_EQUAL(parallel_stats->coins_count, sequential_stats->coins_count);
+        BOOST_CHECK(parallel_stats->total_amount == sequential_stats->total_amount);
+        BOOST_CHECK(parallel_stats->coins_count > 0);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -10,6 +10,8 @@
 #include <util/string.h>
 
 #include <memory>
+#include <set>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -385,6 +387,97 @@ BOOST_AUTO_TEST_CASE(iterator_string_ordering)
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_shared_block_cache)
+{
+    const size_t capacity{1 << 20};
+    auto cache{std::make_shared<DBBlockCache>(capacity)};
+    DBOptions options{.block_cache = cache};
+    {
+        CDBWrapper dbw1({.path = m_args.GetDataDirBase() / "shared_cache_1", .cache_bytes = 1 << 20, .memory_only = true, .options = options});
+        options.cache_priority = 0.5;
+        CDBWrapper dbw2({.path = m_args.GetDataDirBase() / "shared_cache_2", .cache_bytes = 1 << 20, .memory_only = true, .options = options});
+        BOOST_CHECK_EQUAL(cache->GetStats().size(), 2U);
+
+        // Write more than the write buffers hold, so that reads go through table blocks
+        const std::vector<unsigned char> value(1024, 'v');
+        for (uint32_t i = 0; i < 4096; ++i) {
+            BOOST_CHECK(dbw1.Write(i, value));
+            BOOST_CHECK(dbw2.Write(i, value));
+        }
+        std::vector<unsigned char> res;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (uint32_t i = 0; i < 4096; i += 64) {
+                BOOST_CHECK(dbw1.Read(i, res));
+                BOOST_CHECK(dbw2.Read(i, res));
+            }
+        }
+
+        const auto stats{cache->GetStats()};
+        BOOST_REQUIRE_EQUAL(stats.size(), 2U);
+        size_t usage{0};
+        for (const auto& db_stats : stats) {
+            BOOST_CHECK(db_stats.misses > 0);
+            BOOST_CHECK(db_stats.hits > 0);
+            BOOST_CHECK(db_stats.usage > 0);
+            usage += db_stats.usage;
+        }
+        BOOST_CHECK_EQUAL(stats[0].priority, 1.0);
+        BOOST_CHECK_EQUAL(stats[1].priority, 0.5);
+        BOOST_CHECK(usage <= cache->TotalCharge());
+        BOOST_CHECK(cache->TotalCharge() <= cache->Capacity());
+        BOOST_CHECK(dbw1.DynamicMemoryUsage() >= stats[0].usage);
+    }
+    // Closed databases are no longer reported
+    BOOST_CHECK(cache->GetStats().empty());
+}
+
+BOOST_AUTO_TEST_CASE(dbwrapper_compaction_threads)
+{
+    const fs::path ph = m_args.GetDataDirBase() / "compaction_threads";
+    const DBOptions options{.compaction_threads = 4};
+    const std::vector<unsigned char> value(512, 'v');
+    {
+        // A small write buffer produces many tables, which are compacted in
+        // ranges by several threads
+        CDBWrapper dbw({.path = ph, .cache_bytes = 1 << 18, .options = options});
+        for (int round = 0; round < 3; ++round) {
+            for (uint32_t i = 0; i < 4096; ++i) {
+                BOOST_CHECK(dbw.Write(i, std::make_pair(round, value)));
+            }
+            for (uint32_t i = round; i < 4096; i += 7) {
+                BOOST_CHECK(dbw.Erase(i));
+            }
+        }
+    }
+    // Reopening with force_compact merges everything into the last level
+    CDBWrapper dbw({.path = ph, .cache_bytes = 1 << 18, .options = {.force_compact = true, .compaction_threads = 4}});
+    BOOST_CHECK(dbw.SplitCompactions() > 0);
+    std::pair<int, std::vector<unsigned char>> res;
+    for (uint32_t i = 0; i < 4096; ++i) {
+        if (i % 7 == 2) {
+            BOOST_CHECK(!dbw.Exists(i));
+        } else {
+            BOOST_REQUIRE(dbw.Read(i, res));
+            BOOST_CHECK_EQUAL(res.first, 2);
+            BOOST_CHECK(res.second == value);
+        }
+    }
+
+    // Every live key is returned exactly once
+    std::unique_ptr<CDBIterator> it(dbw.NewIterator());
+    std::set<uint32_t> keys;
+    size_t count{0};
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        uint32_t key;
+        BOOST_REQUIRE(it->GetKey(key));
+        BOOST_CHECK(key % 7 != 2);
+        keys.insert(key);
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, keys.size());
+    BOOST_CHECK_EQUAL(keys.size(), 4096U - 585U);
+}
+
 BOOST_AUTO_TEST_CASE(unicodepath)
 {
     // Attempt to create a database with a UTF8 character in the path.
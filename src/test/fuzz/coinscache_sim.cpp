@@ -171,6 +171,7 @@ public:
     uint256 GetBestBlock() const final { return {}; }
     std::vector<uint256> GetHeadBlocks() const final { return {}; }
     std::unique_ptr<CCoinsViewCursor> Cursor() const final { return {}; }
+    std::unique_ptr<CCoinsViewCursor> Cursor(const uint256&, const std::optional<uint256>&) const final { return {}; }
     size_t EstimateSize() const final { return m_data.size(); }
 
     bool BatchWrite(CCoinsMap& data, const uint256&, bool erase) final
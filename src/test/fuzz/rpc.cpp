@@ -112,6 +112,9 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "generate",
     "generateblock",
     "getaddednodeinfo",
+    "getaddressbalance",
+    "getaddresshistory",
+    "getaddressutxos",
     "getaddrmaninfo",
     "getbestblockhash",
     "getblock",
@@ -122,11 +125,13 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "getblockhash",
     "getblockheader",
     "getblockstats",
+    "getblockstatsrange",
     "getblocktemplate",
     "getchaintips",
     "getchainstates",
     "getchaintxstats",
     "getconnectioncount",
+    "getdbcacheinfo",
     "getdeploymentinfo",
     "getdescriptorinfo",
     "getdifficulty",
@@ -143,10 +148,12 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "getnodeaddresses",
     "getpeerinfo",
     "getprioritisedtransactions",
+    "getpruneplan",
     "getrawaddrman",
     "getrawmempool",
     "getrawtransaction",
     "getrpcinfo",
+    "getspendinginfo",
     "gettxout",
     "gettxoutsetinfo",
     "gettxspendingprevout",
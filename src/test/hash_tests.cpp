@@ -114,6 +114,21 @@ BOOST_AUTO_TEST_CASE(siphash)
         BOOST_CHECK_EQUAL(hasher2.Finalize(), siphash_4_2_testvec[x]);
         hasher2.Write(Span{&x, 1});
     }
+    // Check test vectors from spec, as whole byte strings
+    std::vector<unsigned char> message;
+    for (uint8_t x=0; x<std::size(siphash_4_2_testvec); ++x)
+    {
+        BOOST_CHECK_EQUAL(SipHashBytes(0x0706050403020100ULL, 0x0F0E0D0C0B0A0908ULL, message), siphash_4_2_testvec[x]);
+        message.push_back(x);
+    }
+    // Check test vectors from spec, all byte strings at once
+    std::vector<Span<const unsigned char>> messages;
+    for (size_t x = 0; x < std::size(siphash_4_2_testvec); ++x) {
+        messages.push_back(Span{message}.first(x));
+    }
+    std::vector<uint64_t> hashes(messages.size());
+    SipHashBytesBatch(0x0706050403020100ULL, 0x0F0E0D0C0B0A0908ULL, messages, hashes);
+    BOOST_CHECK_EQUAL_COLLECTIONS(hashes.begin(), hashes.end(), std::begin(siphash_4_2_testvec), std::end(siphash_4_2_testvec));
     // Check test vectors from spec, eight bytes at a time
     CSipHasher hasher3(0x0706050403020100ULL, 0x0F0E0D0C0B0A0908ULL);
     for (uint8_t x=0; x<std::size(siphash_4_2_testvec); x+=8)
@@ -146,6 +161,23 @@ BOOST_AUTO_TEST_CASE(siphash)
         sip288.Write(nb);
         BOOST_CHECK_EQUAL(SipHashUint256(k1, k2, x), sip256.Finalize());
         BOOST_CHECK_EQUAL(SipHashUint256Extra(k1, k2, x, n), sip288.Finalize());
+        const std::vector<unsigned char> bytes{ctx.randbytes(ctx.randrange(300))};
+        BOOST_CHECK_EQUAL(SipHashBytes(k1, k2, bytes), CSipHasher(k1, k2).Write(bytes).Finalize());
+    }
+
+    // Check consistency between SipHashBytes and SipHashBytesBatch, with
+    // strings long enough to be hashed one at a time, and groups left over.
+    const uint64_t k1{ctx.rand64()};
+    const uint64_t k2{ctx.rand64()};
+    std::vector<std::vector<unsigned char>> strings;
+    for (int i = 0; i < 1000; ++i) {
+        strings.push_back(ctx.randbytes(ctx.randrange(ctx.randbool() ? 40 : 300)));
+    }
+    const std::vector<Span<const unsigned char>> spans(strings.begin(), strings.end());
+    std::vector<uint64_t> batch(spans.size());
+    SipHashBytesBatch(k1, k2, spans, batch);
+    for (size_t i = 0; i < spans.size(); ++i) {
+        BOOST_CHECK_EQUAL(batch[i], SipHashBytes(k1, k2, spans[i]));
     }
 }
 
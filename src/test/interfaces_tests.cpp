@@ -5,11 +5,15 @@
 
 #include <chainparams.h>
 #include <consensus/validation.h>
+#include <index/blockfilterindex.h>
 #include <interfaces/chain.h>
+#include <test/util/index.h>
 #include <test/util/setup_common.h>
 #include <script/solver.h>
 #include <validation.h>
 
+#include <algorithm>
+
 #include <boost/test/unit_test.hpp>
 
 using interfaces::FoundBlock;
@@ -163,4 +167,46 @@ BOOST_AUTO_TEST_CASE(hasBlocks)
     BOOST_CHECK(!chain->hasBlocks(active.Tip()->GetBlockHash(), 6, 50));
 }
 
+BOOST_AUTO_TEST_CASE(blockFiltersMatchAny)
+{
+    auto& chain = m_node.chain;
+    BOOST_REQUIRE(InitBlockFilterIndex([&]{ return interfaces::MakeChain(m_node); }, BlockFilterType::BASIC, 1 << 20, true));
+    BlockFilterIndex& filter_index{*Assert(GetBlockFilterIndex(BlockFilterType::BASIC))};
+    BOOST_REQUIRE(filter_index.Init());
+    BOOST_REQUIRE(filter_index.StartBackgroundSync());
+    IndexWaitSynced(filter_index, *Assert(m_node.shutdown));
+
+    // All blocks but the genesis block pay to the coinbase script
+    const CScript& coinbase_script{m_coinbase_txns[0]->vout[0].scriptPubKey};
+    const GCSFilter::ElementSet coinbase_set{{coinbase_script.begin(), coinbase_script.end()}};
+    const CBlockIndex* genesis{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Genesis())};
+    const CBlockIndex* block95{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain()[95])};
+
+    auto matches{chain->blockFiltersMatchAny(BlockFilterType::BASIC, genesis->GetBlockHash(), 1000, coinbase_set)};
+    BOOST_REQUIRE_EQUAL(matches.size(), 101U);
+    BOOST_CHECK(matches[0].first == genesis->GetBlockHash());
+    BOOST_CHECK(matches[0].second == false);
+    BOOST_CHECK(matches[95].first == block95->GetBlockHash());
+    for (size_t i = 1; i < matches.size(); ++i) {
+        BOOST_CHECK(matches[i].second == true);
+    }
+
+    // The range ends at the tip, or after max_count blocks
+    BOOST_CHECK_EQUAL(chain->blockFiltersMatchAny(BlockFilterType::BASIC, block95->GetBlockHash(), 1000, coinbase_set).size(), 6U);
+    matches = chain->blockFiltersMatchAny(BlockFilterType::BASIC, genesis->GetBlockHash(), 10, coinbase_set);
+    BOOST_REQUIRE_EQUAL(matches.size(), 10U);
+    BOOST_CHECK(matches[9].second == true);
+
+    const CScript other_script{CScript() << OP_TRUE};
+    matches = chain->blockFiltersMatchAny(BlockFilterType::BASIC, genesis->GetBlockHash(), 1000, {{other_script.begin(), other_script.end()}});
+    BOOST_REQUIRE_EQUAL(matches.size(), 101U);
+    BOOST_CHECK(std::none_of(matches.begin(), matches.end(), [](const auto& match) { return match.second != false; }));
+
+    // Blocks outside the active chain have no results
+    BOOST_CHECK(chain->blockFiltersMatchAny(BlockFilterType::BASIC, uint256::ONE, 1000, coinbase_set).empty());
+
+    filter_index.Stop();
+    DestroyAllBlockFilterIndexes();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1014,6 +1014,37 @@ BOOST_AUTO_TEST_CASE(advertise_local_address)
     RemoveLocal(addr_cjdns);
 }
 
+BOOST_AUTO_TEST_CASE(v1transport_shared_payload)
+{
+    // A message with a shared payload is sent like one owning the same bytes,
+    // and releases the payload once it is sent
+    const auto payload{std::make_shared<const std::vector<unsigned char>>(g_insecure_rand_ctx.randbytes<unsigned char>(1000))};
+    CSerializedNetMsg msg;
+    msg.m_type = NetMsgType::BLOCK;
+    msg.m_shared_data = payload;
+    BOOST_CHECK_EQUAL(msg.Payload().size(), payload->size());
+
+    V1Transport sender{0};
+    V1Transport receiver{1};
+    BOOST_REQUIRE(sender.SetMessageToSend(msg));
+    BOOST_CHECK_EQUAL(payload.use_count(), 2);
+    while (true) {
+        const auto& [to_send, more, msg_type] = sender.GetBytesToSend(/*have_next_message=*/false);
+        if (to_send.empty()) break;
+        Span<const uint8_t> bytes{to_send};
+        const size_t size{bytes.size()};
+        BOOST_REQUIRE(receiver.ReceivedBytes(bytes));
+        sender.MarkBytesSent(size - bytes.size());
+    }
+    BOOST_CHECK_EQUAL(payload.use_count(), 1);
+    BOOST_REQUIRE(receiver.ReceivedMessageComplete());
+    bool reject{false};
+    CNetMessage received{receiver.GetReceivedMessage({}, reject)};
+    BOOST_CHECK(!reject);
+    BOOST_CHECK_EQUAL(received.m_type, NetMsgType::BLOCK);
+    BOOST_CHECK_EQUAL(HexStr(received.m_recv), HexStr(*payload));
+}
+
 namespace {
 
 CKey GenerateRandomTestKey() noexcept
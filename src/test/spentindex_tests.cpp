@@ -0,0 +1,81 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <consensus/validation.h>
+#include <index/spentindex.h>
+#include <interfaces/chain.h>
+#include <test/util/index.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <optional>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(spentindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(spentindex_initial_sync, TestChain100Setup)
+{
+    SpentIndex spent_index{interfaces::MakeChain(m_node), 1 << 20, true};
+    BOOST_REQUIRE(spent_index.Init());
+
+    // Spend a coinbase output before the index is started
+    const CScript coinbase_script{CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG};
+    const CMutableTransaction first_spend{CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 1, coinbaseKey, coinbase_script, 10 * COIN, /*submit=*/false)};
+    CreateAndProcessBlock({first_spend}, coinbase_script);
+
+    const std::vector<COutPoint> outpoints{
+        {m_coinbase_txns[1]->GetHash(), 0},
+        {m_coinbase_txns[2]->GetHash(), 0},
+        {m_coinbase_txns[0]->GetHash(), 0},
+    };
+    std::vector<std::optional<SpentInfo>> found;
+
+    BOOST_REQUIRE(spent_index.StartBackgroundSync());
+    IndexWaitSynced(spent_index, *Assert(m_node.shutdown));
+
+    // Results are in the order of the request
+    BOOST_REQUIRE(spent_index.FindSpends(outpoints, found));
+    BOOST_REQUIRE_EQUAL(found.size(), outpoints.size());
+    BOOST_CHECK(!found[0] && !found[1]);
+    BOOST_REQUIRE(found[2]);
+    BOOST_CHECK(found[2]->txid == first_spend.GetHash());
+    BOOST_CHECK_EQUAL(found[2]->vin, 0U);
+    BOOST_CHECK_EQUAL(found[2]->height, 101);
+
+    // Spends in new blocks are indexed
+    const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[1], 0, 2, coinbaseKey, coinbase_script, 10 * COIN, /*submit=*/false)};
+    CreateAndProcessBlock({spend}, coinbase_script);
+    BOOST_REQUIRE(spent_index.BlockUntilSyncedToCurrentChain());
+    BOOST_REQUIRE(spent_index.FindSpends(outpoints, found));
+    BOOST_REQUIRE(found[0]);
+    BOOST_CHECK(found[0]->txid == spend.GetHash());
+    BOOST_CHECK_EQUAL(found[0]->height, 102);
+    BOOST_CHECK(!found[1] && found[2]);
+
+    // Disconnected spends are removed
+    {
+        BlockValidationState state;
+        CBlockIndex* tip{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip())};
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, tip));
+    }
+    CreateAndProcessBlock({}, CScript() << OP_TRUE);
+    BOOST_REQUIRE(spent_index.BlockUntilSyncedToCurrentChain());
+    BOOST_REQUIRE(spent_index.FindSpends(outpoints, found));
+    BOOST_CHECK(!found[0] && !found[1] && found[2]);
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification. The BlockUntilSyncedToCurrentChain()
+    // call above is sufficient to ensure this, but the
+    // SyncWithValidationInterfaceQueue() call below is also needed to ensure
+    // TSAN always sees the test thread waiting for the notification thread, and
+    // avoid potential false positive reports.
+    SyncWithValidationInterfaceQueue();
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    spent_index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,59 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <test/util/setup_common.h>
+#include <util/threadpool.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(threadpool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(threadpool_submit)
+{
+    ThreadPool pool{"test"};
+    pool.Start(3);
+    BOOST_CHECK_EQUAL(pool.WorkersCount(), 3U);
+
+    std::atomic<int> sum{0};
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 100; ++i) {
+        futures.push_back(pool.Submit([i, &sum] { sum += i; return i * 2; }));
+    }
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(futures[i].get(), i * 2);
+    }
+    BOOST_CHECK_EQUAL(sum, 4950);
+    BOOST_CHECK_EQUAL(pool.WorkQueueSize(), 0U);
+
+    // Exceptions are propagated through the future
+    auto failing{pool.Submit([]() -> bool { throw std::runtime_error{"fail"}; })};
+    BOOST_CHECK_THROW(failing.get(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(threadpool_stop_drains_queue)
+{
+    std::atomic<int> done{0};
+    {
+        ThreadPool pool{"test"};
+        pool.Start(1);
+        for (int i = 0; i < 50; ++i) {
+            pool.Submit([&done] { ++done; });
+        }
+        pool.Stop();
+        BOOST_CHECK_EQUAL(pool.WorkersCount(), 0U);
+        BOOST_CHECK_EQUAL(done, 50);
+
+        // The pool can be restarted after being stopped
+        pool.Start(2);
+        pool.Submit([&done] { ++done; }).wait();
+    }
+    BOOST_CHECK_EQUAL(done, 51);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,12 +5,15 @@
 
 #include <addresstype.h>
 #include <chainparams.h>
+#include <consensus/validation.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
 #include <test/util/index.h>
 #include <test/util/setup_common.h>
 #include <validation.h>
 
+#include <numeric>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_SUITE(txindex_tests)
@@ -51,6 +54,21 @@ BOOST_FIXTURE_TEST_CASE(txindex_initial_sync, TestChain100Setup)
         }
     }
 
+    // The blocks synced are counted, with the time spent on each of them
+    IndexStats stats{txindex.GetStats()};
+    BOOST_CHECK_EQUAL(stats.blocks, uint64_t(WITH_LOCK(::cs_main, return m_node.chainman->ActiveHeight()) + 1));
+    BOOST_CHECK_EQUAL(stats.read.count, stats.blocks);
+    BOOST_CHECK_EQUAL(stats.compute.count, stats.blocks);
+    BOOST_CHECK_EQUAL(std::accumulate(stats.compute.buckets.begin(), stats.compute.buckets.end(), uint64_t{0}), stats.blocks);
+    BOOST_CHECK(stats.commit.count > 0);
+    BOOST_CHECK(stats.bytes_written > 0);
+
+    // Entries are keyed by a prefix of the hash, so a hash sharing it with an
+    // indexed transaction must not find that transaction.
+    uint256 same_prefix{m_coinbase_txns[0]->GetHash()};
+    *(same_prefix.end() - 1) ^= 1;
+    BOOST_CHECK(!txindex.FindTx(same_prefix, block_hash, tx_disk));
+
     // Check that new transactions in new blocks make it into the index.
     for (int i = 0; i < 10; i++) {
         CScript coinbase_script_pub_key = GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
@@ -66,6 +84,59 @@ BOOST_FIXTURE_TEST_CASE(txindex_initial_sync, TestChain100Setup)
         }
     }
 
+    // Blocks connected by notifications are not read by the index
+    stats = txindex.GetStats();
+    BOOST_CHECK_EQUAL(stats.blocks, uint64_t(WITH_LOCK(::cs_main, return m_node.chainman->ActiveHeight()) + 1));
+    BOOST_CHECK_EQUAL(stats.read.count, stats.blocks - 10);
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification. The BlockUntilSyncedToCurrentChain()
+    // call above is sufficient to ensure this, but the
+    // SyncWithValidationInterfaceQueue() call below is also needed to ensure
+    // TSAN always sees the test thread waiting for the notification thread, and
+    // avoid potential false positive reports.
+    SyncWithValidationInterfaceQueue();
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    txindex.Stop();
+}
+
+BOOST_FIXTURE_TEST_CASE(txindex_reorg, TestChain100Setup)
+{
+    TxIndex txindex(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(txindex.Init());
+    BOOST_REQUIRE(txindex.StartBackgroundSync());
+    IndexWaitSynced(txindex, *Assert(m_node.shutdown));
+
+    const CScript coinbase_script{GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()))};
+    const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 1, coinbaseKey, coinbase_script, 10 * COIN, /*submit=*/false)};
+    const CBlock block{CreateAndProcessBlock({spend}, coinbase_script)};
+    BOOST_REQUIRE(txindex.BlockUntilSyncedToCurrentChain());
+
+    CTransactionRef tx_disk;
+    uint256 block_hash;
+    BOOST_REQUIRE(txindex.FindTx(spend.GetHash(), block_hash, tx_disk));
+    BOOST_CHECK(block_hash == block.GetHash());
+
+    // The transactions of a disconnected block are no longer found, although
+    // the block is still on disk
+    {
+        BlockValidationState state;
+        CBlockIndex* tip{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip())};
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, tip));
+    }
+    CreateAndProcessBlock({}, CScript() << OP_TRUE);
+    BOOST_REQUIRE(txindex.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(!txindex.FindTx(spend.GetHash(), block_hash, tx_disk));
+    BOOST_CHECK(!txindex.FindTx(block.vtx[0]->GetHash(), block_hash, tx_disk));
+
+    // A transaction confirmed again is found in the block of the active chain
+    const CBlock reconfirm_block{CreateAndProcessBlock({spend}, CScript() << OP_TRUE)};
+    BOOST_REQUIRE(txindex.BlockUntilSyncedToCurrentChain());
+    BOOST_REQUIRE(txindex.FindTx(spend.GetHash(), block_hash, tx_disk));
+    BOOST_CHECK(block_hash == reconfirm_block.GetHash());
+    BOOST_CHECK(tx_disk->GetHash() == spend.GetHash());
+
     // It is not safe to stop and destroy the index until it finishes handling
     // the last BlockConnected notification. The BlockUntilSyncedToCurrentChain()
     // call above is sufficient to ensure this, but the
@@ -5,6 +5,7 @@
 //
 #include <chainparams.h>
 #include <consensus/validation.h>
+#include <kernel/coinscache_persist.h>
 #include <random.h>
 #include <rpc/blockchain.h>
 #include <sync.h>
@@ -15,6 +16,7 @@
 #include <uint256.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <vector>
 
 #include <boost/test/unit_test.hpp>
@@ -62,6 +64,82 @@ BOOST_AUTO_TEST_CASE(validation_chainstate_resize_caches)
     }
 }
 
+//! Test saving the outpoints of the coins cache and reloading their coins.
+BOOST_FIXTURE_TEST_CASE(chainstate_coins_cache_persist, TestChain100Setup)
+{
+    Chainstate& chainstate{Assert(m_node.chainman)->ActiveChainstate()};
+    const fs::path path{m_args.GetDataDirNet() / "coinscache.dat"};
+    std::vector<COutPoint> cached;
+    {
+        LOCK(::cs_main);
+        cached = chainstate.CoinsTip().GetCachedOutPoints();
+        BOOST_REQUIRE(!cached.empty());
+        BOOST_CHECK(std::is_sorted(cached.begin(), cached.end()));
+        BOOST_REQUIRE(kernel::DumpCoinsCache(chainstate, path, fsbridge::fopen, /*skip_file_commit=*/true));
+
+        // A full flush empties the cache
+        chainstate.ForceFlushStateToDisk();
+        BOOST_CHECK_EQUAL(chainstate.CoinsTip().GetCacheSize(), 0U);
+    }
+
+    BOOST_REQUIRE(kernel::LoadCoinsCache(chainstate, path, /*num_threads=*/2));
+    const COutPoint spent{cached.front()};
+    {
+        LOCK(::cs_main);
+        BOOST_CHECK_EQUAL(chainstate.CoinsTip().GetCacheSize(), cached.size());
+        for (const COutPoint& outpoint : cached) {
+            BOOST_CHECK(chainstate.CoinsTip().HaveCoinInCache(outpoint));
+        }
+        BOOST_CHECK(chainstate.CoinsTip().GetCachedOutPoints() == cached);
+
+        BOOST_CHECK(chainstate.CoinsTip().SpendCoin(spent));
+        chainstate.ForceFlushStateToDisk();
+    }
+
+    // Coins spent since the dump are not loaded
+    BOOST_REQUIRE(kernel::LoadCoinsCache(chainstate, path, /*num_threads=*/1));
+    {
+        LOCK(::cs_main);
+        BOOST_CHECK_EQUAL(chainstate.CoinsTip().GetCacheSize(), cached.size() - 1);
+        BOOST_CHECK(!chainstate.CoinsTip().HaveCoinInCache(spent));
+
+        // Leave room for only a few coins in the cache
+        chainstate.ForceFlushStateToDisk();
+        chainstate.m_coinstip_cache_size_bytes = (chainstate.CoinsTip().DynamicMemoryUsage() + 4000) / 9 * 10;
+    }
+
+    // Loading stops before the cache exceeds its size
+    BOOST_REQUIRE(kernel::LoadCoinsCache(chainstate, path, /*num_threads=*/2));
+    LOCK(::cs_main);
+    BOOST_CHECK(chainstate.CoinsTip().GetCacheSize() > 0);
+    BOOST_CHECK(chainstate.CoinsTip().GetCacheSize() < cached.size() - 1);
+    BOOST_CHECK(chainstate.CoinsTip().DynamicMemoryUsage() <= chainstate.m_coinstip_cache_size_bytes);
+}
+
+//! Test that the coins spent by the mempool are saved even when not cached.
+BOOST_FIXTURE_TEST_CASE(chainstate_coins_cache_persist_mempool, TestChain100Setup)
+{
+    Chainstate& chainstate{Assert(m_node.chainman)->ActiveChainstate()};
+    const fs::path path{m_args.GetDataDirNet() / "coinscache.dat"};
+    const CScript script{CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG};
+    const CMutableTransaction parent{CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 0, coinbaseKey, script, 10 * COIN)};
+    const CTransactionRef child{MakeTransactionRef(CreateValidMempoolTransaction(MakeTransactionRef(parent), 0, 0, coinbaseKey, script, 9 * COIN))};
+    const COutPoint confirmed{m_coinbase_txns[0]->GetHash(), 0};
+    {
+        LOCK(::cs_main);
+        chainstate.ForceFlushStateToDisk();
+        BOOST_CHECK_EQUAL(chainstate.CoinsTip().GetCacheSize(), 0U);
+        BOOST_REQUIRE(kernel::DumpCoinsCache(chainstate, path, fsbridge::fopen, /*skip_file_commit=*/true));
+    }
+
+    // Only the confirmed coin is loaded, not the output of the mempool parent
+    BOOST_REQUIRE(kernel::LoadCoinsCache(chainstate, path, /*num_threads=*/1));
+    LOCK(::cs_main);
+    BOOST_CHECK_EQUAL(chainstate.CoinsTip().GetCacheSize(), 1U);
+    BOOST_CHECK(chainstate.CoinsTip().HaveCoinInCache(confirmed));
+    BOOST_CHECK(!chainstate.CoinsTip().HaveCoinInCache(child->vin[0].prevout));
+}
+
 //! Test UpdateTip behavior for both active and background chainstates.
 //!
 //! When run on the background chainstate, UpdateTip should do a subset
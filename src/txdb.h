@@ -66,6 +66,7 @@ public:
     std::vector<uint256> GetHeadBlocks() const override;
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, bool erase = true) override;
     std::unique_ptr<CCoinsViewCursor> Cursor() const override;
+    std::unique_ptr<CCoinsViewCursor> Cursor(const uint256& begin, const std::optional<uint256>& end) const override;
 
     //! Whether an unsupported database format is used.
     bool NeedsUpgrade();
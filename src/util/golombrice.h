@@ -8,9 +8,14 @@
 
 #include <util/fastrange.h>
 
+#include <span.h>
 #include <streams.h>
 
+#include <algorithm>
+#include <bit>
 #include <cstdint>
+#include <ios>
+#include <vector>
 
 template <typename OStream>
 void GolombRiceEncode(BitStreamWriter<OStream>& bitwriter, uint8_t P, uint64_t x)
@@ -43,4 +48,140 @@ uint64_t GolombRiceDecode(BitStreamReader<IStream>& bitreader, uint8_t P)
     return (q << P) + r;
 }
 
+/**
+ * Golomb-Rice encoder buffering bits in a 64-bit word, for encoding whole
+ * filters. The output is identical to GolombRiceEncode() over a
+ * BitStreamWriter, padded with 0's to the next byte boundary by Flush().
+ */
+class GolombRiceWriter
+{
+private:
+    std::vector<unsigned char>& m_out;
+    //! Bits not written to m_out yet, from the most significant bit
+    uint64_t m_buffer{0};
+    int m_bits{0};
+
+    void WriteBits(uint64_t data, int nbits)
+    {
+        if (nbits == 0) return;
+        if (nbits < 64) data &= (uint64_t{1} << nbits) - 1;
+        const int free{64 - m_bits};
+        if (nbits < free) {
+            m_buffer |= data << (free - nbits);
+            m_bits += nbits;
+            return;
+        }
+        m_buffer |= data >> (nbits - free);
+        WriteWord();
+        const int rest{nbits - free};
+        if (rest > 0) {
+            m_buffer = data << (64 - rest);
+            m_bits = rest;
+        }
+    }
+
+    void WriteWord()
+    {
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            m_out.push_back(static_cast<unsigned char>(m_buffer >> shift));
+        }
+        m_buffer = 0;
+        m_bits = 0;
+    }
+
+public:
+    explicit GolombRiceWriter(std::vector<unsigned char>& out) : m_out{out} {}
+
+    void Encode(uint8_t P, uint64_t x)
+    {
+        // Write quotient as unary-encoded: q 1's followed by one 0.
+        for (uint64_t q = x >> P; q > 0;) {
+            const int nbits{static_cast<int>(std::min<uint64_t>(q, 64))};
+            WriteBits(~0ULL, nbits);
+            q -= nbits;
+        }
+        WriteBits(0, 1);
+
+        // Write the remainder in P bits.
+        WriteBits(x, P);
+    }
+
+    /** Write the buffered bits, padding with 0's to the next byte boundary. */
+    void Flush()
+    {
+        for (int shift = 56; m_bits > 0; shift -= 8, m_bits -= 8) {
+            m_out.push_back(static_cast<unsigned char>(m_buffer >> shift));
+        }
+        m_buffer = 0;
+        m_bits = 0;
+    }
+};
+
+/**
+ * Golomb-Rice decoder reading a byte span into a 64-bit word, counting the
+ * unary-encoded quotient a word at a time. Decodes the output of
+ * GolombRiceEncode() like GolombRiceDecode() over a BitStreamReader, and
+ * throws std::ios_base::failure at the end of the data.
+ */
+class GolombRiceReader
+{
+private:
+    Span<const unsigned char> m_data;
+    size_t m_pos{0};
+    //! Bits read from m_data and not decoded yet, from the most significant bit
+    uint64_t m_buffer{0};
+    int m_bits{0};
+
+    void Refill()
+    {
+        while (m_bits <= 56 && m_pos < m_data.size()) {
+            m_buffer |= uint64_t{m_data[m_pos++]} << (56 - m_bits);
+            m_bits += 8;
+        }
+        if (m_bits == 0) throw std::ios_base::failure("GolombRiceReader: end of data");
+    }
+
+    void Skip(int nbits)
+    {
+        m_buffer = nbits == 64 ? 0 : m_buffer << nbits;
+        m_bits -= nbits;
+    }
+
+public:
+    explicit GolombRiceReader(Span<const unsigned char> data) : m_data{data} {}
+
+    uint64_t Decode(uint8_t P)
+    {
+        // Read unary-encoded quotient: q 1's followed by one 0. Bits past
+        // m_bits are 0's, so the count of leading 1's stops there.
+        uint64_t q = 0;
+        while (true) {
+            Refill();
+            const int ones{std::countl_one(m_buffer)};
+            if (ones < m_bits) {
+                q += ones;
+                Skip(ones + 1);
+                break;
+            }
+            q += m_bits;
+            Skip(m_bits);
+        }
+
+        uint64_t r = 0;
+        for (int remaining = P; remaining > 0;) {
+            Refill();
+            const int nbits{std::min(remaining, m_bits)};
+            const uint64_t bits{m_buffer >> (64 - nbits)};
+            r = nbits == 64 ? bits : (r << nbits) | bits;
+            Skip(nbits);
+            remaining -= nbits;
+        }
+
+        return (q << P) + r;
+    }
+
+    /** Number of bytes of which bits were decoded. */
+    size_t BytesRead() const { return m_pos - static_cast<size_t>(m_bits / 8); }
+};
+
 #endif // BETGENIUS_UTIL_GOLOMBRICE_H
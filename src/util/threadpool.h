@@ -0,0 +1,108 @@
+// Copyright (c) 2024 The Betgenius Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BETGENIUS_UTIL_THREADPOOL_H
+#define BETGENIUS_UTIL_THREADPOOL_H
+
+#include <sync.h>
+#include <tinyformat.h>
+#include <util/check.h>
+#include <util/thread.h>
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Fixed-size pool of worker threads executing submitted tasks in FIFO order.
+ *
+ * Submit() returns a std::future for the task's result; an exception thrown
+ * by the task is stored in the future and rethrown by get(). Stop() (also
+ * called on destruction) lets the workers finish the queued tasks and joins
+ * them, so any state referenced by pending tasks must outlive the pool.
+ */
+class ThreadPool
+{
+private:
+    const std::string m_name;
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::queue<std::packaged_task<void()>> m_work_queue GUARDED_BY(m_mutex);
+    bool m_interrupt GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_workers;
+
+    void WorkerThread() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        for (;;) {
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_interrupt || !m_work_queue.empty(); });
+            if (m_work_queue.empty()) return; // interrupted and drained
+            std::packaged_task<void()> task{std::move(m_work_queue.front())};
+            m_work_queue.pop();
+            REVERSE_LOCK(lock);
+            task();
+        }
+    }
+
+public:
+    explicit ThreadPool(std::string name) : m_name{std::move(name)} {}
+    ~ThreadPool() { Stop(); }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** Spawn the worker threads. Must not be called on a running pool. */
+    void Start(int num_workers) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        Assume(m_workers.empty());
+        Assume(num_workers > 0);
+        WITH_LOCK(m_mutex, m_interrupt = false);
+        m_workers.reserve(num_workers);
+        for (int i = 0; i < num_workers; ++i) {
+            m_workers.emplace_back(&util::TraceThread, strprintf("%s.%i", m_name, i), [this] { WorkerThread(); });
+        }
+    }
+
+    /** Run the remaining queued tasks and join all workers. */
+    void Stop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_interrupt = true);
+        m_cv.notify_all();
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+        m_workers.clear();
+    }
+
+    template <typename F>
+    auto Submit(F&& fn) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        using R = std::invoke_result_t<F>;
+        auto task{std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn))};
+        auto future{task->get_future()};
+        {
+            LOCK(m_mutex);
+            Assume(!m_workers.empty());
+            m_work_queue.emplace([task]() { (*task)(); });
+        }
+        m_cv.notify_one();
+        return future;
+    }
+
+    size_t WorkersCount() const { return m_workers.size(); }
+
+    size_t WorkQueueSize() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        return WITH_LOCK(m_mutex, return m_work_queue.size());
+    }
+};
+
+#endif // BETGENIUS_UTIL_THREADPOOL_H
@@ -14,6 +14,7 @@
 #include <chain.h>
 #include <checkqueue.h>
 #include <clientversion.h>
+#include <common/system.h>
 #include <consensus/amount.h>
 #include <consensus/consensus.h>
 #include <consensus/merkle.h>
@@ -32,6 +33,7 @@
 #include <kernel/notifications_interface.h>
 #include <logging.h>
 #include <logging/timer.h>
+#include <node/blockformat.h>
 #include <node/blockstorage.h>
 #include <node/utxo_snapshot.h>
 #include <policy/v3_policy.h>
@@ -45,6 +47,7 @@
 #include <reverse_iterator.h>
 #include <script/script.h>
 #include <script/sigcache.h>
+#include <streams.h>
 #include <tinyformat.h>
 #include <txdb.h>
 #include <txmempool.h>
@@ -59,6 +62,7 @@
 #include <util/result.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
+#include <util/threadpool.h>
 #include <util/time.h>
 #include <util/trace.h>
 #include <util/translation.h>
@@ -68,10 +72,15 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <deque>
+#include <future>
+#include <map>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 
@@ -83,7 +92,6 @@ using kernel::Notifications;
 using fsbridge::FopenFn;
 using node::BlockManager;
 using node::BlockMap;
-using node::CBlockIndexHeightOnlyComparator;
 using node::CBlockIndexWorkComparator;
 using node::fReindex;
 using node::SnapshotMetadata;
@@ -102,12 +110,6 @@ const std::vector<std::string> CHECKLEVEL_DOC {
     "level 4 tries to reconnect the blocks",
     "each level includes the checks of the previous levels",
 };
-/** The number of blocks to keep below the deepest prune lock.
- *  There is nothing special about this number. It is higher than what we
- *  expect to see in regular mainnet reorgs, but not so high that it would
- *  noticeably interfere with the pruning mechanism.
- * */
-static constexpr int PRUNE_LOCK_BUFFER{10};
 
 GlobalMutex g_best_block_mutex;
 std::condition_variable g_best_block_cv;
@@ -2047,7 +2049,7 @@ DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIn
     bool fClean = true;
 
     CBlockUndo blockUndo;
-    if (!m_blockman.UndoReadFromDisk(blockUndo, *pindex)) {
+    if (!m_block_prefetcher.TakeUndo(*pindex, blockUndo) && !m_blockman.UndoReadFromDisk(blockUndo, *pindex)) {
         error("DisconnectBlock(): failure reading undo data");
         return DISCONNECT_FAILED;
     }
@@ -2449,7 +2451,7 @@ CoinsCacheSizeState Chainstate::GetCoinsCacheSizeState(
 {
     AssertLockHeld(::cs_main);
     const int64_t nMempoolUsage = m_mempool ? m_mempool->DynamicMemoryUsage() : 0;
-    int64_t cacheSize = CoinsTip().DynamicMemoryUsage();
+    int64_t cacheSize = CoinsTip().DynamicMemoryUsage() + m_block_prefetcher.DynamicMemoryUsage();
     int64_t nTotalSpace =
         max_coins_cache_size_bytes + std::max<int64_t>(int64_t(max_mempool_size_bytes) - nMempoolUsage, 0);
 
@@ -2490,18 +2492,8 @@ bool Chainstate::FlushStateToDisk(
         if (m_blockman.IsPruneMode() && (m_blockman.m_check_for_pruning || nManualPruneHeight > 0) && !fReindex) {
             // make sure we don't prune above any of the prune locks bestblocks
             // pruning is height-based
-            int last_prune{m_chain.Height()}; // last height we can prune
             std::optional<std::string> limiting_lock; // prune lock that actually was the limiting factor, only used for logging
-
-            for (const auto& prune_lock : m_blockman.m_prune_locks) {
-                if (prune_lock.second.height_first == std::numeric_limits<int>::max()) continue;
-                // Remove the buffer and one additional block here to get actual height that is outside of the buffer
-                const int lock_height{prune_lock.second.height_first - PRUNE_LOCK_BUFFER - 1};
-                last_prune = std::max(1, std::min(last_prune, lock_height));
-                if (last_prune == lock_height) {
-                    limiting_lock = prune_lock.first;
-                }
-            }
+            const int last_prune{m_blockman.GetLastPrunableHeight(m_chain.Height(), limiting_lock)}; // last height we can prune
 
             if (limiting_lock) {
                 LogPrint(BCLog::PRUNE, "%s limited pruning to height %d\n", limiting_lock.value(), last_prune);
@@ -2555,11 +2547,12 @@ bool Chainstate::FlushStateToDisk(
             {
                 LOG_TIME_MILLIS_WITH_CATEGORY("write block and undo data to disk", BCLog::BENCH);
 
-                // First make sure all block and undo data is flushed to disk.
-                // TODO: Handle return error, or add detailed comment why it is
-                // safe to not return an error upon failure.
+                // First make sure all block and undo data is written and
+                // flushed to disk, so the block index and coins written below
+                // do not refer to data that is not on disk. The failure was
+                // reported by the block file writer already.
                 if (!m_blockman.FlushChainstateBlockFile(m_chain.Height())) {
-                    LogPrintLevel(BCLog::VALIDATION, BCLog::Level::Warning, "%s: Failed to flush block file.\n", __func__);
+                    return state.Error("Failed to flush block and undo files");
                 }
             }
 
@@ -2573,9 +2566,9 @@ bool Chainstate::FlushStateToDisk(
             }
             // Finally remove any pruned files
             if (fFlushForPrune) {
-                LOG_TIME_MILLIS_WITH_CATEGORY("unlink pruned files", BCLog::BENCH);
-
-                m_blockman.UnlinkPrunedFiles(setFilesToPrune);
+                // The block index no longer refers to the files, so they
+                // are unlinked in the background.
+                m_blockman.UnlinkPrunedFilesInBackground(setFilesToPrune);
             }
             m_last_write = nNow;
         }
@@ -2726,12 +2719,16 @@ bool Chainstate::DisconnectTip(BlockValidationState& state, DisconnectedBlockTra
     CBlockIndex *pindexDelete = m_chain.Tip();
     assert(pindexDelete);
     assert(pindexDelete->pprev);
-    // Read block from disk.
-    std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
-    CBlock& block = *pblock;
-    if (!m_blockman.ReadBlockFromDisk(block, *pindexDelete)) {
-        return error("DisconnectTip(): Failed to read block");
+    // Read block from disk, unless it was read ahead.
+    std::shared_ptr<const CBlock> pblock{m_block_prefetcher.TakeBlock(*pindexDelete)};
+    if (!pblock) {
+        std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
+        if (!m_blockman.ReadBlockFromDisk(*pblockRead, *pindexDelete)) {
+            return error("DisconnectTip(): Failed to read block");
+        }
+        pblock = std::move(pblockRead);
     }
+    const CBlock& block = *pblock;
     // Apply the block atomically to the chain state.
     const auto time_start{SteadyClock::now()};
     {
@@ -2770,6 +2767,7 @@ bool Chainstate::DisconnectTip(BlockValidationState& state, DisconnectedBlockTra
     }
 
     m_chain.SetTip(*pindexDelete->pprev);
+    if (this == &m_chainman.ActiveChainstate()) m_blockman.m_header_store.Truncate(pindexDelete->nHeight);
 
     UpdateTip(pindexDelete->pprev);
     // Let wallets know transactions went from 1-confirmed to
@@ -2839,11 +2837,16 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
     const auto time_1{SteadyClock::now()};
     std::shared_ptr<const CBlock> pthisBlock;
     if (!pblock) {
-        std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
-        if (!m_blockman.ReadBlockFromDisk(*pblockNew, *pindexNew)) {
-            return FatalError(m_chainman.GetNotifications(), state, "Failed to read block");
+        pthisBlock = m_block_prefetcher.TakeBlock(*pindexNew);
+        if (pthisBlock) {
+            LogPrint(BCLog::BENCH, "  - Using prefetched block\n");
+        } else {
+            std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
+            if (!m_blockman.ReadBlockFromDisk(*pblockNew, *pindexNew)) {
+                return FatalError(m_chainman.GetNotifications(), state, "Failed to read block");
+            }
+            pthisBlock = pblockNew;
         }
-        pthisBlock = pblockNew;
     } else {
         LogPrint(BCLog::BENCH, "  - Using cached block\n");
         pthisBlock = pblock;
@@ -2920,6 +2923,12 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
         m_chainman.MaybeCompleteSnapshotValidation();
     }
 
+    // Blocks near the tip are the ones peers and clients ask for the most
+    if (this == &m_chainman.ActiveChainstate()) {
+        m_blockman.m_header_store.Append(pindexNew->nHeight, *pthisBlock);
+        m_blockman.m_recent_blocks.Add(pthisBlock);
+    }
+
     connectTrace.BlockConnected(pindexNew, std::move(pthisBlock));
     return true;
 }
@@ -3013,10 +3022,18 @@ bool Chainstate::ActivateBestChainStep(BlockValidationState& state, CBlockIndex*
     const CBlockIndex* pindexOldTip = m_chain.Tip();
     const CBlockIndex* pindexFork = m_chain.FindFork(pindexMostWork);
 
+    // Blocks read ahead of connecting or disconnecting them may use a share of the coins cache
+    const size_t max_prefetch_bytes{m_coinstip_cache_size_bytes / 8};
+
     // Disconnect active blocks which are no longer in the best chain.
     bool fBlocksDisconnected = false;
     DisconnectedBlockTransactions disconnectpool{MAX_DISCONNECTED_TX_POOL_BYTES};
     while (m_chain.Tip() && m_chain.Tip() != pindexFork) {
+        std::vector<const CBlockIndex*> to_disconnect;
+        for (const CBlockIndex* pindex{m_chain.Tip()}; pindex != pindexFork && to_disconnect.size() < node::MAX_BLOCK_PREFETCH; pindex = pindex->pprev) {
+            to_disconnect.push_back(pindex);
+        }
+        m_block_prefetcher.PrefetchDisconnect(to_disconnect, max_prefetch_bytes);
         if (!DisconnectTip(state, &disconnectpool)) {
             // This is likely a fatal error, but keep the mempool consistent,
             // just in case. Only remove from the mempool in this case.
@@ -3048,6 +3065,15 @@ bool Chainstate::ActivateBestChainStep(BlockValidationState& state, CBlockIndex*
         }
         nHeight = nTargetHeight;
 
+        // Start reading the blocks that are not in memory yet, in the order they are connected.
+        std::vector<const CBlockIndex*> to_prefetch;
+        to_prefetch.reserve(vpindexToConnect.size());
+        for (const CBlockIndex* pindex : reverse_iterate(vpindexToConnect)) {
+            if (pindex == pindexMostWork && pblock) continue;
+            to_prefetch.push_back(pindex);
+        }
+        m_block_prefetcher.PrefetchConnect(to_prefetch, max_prefetch_bytes);
+
         // Connect new blocks.
         for (CBlockIndex* pindexConnect : reverse_iterate(vpindexToConnect)) {
             if (!ConnectTip(state, pindexConnect, pindexConnect == pindexMostWork ? pblock : std::shared_ptr<const CBlock>(), connectTrace, disconnectpool)) {
@@ -3563,10 +3589,13 @@ void ChainstateManager::ReceivedBlockTransactions(const CBlock& block, CBlockInd
     }
 }
 
-static bool CheckBlockHeader(const CBlockHeader& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true)
+static bool CheckBlockHeader(const CBlockHeader& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, const uint256* pow_hash = nullptr)
 {
     uint256 hashMix;
-    if (fCheckPOW && !CheckProofOfWork(block.GetHash(hashMix), block.nBits, consensusParams))
+    // A non-null pow_hash was already checked against nBits, and is the hash
+    // computed here once the mix matches. The mix needs the epoch context.
+    const uint256 hash{fCheckPOW ? block.GetHash(hashMix) : uint256{}};
+    if (fCheckPOW && !pow_hash && !CheckProofOfWork(hash, block.nBits, consensusParams))
         return state.Invalid(BlockValidationResult::BLOCK_INVALID_HEADER, "high-hash", "proof of work failed");
         
     if (fCheckPOW && hashMix != block.hashMix)
@@ -3918,12 +3947,12 @@ static bool ContextualCheckBlock(const CBlock& block, BlockValidationState& stat
     return true;
 }
 
-bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationState& state, CBlockIndex** ppindex, bool min_pow_checked)
+bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationState& state, CBlockIndex** ppindex, bool min_pow_checked, const uint256* pow_hash)
 {
     AssertLockHeld(cs_main);
 
     // Check for duplicate
-    uint256 hash = block.GetHash();
+    uint256 hash = pow_hash ? *pow_hash : block.GetHash();
     BlockMap::iterator miSelf{m_blockman.m_block_index.find(hash)};
     if (hash != GetConsensus().hashGenesisBlock) {
         if (miSelf != m_blockman.m_block_index.end()) {
@@ -3938,7 +3967,7 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, GetConsensus())) {
+        if (!CheckBlockHeader(block, state, GetConsensus(), /*fCheckPOW=*/true, pow_hash)) {
             LogPrint(BCLog::VALIDATION, "%s: Consensus::CheckBlockHeader: %s, %s\n", __func__, hash.ToString(), state.ToString());
             return false;
         }
@@ -4083,7 +4112,7 @@ void ChainstateManager::ReportHeadersPresync(const arith_uint256& work, int64_t
 }
 
 /** Store block on disk. If dbp is non-nullptr, the file is known to already reside on disk */
-bool ChainstateManager::AcceptBlock(const std::shared_ptr<const CBlock>& pblock, BlockValidationState& state, CBlockIndex** ppindex, bool fRequested, const FlatFilePos* dbp, bool* fNewBlock, bool min_pow_checked)
+bool ChainstateManager::AcceptBlock(const std::shared_ptr<const CBlock>& pblock, BlockValidationState& state, CBlockIndex** ppindex, bool fRequested, const FlatFilePos* dbp, bool* fNewBlock, bool min_pow_checked, unsigned int stored_size, const uint256* pow_hash)
 {
     const CBlock& block = *pblock;
 
@@ -4093,7 +4122,7 @@ bool ChainstateManager::AcceptBlock(const std::shared_ptr<const CBlock>& pblock,
     CBlockIndex *pindexDummy = nullptr;
     CBlockIndex *&pindex = ppindex ? *ppindex : pindexDummy;
 
-    bool accepted_header{AcceptBlockHeader(block, state, &pindex, min_pow_checked)};
+    bool accepted_header{AcceptBlockHeader(block, state, &pindex, min_pow_checked, pow_hash)};
     CheckBlockIndex();
 
     if (!accepted_header)
@@ -4152,7 +4181,7 @@ bool ChainstateManager::AcceptBlock(const std::shared_ptr<const CBlock>& pblock,
     // Write block to history file
     if (fNewBlock) *fNewBlock = true;
     try {
-        FlatFilePos blockPos{m_blockman.SaveBlockToDisk(block, pindex->nHeight, dbp)};
+        FlatFilePos blockPos{m_blockman.SaveBlockToDisk(block, pindex->nHeight, dbp, stored_size)};
         if (blockPos.IsNull()) {
             state.Error(strprintf("%s: Failed to find position to write new block to disk", __func__));
             return false;
@@ -4582,9 +4611,7 @@ bool ChainstateManager::LoadBlockIndex()
 
         m_blockman.ScanAndUnlinkAlreadyPrunedFiles();
 
-        std::vector<CBlockIndex*> vSortedByHeight{m_blockman.GetAllBlockIndices()};
-        std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
-                  CBlockIndexHeightOnlyComparator());
+        std::vector<CBlockIndex*> vSortedByHeight{m_blockman.GetAllBlockIndicesByHeight()};
 
         for (CBlockIndex* pindex : vSortedByHeight) {
             if (m_interrupt) return false;
@@ -4651,6 +4678,187 @@ bool Chainstate::LoadGenesisBlock()
     return true;
 }
 
+//! Upper bound on the number of threads deserializing and checking imported blocks
+static constexpr int MAX_BLOCK_IMPORT_THREADS{8};
+//! Number of imported blocks buffered ahead of validation, per thread
+static constexpr size_t BLOCK_IMPORT_QUEUE_PER_THREAD{4};
+//! Memory for blocks read before their parent, beyond which only their position is kept
+static constexpr size_t MAX_BLOCK_IMPORT_UNKNOWN_PARENT_BYTES{256 << 20};
+
+namespace {
+//! A block read from a block file, deserialized and checked off the validation thread
+struct ImportedBlock {
+    //! Position of the block data in the file
+    uint64_t pos{0};
+    //! Serialized size of the block
+    size_t size{0};
+    //! Null if the data did not deserialize as a block
+    std::shared_ptr<CBlock> block;
+    uint256 hash;
+    //! Whether hash meets the block's nBits target
+    bool pow_checked{false};
+};
+
+/**
+ * Blocks handed from the block file reader to the validation thread, in file
+ * order. Blocks are deserialized on a thread pool while queued; the queue
+ * holds their futures and is bounded so the reader cannot run too far ahead.
+ */
+class BlockImportQueue
+{
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::future<ImportedBlock>> m_queue GUARDED_BY(m_mutex);
+    //! The reader has read the whole file
+    bool m_finished GUARDED_BY(m_mutex){false};
+    //! The validation thread stopped consuming blocks
+    bool m_stopped GUARDED_BY(m_mutex){false};
+    const size_t m_capacity;
+
+public:
+    explicit BlockImportQueue(size_t capacity) : m_capacity{capacity} {}
+
+    //! Wait for room and queue a block. Returns false if the consumer stopped.
+    bool Push(std::future<ImportedBlock> block) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stopped || m_queue.size() < m_capacity; });
+        if (m_stopped) return false;
+        m_queue.push_back(std::move(block));
+        m_cv.notify_all();
+        return true;
+    }
+
+    //! Wait for the next block. Returns std::nullopt once all blocks were consumed.
+    std::optional<std::future<ImportedBlock>> Pop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_finished || !m_queue.empty(); });
+        if (m_queue.empty()) return std::nullopt;
+        std::future<ImportedBlock> block{std::move(m_queue.front())};
+        m_queue.pop_front();
+        m_cv.notify_all();
+        return block;
+    }
+
+    void Finish() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_finished = true);
+        m_cv.notify_all();
+    }
+
+    void Stop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_stopped = true);
+        m_cv.notify_all();
+    }
+};
+
+//! Deserialize a block read from a block file, and check its merkle root and proof of work
+ImportedBlock DeserializeImportedBlock(uint64_t pos, node::BlockFormat format, Span<const unsigned char> data, const Consensus::Params& consensus)
+{
+    ImportedBlock imported;
+    imported.pos = pos;
+    imported.size = data.size();
+    try {
+        auto block{std::make_shared<CBlock>()};
+        if (format == node::BlockFormat::COMPACT_V1) {
+            SpanReader{data} >> Using<node::CompactBlockFormatter>(*block);
+        } else {
+            SpanReader{data} >> TX_WITH_WITNESS(*block);
+        }
+        // The block hash does not need the epoch context, so it is checked
+        // against nBits here, and handed to AcceptBlock() instead of being
+        // computed again. Only the mix check stays on the validation thread.
+        imported.hash = block->GetHash();
+        imported.pow_checked = CheckProofOfWork(imported.hash, block->nBits, consensus);
+        // A block whose merkle root matches is marked as such, so CheckBlock()
+        // does not compute it again on the validation thread.
+        BlockValidationState state;
+        CheckMerkleRoot(*block, state);
+        imported.block = std::move(block);
+    } catch (const std::exception& e) {
+        LogPrint(BCLog::REINDEX, "%s: unexpected data at file offset 0x%x - %s. continuing\n", __func__, pos, e.what());
+    }
+    return imported;
+}
+
+/**
+ * Read a block file sequentially, locate the blocks in it and queue them for
+ * deserialization on the thread pool, in file order.
+ */
+void ReadImportedBlocks(AutoFile& file_in, const CChainParams& params, ThreadPool& pool, BlockImportQueue& queue,
+                        const util::SignalInterrupt& interrupt)
+{
+    BufferedFile blkdat{file_in, 2 * MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE + 8};
+    // nRewind indicates where to resume scanning in case something goes wrong,
+    // such as a block fails to deserialize.
+    uint64_t nRewind = blkdat.GetPos();
+    while (!blkdat.eof()) {
+        if (interrupt) return;
+
+        blkdat.SetPos(nRewind);
+        nRewind++; // start one byte further next time, in case of failure
+        blkdat.SetLimit(); // remove former limit
+        unsigned int nSize = 0;
+        node::BlockFormat format{node::BlockFormat::NETWORK};
+        try {
+            // locate a header
+            MessageStartChars buf;
+            blkdat.FindByte(std::byte(params.MessageStart()[0]));
+            nRewind = blkdat.GetPos() + 1;
+            blkdat >> buf;
+            if (buf != params.MessageStart()) {
+                continue;
+            }
+            // read size
+            blkdat >> nSize;
+            std::tie(format, nSize) = node::ParseBlockRecordSize(nSize);
+            if (!node::IsKnownBlockFormat(format)) {
+                continue;
+            }
+            if (nSize < 80 || nSize > MAX_BLOCK_SERIALIZED_SIZE)
+                continue;
+        } catch (const std::exception&) {
+            // no valid block header found; don't complain
+            // (this happens at the end of every blk.dat file)
+            break;
+        }
+        try {
+            // read block header
+            const uint64_t nBlockPos{blkdat.GetPos()};
+            blkdat.SetLimit(nBlockPos + nSize);
+            CBlockHeader header;
+            blkdat >> header;
+            // Read the whole block; position to the marker before the next block
+            nRewind = nBlockPos + nSize;
+            blkdat.SetPos(nBlockPos);
+            std::vector<unsigned char> data(nSize);
+            blkdat.read(MakeWritableByteSpan(data));
+
+            if (!queue.Push(pool.Submit([nBlockPos, format, data = std::move(data), &params] {
+                    return DeserializeImportedBlock(nBlockPos, format, data, params.GetConsensus());
+                }))) {
+                return;
+            }
+        } catch (const std::exception& e) {
+            // historical bugs added extra data to the block files that does not deserialize cleanly.
+            // commonly this data is between readable blocks, but it does not really matter. such data is not fatal to the import process.
+            // the code that reads the block files deals with invalid data by simply ignoring it.
+            // it continues to search for the next {4 byte magic message start bytes + 4 byte length + block} that does deserialize cleanly
+            // and passes all of the other block validation checks dealing with POW and the merkle root, etc...
+            // we merely note with this informational log message when unexpected data is encountered.
+            // we could also be experiencing a storage system read error, or a read of a previous bad write. these are possible, but
+            // less likely scenarios. we don't have enough information to tell a difference here.
+            // the reindex process is not the place to attempt to clean and/or compact the block files. if so desired, a studious node operator
+            // may use knowledge of the fact that the block files are not entirely pristine in order to prepare a set of pristine, and
+            // perhaps ordered, block files for later reindexing.
+            LogPrint(BCLog::REINDEX, "%s: unexpected data at file offset 0x%x - %s. continuing\n", __func__, (nRewind - 1), e.what());
+        }
+    }
+}
+} // namespace
+
 void ChainstateManager::LoadExternalBlockFile(
     AutoFile& file_in,
     FlatFilePos* dbp,
@@ -4662,61 +4870,59 @@ void ChainstateManager::LoadExternalBlockFile(
     const auto start{SteadyClock::now()};
     const CChainParams& params{GetParams()};
 
+    // Blocks are read by one thread, deserialized and checked on a pool, and
+    // accepted on this thread in file order.
+    const int num_threads{std::clamp(GetNumCores(), 1, MAX_BLOCK_IMPORT_THREADS)};
+    ThreadPool pool{"loadblk"};
+    pool.Start(num_threads);
+    BlockImportQueue import_queue{BLOCK_IMPORT_QUEUE_PER_THREAD * num_threads};
+    ThreadPool reader{"loadblkread"};
+    reader.Start(1);
+    std::future<void> read_result{reader.Submit([&] {
+        try {
+            ReadImportedBlocks(file_in, params, pool, import_queue, m_interrupt);
+        } catch (...) {
+            import_queue.Finish();
+            throw;
+        }
+        import_queue.Finish();
+    })};
+
+    // Blocks whose parent has not been read yet are kept in memory, up to a
+    // limit, and accepted as soon as their parent is. parent hash -> child.
+    std::multimap<uint256, ImportedBlock> unknown_parent;
+    size_t unknown_parent_bytes{0};
+    const auto block_pos{[&](const ImportedBlock& imported) {
+        return dbp ? FlatFilePos{dbp->nFile, static_cast<unsigned int>(imported.pos)} : FlatFilePos{};
+    }};
+
     int nLoaded = 0;
     try {
-        BufferedFile blkdat{file_in, 2 * MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE + 8};
-        // nRewind indicates where to resume scanning in case something goes wrong,
-        // such as a block fails to deserialize.
-        uint64_t nRewind = blkdat.GetPos();
-        while (!blkdat.eof()) {
-            if (m_interrupt) return;
-
-            blkdat.SetPos(nRewind);
-            nRewind++; // start one byte further next time, in case of failure
-            blkdat.SetLimit(); // remove former limit
-            unsigned int nSize = 0;
-            try {
-                // locate a header
-                MessageStartChars buf;
-                blkdat.FindByte(std::byte(params.MessageStart()[0]));
-                nRewind = blkdat.GetPos() + 1;
-                blkdat >> buf;
-                if (buf != params.MessageStart()) {
-                    continue;
-                }
-                // read size
-                blkdat >> nSize;
-                if (nSize < 80 || nSize > MAX_BLOCK_SERIALIZED_SIZE)
-                    continue;
-            } catch (const std::exception&) {
-                // no valid block header found; don't complain
-                // (this happens at the end of every blk.dat file)
-                break;
-            }
-            try {
-                // read block header
-                const uint64_t nBlockPos{blkdat.GetPos()};
-                if (dbp)
-                    dbp->nPos = nBlockPos;
-                blkdat.SetLimit(nBlockPos + nSize);
-                CBlockHeader header;
-                blkdat >> header;
-                const uint256 hash{header.GetHash()};
-                // Skip the rest of this block (this may read from disk into memory); position to the marker before the
-                // next block, but it's still possible to rewind to the start of the current block (without a disk read).
-                nRewind = nBlockPos + nSize;
-                blkdat.SkipTo(nRewind);
+        while (auto next{import_queue.Pop()}) {
+            if (m_interrupt) break;
 
+            uint64_t block_file_pos{0};
+            try {
+                ImportedBlock imported{next->get()};
+                block_file_pos = imported.pos;
+                if (!imported.block) continue; // unexpected data, logged by the pool
+                if (dbp) dbp->nPos = imported.pos;
+                FlatFilePos pos{block_pos(imported)};
+                const uint256 hash{imported.hash};
                 std::shared_ptr<CBlock> pblock{}; // needs to remain available after the cs_main lock is released to avoid duplicate reads from disk
 
                 {
                     LOCK(cs_main);
                     // detect out of order blocks, and store them for later
-                    if (hash != params.GetConsensus().hashGenesisBlock && !m_blockman.LookupBlockIndex(header.hashPrevBlock)) {
+                    if (hash != params.GetConsensus().hashGenesisBlock && !m_blockman.LookupBlockIndex(imported.block->hashPrevBlock)) {
                         LogPrint(BCLog::REINDEX, "%s: Out of order block %s, parent %s not known\n", __func__, hash.ToString(),
-                                 header.hashPrevBlock.ToString());
-                        if (dbp && blocks_with_unknown_parent) {
-                            blocks_with_unknown_parent->emplace(header.hashPrevBlock, *dbp);
+                                 imported.block->hashPrevBlock.ToString());
+                        const uint256 parent_hash{imported.block->hashPrevBlock};
+                        if (unknown_parent_bytes + imported.size <= MAX_BLOCK_IMPORT_UNKNOWN_PARENT_BYTES) {
+                            unknown_parent_bytes += imported.size;
+                            unknown_parent.emplace(parent_hash, std::move(imported));
+                        } else if (dbp && blocks_with_unknown_parent) {
+                            blocks_with_unknown_parent->emplace(parent_hash, pos);
                         }
                         continue;
                     }
@@ -4724,14 +4930,10 @@ void ChainstateManager::LoadExternalBlockFile(
                     // process in case the block isn't known yet
                     const CBlockIndex* pindex = m_blockman.LookupBlockIndex(hash);
                     if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) {
-                        // This block can be processed immediately; rewind to its start, read and deserialize it.
-                        blkdat.SetPos(nBlockPos);
-                        pblock = std::make_shared<CBlock>();
-                        blkdat >> TX_WITH_WITNESS(*pblock);
-                        nRewind = blkdat.GetPos();
-
+                        pblock = std::move(imported.block);
                         BlockValidationState state;
-                        if (AcceptBlock(pblock, state, nullptr, true, dbp, nullptr, true)) {
+                        if (AcceptBlock(pblock, state, nullptr, true, dbp ? &pos : nullptr, nullptr, true, imported.size,
+                                        imported.pow_checked ? &imported.hash : nullptr)) {
                             nLoaded++;
                         }
                         if (state.IsError()) {
@@ -4781,24 +4983,43 @@ void ChainstateManager::LoadExternalBlockFile(
 
                 NotifyHeaderTip(*this);
 
-                if (!blocks_with_unknown_parent) continue;
-
                 // Recursively process earlier encountered successors of this block
                 std::deque<uint256> queue;
                 queue.push_back(hash);
                 while (!queue.empty()) {
                     uint256 head = queue.front();
                     queue.pop_front();
+                    // Children still in memory need no disk read
+                    auto in_memory = unknown_parent.equal_range(head);
+                    while (in_memory.first != in_memory.second) {
+                        auto it = in_memory.first++;
+                        ImportedBlock child{std::move(it->second)};
+                        unknown_parent_bytes -= child.size;
+                        unknown_parent.erase(it);
+                        LogPrint(BCLog::REINDEX, "%s: Processing out of order child %s of %s\n", __func__, child.hash.ToString(),
+                                 head.ToString());
+                        FlatFilePos child_pos{block_pos(child)};
+                        LOCK(cs_main);
+                        BlockValidationState dummy;
+                        if (AcceptBlock(child.block, dummy, nullptr, true, dbp ? &child_pos : nullptr, nullptr, true, child.size,
+                                        child.pow_checked ? &child.hash : nullptr)) {
+                            nLoaded++;
+                            queue.push_back(child.hash);
+                        }
+                        NotifyHeaderTip(*this);
+                    }
+                    if (!blocks_with_unknown_parent) continue;
                     auto range = blocks_with_unknown_parent->equal_range(head);
                     while (range.first != range.second) {
                         std::multimap<uint256, FlatFilePos>::iterator it = range.first;
                         std::shared_ptr<CBlock> pblockrecursive = std::make_shared<CBlock>();
-                        if (m_blockman.ReadBlockFromDisk(*pblockrecursive, it->second)) {
+                        unsigned int stored_size;
+                        if (m_blockman.ReadBlockFromDisk(*pblockrecursive, it->second) && m_blockman.ReadBlockRecordSize(it->second, stored_size)) {
                             LogPrint(BCLog::REINDEX, "%s: Processing out of order child %s of %s\n", __func__, pblockrecursive->GetHash().ToString(),
                                     head.ToString());
                             LOCK(cs_main);
                             BlockValidationState dummy;
-                            if (AcceptBlock(pblockrecursive, dummy, nullptr, true, &it->second, nullptr, true)) {
+                            if (AcceptBlock(pblockrecursive, dummy, nullptr, true, &it->second, nullptr, true, stored_size)) {
                                 nLoaded++;
                                 queue.push_back(pblockrecursive->GetHash());
                             }
@@ -4809,23 +5030,24 @@ void ChainstateManager::LoadExternalBlockFile(
                     }
                 }
             } catch (const std::exception& e) {
-                // historical bugs added extra data to the block files that does not deserialize cleanly.
-                // commonly this data is between readable blocks, but it does not really matter. such data is not fatal to the import process.
-                // the code that reads the block files deals with invalid data by simply ignoring it.
-                // it continues to search for the next {4 byte magic message start bytes + 4 byte length + block} that does deserialize cleanly
-                // and passes all of the other block validation checks dealing with POW and the merkle root, etc...
-                // we merely note with this informational log message when unexpected data is encountered.
-                // we could also be experiencing a storage system read error, or a read of a previous bad write. these are possible, but
-                // less likely scenarios. we don't have enough information to tell a difference here.
-                // the reindex process is not the place to attempt to clean and/or compact the block files. if so desired, a studious node operator
-                // may use knowledge of the fact that the block files are not entirely pristine in order to prepare a set of pristine, and
-                // perhaps ordered, block files for later reindexing.
-                LogPrint(BCLog::REINDEX, "%s: unexpected data at file offset 0x%x - %s. continuing\n", __func__, (nRewind - 1), e.what());
+                LogPrint(BCLog::REINDEX, "%s: unexpected error processing block at file offset 0x%x - %s. continuing\n", __func__, block_file_pos, e.what());
             }
         }
+        import_queue.Stop();
+        read_result.get();
     } catch (const std::runtime_error& e) {
         GetNotifications().fatalError(std::string("System error: ") + e.what());
     }
+    import_queue.Stop();
+    reader.Stop();
+    if (m_interrupt) return;
+
+    // Blocks whose parent is in a later file are read again from disk once it is
+    if (blocks_with_unknown_parent) {
+        for (const auto& [parent_hash, child] : unknown_parent) {
+            blocks_with_unknown_parent->emplace(parent_hash, block_pos(child));
+        }
+    }
     LogPrintf("Loaded %i blocks from external file in %dms\n", nLoaded, Ticks<std::chrono::milliseconds>(SteadyClock::now() - start));
 }
 
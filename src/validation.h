@@ -17,6 +17,7 @@
 #include <kernel/chainparams.h>
 #include <kernel/chainstatemanager_opts.h>
 #include <kernel/cs_main.h> // IWYU pragma: export
+#include <node/blockprefetch.h>
 #include <node/blockstorage.h>
 #include <policy/feerate.h>
 #include <policy/packages.h>
@@ -632,6 +633,10 @@ public:
     //! The cache size of the in-memory coins view.
     size_t m_coinstip_cache_size_bytes{0};
 
+    //! Reads the blocks ActivateBestChainStep() is about to connect or
+    //! disconnect ahead of time. Its memory counts towards the coins cache.
+    node::BlockPrefetcher m_block_prefetcher{m_blockman};
+
     //! Resize the CoinsViews caches dynamically and flush state to disk.
     //! @returns true unless an error occurred during the flush.
     bool ResizeCoinsCaches(size_t coinstip_size, size_t coinsdb_size)
@@ -895,12 +900,14 @@ private:
      * Caller must set min_pow_checked=true in order to add a new header to the
      * block index (permanent memory storage), indicating that the header is
      * known to be part of a sufficiently high-work chain (anti-dos check).
+     * A non-null pow_hash is the header hash, already checked against nBits.
      */
     bool AcceptBlockHeader(
         const CBlockHeader& block,
         BlockValidationState& state,
         CBlockIndex** ppindex,
-        bool min_pow_checked) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+        bool min_pow_checked,
+        const uint256* pow_hash = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     friend Chainstate;
 
     /** Most recent headers presync progress update, for rate-limiting. */
@@ -1111,9 +1118,14 @@ public:
      * It reads all blocks contained in the given file and attempts to process them (add them to the
      * block index). The blocks may be out of order within each file and across files. Often this
      * function reads a block but finds that its parent hasn't been read yet, so the block can't be
-     * processed yet. The function will add an entry to the blocks_with_unknown_parent map (which is
-     * passed as an argument), so that when the block's parent is later read and processed, this
-     * function can re-read the child block from disk and process it.
+     * processed yet. Such blocks are kept in memory, up to a limit, and processed as soon as their
+     * parent is. Those left at the end of the file (or beyond the limit) are added to the
+     * blocks_with_unknown_parent map (which is passed as an argument), so that when the block's
+     * parent is later read and processed, this function can re-read the child block from disk and
+     * process it.
+     *
+     * The file is read sequentially by a reader thread, and blocks are deserialized, hashed and
+     * checked on a thread pool. Blocks are accepted on the calling thread, in file order.
      *
      * Because a block's parent may be in a later file, not just later in the same file, the
      * blocks_with_unknown_parent map must be passed in and out with each call. It's a multimap,
@@ -1121,7 +1133,8 @@ public:
      * or stale blocks exist). It maps from parent-hash to child-disk-position.
      *
      * This function can also be used to read blocks from user-specified block files using the
-     * -loadblock= option. There's no unknown-parent tracking, so the last two arguments are omitted.
+     * -loadblock= option. There's no unknown-parent tracking across files, so the last two arguments
+     * are omitted.
      *
      *
      * @param[in]     file_in                       File containing blocks to read
@@ -1184,6 +1197,10 @@ public:
      *                              this block from prior storage.
      * @param[in]   min_pow_checked True if proof-of-work anti-DoS checks have
      *                              been done by caller for headers chain
+     * @param[in]   stored_size     The size of the block data at dbp, if the
+     *                              caller read it, or 0 to read it from disk.
+     * @param[in]   pow_hash        The block hash, if the caller already checked
+     *                              it against nBits, so it is not recomputed.
      *
      * @param[out]  state       The state of the block validation.
      * @param[out]  ppindex     Optional return parameter to get the
@@ -1193,7 +1210,7 @@ public:
      *
      * @returns   False if the block or header is invalid, or if saving to disk fails (likely a fatal error); true otherwise.
      */
-    bool AcceptBlock(const std::shared_ptr<const CBlock>& pblock, BlockValidationState& state, CBlockIndex** ppindex, bool fRequested, const FlatFilePos* dbp, bool* fNewBlock, bool min_pow_checked) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    bool AcceptBlock(const std::shared_ptr<const CBlock>& pblock, BlockValidationState& state, CBlockIndex** ppindex, bool fRequested, const FlatFilePos* dbp, bool* fNewBlock, bool min_pow_checked, unsigned int stored_size = 0, const uint256* pow_hash = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     void ReceivedBlockTransactions(const CBlock& block, CBlockIndex* pindexNew, const FlatFilePos& pos) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
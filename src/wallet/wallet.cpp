@@ -59,6 +59,7 @@
 #include <util/moneystr.h>
 #include <util/result.h>
 #include <util/string.h>
+#include <util/threadpool.h>
 #include <util/time.h>
 #include <util/translation.h>
 #include <wallet/coincontrol.h>
@@ -75,7 +76,9 @@
 #include <algorithm>
 #include <cassert>
 #include <condition_variable>
+#include <deque>
 #include <exception>
+#include <future>
 #include <optional>
 #include <stdexcept>
 #include <thread>
@@ -324,17 +327,35 @@ public:
             if (current_range_end > last_range_end) {
                 AddScriptPubKeys(desc_spkm, last_range_end);
                 m_last_range_ends.at(desc_spkm->GetID()) = current_range_end;
+                // blocks ahead were matched against the former scripts
+                m_lookahead.clear();
             }
         }
     }
 
-    std::optional<bool> MatchesBlock(const uint256& block_hash) const
+    std::optional<bool> MatchesBlock(const uint256& block_hash)
     {
-        return m_wallet.chain().blockFilterMatchesAny(BlockFilterType::BASIC, block_hash, m_filter_set);
+        // match the filters of the blocks ahead at once, and fetch them again
+        // when the scan moves off the chain they were matched for
+        if (m_lookahead.empty() || m_lookahead.front().first != block_hash) {
+            const auto matches{m_wallet.chain().blockFiltersMatchAny(BlockFilterType::BASIC, block_hash, FILTER_LOOKAHEAD, m_filter_set)};
+            m_lookahead.assign(matches.begin(), matches.end());
+        }
+        if (m_lookahead.empty() || m_lookahead.front().first != block_hash) return std::nullopt;
+        const std::optional<bool> matches_block{m_lookahead.front().second};
+        m_lookahead.pop_front();
+        return matches_block;
     }
 
+    /** Blocks ahead of the last one matched, with whether they match. */
+    const std::deque<std::pair<uint256, std::optional<bool>>>& Lookahead() const { return m_lookahead; }
+
 private:
+    //! Number of blocks whose filters are matched at once
+    static constexpr int FILTER_LOOKAHEAD{1000};
+
     const CWallet& m_wallet;
+    std::deque<std::pair<uint256, std::optional<bool>>> m_lookahead;
     /** Map for keeping track of each range descriptor's last seen end range.
       * This information is used to detect whether new addresses were derived
       * (that is, if the current end range is larger than the saved end range)
@@ -351,6 +372,55 @@ private:
         }
     }
 };
+
+/**
+ * Reads blocks ahead of a rescan on a few worker threads, so that reading the
+ * blocks to be scanned overlaps with the wallet processing the blocks before
+ * them. Blocks are handed out in the order they are asked for.
+ */
+class RescanBlockReader
+{
+public:
+    explicit RescanBlockReader(interfaces::Chain& chain) : m_chain(chain) {}
+
+    /** Start reading a block, unless it is being read already. Returns false if enough blocks are. */
+    bool Prefetch(const uint256& block_hash)
+    {
+        if (m_reads.size() >= MAX_READS_AHEAD) return false;
+        if (std::any_of(m_reads.begin(), m_reads.end(), [&](const auto& read) { return read.first == block_hash; })) return true;
+        if (m_pool.WorkersCount() == 0) {
+            m_pool.Start(std::clamp(GetNumCores() / 2, 1, MAX_READ_THREADS));
+        }
+        m_reads.emplace_back(block_hash, m_pool.Submit([&chain = m_chain, block_hash] {
+            CBlock block;
+            chain.findBlock(block_hash, FoundBlock().data(block));
+            return block;
+        }));
+        return true;
+    }
+
+    /** Return a block, read ahead or read now. Reads ahead of blocks before it are dropped. */
+    CBlock Read(const uint256& block_hash)
+    {
+        const auto it{std::find_if(m_reads.begin(), m_reads.end(), [&](const auto& read) { return read.first == block_hash; })};
+        if (it != m_reads.end()) {
+            std::future<CBlock> read{std::move(it->second)};
+            m_reads.erase(m_reads.begin(), std::next(it));
+            return read.get();
+        }
+        CBlock block;
+        m_chain.findBlock(block_hash, FoundBlock().data(block));
+        return block;
+    }
+
+private:
+    static constexpr size_t MAX_READS_AHEAD{16};
+    static constexpr int MAX_READ_THREADS{4};
+
+    interfaces::Chain& m_chain;
+    ThreadPool m_pool{"rescanread"};
+    std::deque<std::pair<uint256, std::future<CBlock>>> m_reads;
+};
 } // namespace
 
 std::shared_ptr<CWallet> LoadWallet(WalletContext& context, const std::string& name, std::optional<bool> load_on_start, const DatabaseOptions& options, DatabaseStatus& status, bilingual_str& error, std::vector<bilingual_str>& warnings)
@@ -1829,6 +1899,7 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
 
     std::unique_ptr<FastWalletRescanFilter> fast_rescan_filter;
     if (!IsLegacy() && chain().hasBlockFilterIndex(BlockFilterType::BASIC)) fast_rescan_filter = std::make_unique<FastWalletRescanFilter>(*this);
+    RescanBlockReader block_reader{chain()};
 
     WalletLogPrintf("Rescan started from block %s... (%s)\n", start_block.ToString(),
                     fast_rescan_filter ? "fast variant using block filters" : "slow variant inspecting all blocks");
@@ -1873,6 +1944,13 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
             } else {
                 LogPrint(BCLog::SCAN, "Fast rescan: inspect block %d [%s] (WARNING: block filter not found!)\n", block_height, block_hash.ToString());
             }
+
+            // Start reading the next blocks to inspect while this one is scanned
+            int ahead_height{block_height};
+            for (const auto& [ahead_hash, ahead_matches] : fast_rescan_filter->Lookahead()) {
+                if (max_height && ++ahead_height > *max_height) break;
+                if (ahead_matches.value_or(true) && !block_reader.Prefetch(ahead_hash)) break;
+            }
         }
 
         // Find next block separately from reading data above, because reading
@@ -1884,8 +1962,7 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
 
         if (fetch_block) {
             // Read block data
-            CBlock block;
-            chain().findBlock(block_hash, FoundBlock().data(block));
+            const CBlock block{block_reader.Read(block_hash)};
 
             if (!block.IsNull()) {
                 LOCK(cs_wallet);
@@ -156,6 +156,15 @@ class PruneTest(BetGeniusTestFramework):
         self.log.info(f"Usage should be below target: {usage}")
         assert_greater_than(550, usage)
 
+        self.log.info("getpruneplan reports files that are deep enough to prune, without removing them")
+        plan = self.nodes[0].getpruneplan(550)
+        assert_equal(plan["target"], 550 * 1024 * 1024)
+        assert_greater_than(self.nodes[0].getblockcount() - 288 + 1, plan["max_height"])
+        for file in plan["files"]:
+            assert_greater_than(plan["max_height"] + 1, file["height_last"])
+            assert os.path.isfile(os.path.join(self.prunedir, f"blk{file['file']:05}.dat"))
+        assert_raises_rpc_error(-8, "Target is below the minimum of 550 MiB", self.nodes[0].getpruneplan, 549)
+
     def create_chain_with_staleblocks(self):
         # Create stale blocks in manageable sized chunks
         self.log.info("Mine 24 (stale) blocks on Node 1, followed by 25 (main chain) block reorg from Node 0, for 12 rounds")
@@ -274,6 +283,7 @@ class PruneTest(BetGeniusTestFramework):
         node = self.nodes[node_number]
         assert_equal(node.getblockcount(), 995)
         assert_raises_rpc_error(-1, "Cannot prune blocks because node is not in prune mode", node.pruneblockchain, 500)
+        assert_raises_rpc_error(-1, "A target is required when the node is not in prune mode", node.getpruneplan)
 
         # now re-start in manual pruning mode
         self.restart_node(node_number, extra_args=["-prune=1"])
@@ -101,6 +101,19 @@ class RpcMiscTest(BetGeniusTestFramework):
         # Specifying an unknown index name returns an empty result
         assert_equal(node.getindexinfo("foo"), {})
 
+        self.log.info("test getdbcacheinfo")
+        cache = node.getdbcacheinfo()
+        assert_greater_than(cache['capacity'], 0)
+        assert_greater_than_or_equal(cache['capacity'], cache['usage'])
+        # The chainstate, block index and the three index databases share the cache
+        assert_equal(len(cache['databases']), 5)
+        for db in cache['databases']:
+            assert_greater_than_or_equal(cache['usage'], db['usage'])
+        assert_equal(sorted(db['priority'] for db in cache['databases']), [0.5, 0.5, 0.5, 1, 1])
+
+        self.restart_node(0, ["-shareddbcache=0"])
+        assert_raises_rpc_error(-1, "The shared database cache is disabled", node.getdbcacheinfo)
+
 
 if __name__ == '__main__':
     RpcMiscTest().main()